@@ -0,0 +1,620 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <fmt/format.h>
+
+#include "aggregate.h"
+#include "aggregate_kernels.h"
+#include "thread_pool.h"
+#include "date.h"
+#include "utils.h"
+
+// ---------------------------------------------------------------------------------------
+// Binding
+
+static bool parseAggregateFunction(std::string_view name, AggregateFunction& function) {
+    if      (name == "COUNT") function = AggregateFunction::COUNT;
+    else if (name == "SUM")   function = AggregateFunction::SUM;
+    else if (name == "AVG")   function = AggregateFunction::AVG;
+    else if (name == "MIN")   function = AggregateFunction::MIN;
+    else if (name == "MAX")   function = AggregateFunction::MAX;
+    else return false;
+    return true;
+}
+
+AggregateQuery bindAggregateQuery(const Table& table,
+                                  const std::vector<SelectItem>& selectItems,
+                                  const std::vector<std::string_view>& groupByColumns) {
+    AggregateQuery query;
+
+    for (const auto& name : groupByColumns) {
+        int colIndex = table.findColumn(name);
+        if (colIndex < 0) {
+            throw std::runtime_error("Column '" + std::string(name) + "' not found in table '" + table.name + "'.");
+        }
+        query.groupColumns.push_back(static_cast<size_t>(colIndex));
+    }
+
+    for (const auto& selectItem : selectItems) {
+        if (selectItem.column == "*" && !selectItem.isCall()) {
+            throw std::runtime_error("SELECT * cannot be combined with aggregates or GROUP BY.");
+        }
+        std::string item = selectItem.label();
+
+        if (!selectItem.isCall()) {
+            // A plain column: only allowed if it is one of the GROUP BY columns
+            auto groupIt = std::find(groupByColumns.begin(), groupByColumns.end(), item);
+            if (groupIt == groupByColumns.end()) {
+                if (table.findColumn(item) < 0) {
+                    throw std::runtime_error("Column '" + item + "' not found in table '" + table.name + "'.");
+                }
+                throw std::runtime_error("Column '" + item + "' must appear in GROUP BY or be used in an aggregate.");
+            }
+            query.outputs.push_back({false, static_cast<size_t>(groupIt - groupByColumns.begin())});
+            query.outputNames.push_back(item);
+            continue;
+        }
+
+        std::string_view functionName = selectItem.function;
+        std::string_view argument = selectItem.column;
+
+        AggregateSpec spec;
+        if (!parseAggregateFunction(functionName, spec.function)) {
+            throw std::runtime_error("Unknown aggregate function: " + item);
+        }
+        spec.label = item;
+
+        if (argument == "*") {
+            if (spec.function != AggregateFunction::COUNT) {
+                throw std::runtime_error("Only COUNT accepts '*': " + item);
+            }
+        } else {
+            spec.columnIndex = table.findColumn(argument);
+            if (spec.columnIndex < 0) {
+                throw std::runtime_error("Column '" + std::string(argument) + "' not found in table '" + table.name + "'.");
+            }
+            DataType type = table.columns[spec.columnIndex].type;
+            bool numeric = (type == DataType::INTEGER || type == DataType::FLOAT);
+            if ((spec.function == AggregateFunction::SUM || spec.function == AggregateFunction::AVG) && !numeric) {
+                throw std::runtime_error(std::string(functionName) + " requires an INTEGER or FLOAT column: " + item);
+            }
+        }
+
+        query.outputs.push_back({true, query.aggregates.size()});
+        query.outputNames.push_back(spec.label);
+        query.aggregates.push_back(spec);
+    }
+
+    return query;
+}
+
+// ---------------------------------------------------------------------------------------
+// Accumulators
+
+// Running state of one aggregate (for one group). The MIN/MAX fields are valid once count > 0.
+struct AggState {
+    int64_t count = 0;
+    int64_t intSum = 0;      // SUM/AVG over INTEGER
+    double floatSum = 0.0;   // SUM/AVG over FLOAT
+    int32_t bestInt = 0;     // MIN/MAX over INTEGER, DATE and CHAR
+    float bestFloat = 0.0f;  // MIN/MAX over FLOAT
+    int64_t bestRow = -1;    // MIN/MAX over VARCHAR: row holding the best string
+};
+
+// Folds `count` rows into one state per row. rowAt(i) gives the i-th row id, stateAt(i) its state.
+// One aggregate at a time, so every pass only reads one column.
+template <typename RowAt, typename StateAt>
+static void accumulate(const Table& table, const AggregateSpec& spec, size_t count, RowAt rowAt, StateAt stateAt) {
+    if (spec.columnIndex < 0 || spec.function == AggregateFunction::COUNT) {
+        for (size_t i = 0; i < count; ++i) ++stateAt(i).count;
+        return;
+    }
+
+    const ColumnData& column = table.data[spec.columnIndex];
+    bool isMin = (spec.function == AggregateFunction::MIN);
+
+    switch (spec.function) {
+        case AggregateFunction::SUM:
+        case AggregateFunction::AVG:
+            if (column.type == DataType::INTEGER) {
+                for (size_t i = 0; i < count; ++i) {
+                    AggState& state = stateAt(i);
+                    state.intSum += column.intAt(rowAt(i));
+                    ++state.count;
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    AggState& state = stateAt(i);
+                    state.floatSum += column.floatAt(rowAt(i));
+                    ++state.count;
+                }
+            }
+            break;
+        case AggregateFunction::MIN:
+        case AggregateFunction::MAX:
+            for (size_t i = 0; i < count; ++i) {
+                AggState& state = stateAt(i);
+                uint32_t row = rowAt(i);
+                switch (column.type) {
+                    case DataType::INTEGER:
+                    case DataType::DATE:
+                    case DataType::CHAR: {
+                        int32_t value = column.type == DataType::CHAR ? column.charAt(row) : column.intAt(row);
+                        if (state.count == 0 || (isMin ? value < state.bestInt : value > state.bestInt)) {
+                            state.bestInt = value;
+                        }
+                        break;
+                    }
+                    case DataType::FLOAT: {
+                        float value = column.floatAt(row);
+                        if (state.count == 0 || (isMin ? value < state.bestFloat : value > state.bestFloat)) {
+                            state.bestFloat = value;
+                        }
+                        break;
+                    }
+                    case DataType::VARCHAR: {
+                        if (state.count == 0) {
+                            state.bestRow = row;
+                            break;
+                        }
+                        std::string_view value = column.stringAt(row);
+                        std::string_view best = column.stringAt(static_cast<uint32_t>(state.bestRow));
+                        if (isMin ? value < best : value > best) {
+                            state.bestRow = row;
+                        }
+                        break;
+                    }
+                }
+                ++state.count;
+            }
+            break;
+        case AggregateFunction::COUNT:
+            break;
+    }
+}
+
+// Folds the contiguous rows [start, end) into a single state.
+// INTEGER and FLOAT SUM/AVG/MIN/MAX use the vectorized reductions.
+static void accumulateRange(const Table& table, const AggregateSpec& spec, size_t start, size_t end, AggState& state) {
+    size_t count = end - start;
+    if (count == 0) {
+        return;
+    }
+    if (spec.columnIndex < 0 || spec.function == AggregateFunction::COUNT) {
+        state.count += static_cast<int64_t>(count);
+        return;
+    }
+
+    const ColumnData& column = table.data[spec.columnIndex];
+    bool isMin = (spec.function == AggregateFunction::MIN);
+
+    if (column.type == DataType::INTEGER || column.type == DataType::DATE) {
+        // One row group at a time: compressed groups are decoded into `scratch` first
+        int32_t scratch[kRowGroupSize];
+        for (size_t pos = start; pos < end;) {
+            size_t chunk = std::min(end, (pos / kRowGroupSize + 1) * kRowGroupSize) - pos;
+            const int32_t* values = column.intBlock(pos, chunk, scratch);
+            if (spec.function == AggregateFunction::SUM || spec.function == AggregateFunction::AVG) {
+                state.intSum += sumInt32(values, chunk);
+            } else {
+                int32_t value = isMin ? minInt32(values, chunk) : maxInt32(values, chunk);
+                if (state.count == 0 || (isMin ? value < state.bestInt : value > state.bestInt)) {
+                    state.bestInt = value;
+                }
+            }
+            state.count += static_cast<int64_t>(chunk);
+            pos += chunk;
+        }
+        return;
+    }
+    if (column.type == DataType::FLOAT) {
+        const float* values = column.floats.data() + start;
+        if (spec.function == AggregateFunction::SUM || spec.function == AggregateFunction::AVG) {
+            state.floatSum += sumFloat(values, count);
+        } else {
+            float value = isMin ? minFloat(values, count) : maxFloat(values, count);
+            if (state.count == 0 || (isMin ? value < state.bestFloat : value > state.bestFloat)) {
+                state.bestFloat = value;
+            }
+        }
+        state.count += static_cast<int64_t>(count);
+        return;
+    }
+
+    accumulate(table, spec, count,
+               [start](size_t i) { return static_cast<uint32_t>(start + i); },
+               [&state](size_t) -> AggState& { return state; });
+}
+
+// Combines two partial states of the same aggregate
+static void mergeState(const Table& table, const AggregateSpec& spec, AggState& dst, const AggState& src) {
+    if (src.count == 0) {
+        return;
+    }
+    bool isMinMax = (spec.function == AggregateFunction::MIN || spec.function == AggregateFunction::MAX);
+    if (isMinMax && spec.columnIndex >= 0) {
+        bool isMin = (spec.function == AggregateFunction::MIN);
+        const ColumnData& column = table.data[spec.columnIndex];
+        if (dst.count == 0) {
+            dst.bestInt = src.bestInt;
+            dst.bestFloat = src.bestFloat;
+            dst.bestRow = src.bestRow;
+        } else {
+            switch (column.type) {
+                case DataType::INTEGER:
+                case DataType::DATE:
+                case DataType::CHAR:
+                    if (isMin ? src.bestInt < dst.bestInt : src.bestInt > dst.bestInt) dst.bestInt = src.bestInt;
+                    break;
+                case DataType::FLOAT:
+                    if (isMin ? src.bestFloat < dst.bestFloat : src.bestFloat > dst.bestFloat) dst.bestFloat = src.bestFloat;
+                    break;
+                case DataType::VARCHAR: {
+                    std::string_view a = column.stringAt(static_cast<uint32_t>(src.bestRow));
+                    std::string_view b = column.stringAt(static_cast<uint32_t>(dst.bestRow));
+                    if (isMin ? a < b : a > b) dst.bestRow = src.bestRow;
+                    break;
+                }
+            }
+        }
+    }
+    dst.count += src.count;
+    dst.intSum += src.intSum;
+    dst.floatSum += src.floatSum;
+}
+
+// A long VARCHAR points into the column, which outlives the result
+static Value cellValue(const ColumnData& column, uint32_t row) {
+    return column.valueAt(row);
+}
+
+static Value finalizeState(const Table& table, const AggregateSpec& spec, const AggState& state) {
+    if (spec.function == AggregateFunction::COUNT) {
+        return Value(state.count);
+    }
+    if (state.count == 0) {
+        return Value(); // no rows -> NULL
+    }
+
+    const ColumnData& column = table.data[spec.columnIndex];
+    switch (spec.function) {
+        case AggregateFunction::SUM:
+            if (column.type == DataType::INTEGER) return Value(state.intSum);
+            return Value(state.floatSum);
+        case AggregateFunction::AVG:
+            if (column.type == DataType::INTEGER) return Value(static_cast<double>(state.intSum) / state.count);
+            return Value(state.floatSum / state.count);
+        case AggregateFunction::MIN:
+        case AggregateFunction::MAX:
+            switch (column.type) {
+                case DataType::INTEGER: return Value(state.bestInt);
+                case DataType::CHAR:    return Value(static_cast<char>(state.bestInt));
+                case DataType::FLOAT:   return Value(static_cast<double>(state.bestFloat));
+                case DataType::DATE:    return Value::date(state.bestInt);
+                case DataType::VARCHAR: return cellValue(column, static_cast<uint32_t>(state.bestRow));
+            }
+            break;
+        case AggregateFunction::COUNT:
+            break;
+    }
+    return Value();
+}
+
+// ---------------------------------------------------------------------------------------
+// Group hash table
+
+// Open-addressing hash table from encoded group key to group index.
+// Keys are stored back to back; each group also remembers its first row so the
+// GROUP BY values can be read from the table at the end instead of being copied.
+class GroupHashTable {
+public:
+    GroupHashTable() { slots.assign(64, 0); }
+
+    static uint64_t hashKey(std::string_view key) { return std::hash<std::string_view>{}(key); }
+
+    // Returns the group index of the key, adding a new group if it's not there yet.
+    // The group's first row is the smallest row id seen for it.
+    uint32_t findOrInsert(std::string_view key, uint64_t hash, uint32_t row) {
+        size_t mask = slots.size() - 1;
+        for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+            uint32_t entry = slots[slot];
+            if (entry == 0) {
+                uint32_t group = static_cast<uint32_t>(firstRows.size());
+                keyBytes.insert(keyBytes.end(), key.begin(), key.end());
+                keyOffsets.push_back(keyBytes.size());
+                hashes.push_back(hash);
+                firstRows.push_back(row);
+                slots[slot] = group + 1;
+                if (firstRows.size() * 2 > slots.size()) {
+                    grow();
+                }
+                return group;
+            }
+            uint32_t group = entry - 1;
+            if (hashes[group] == hash && groupKey(group) == key) {
+                firstRows[group] = std::min(firstRows[group], row);
+                return group;
+            }
+        }
+    }
+
+    size_t size() const { return firstRows.size(); }
+    uint32_t firstRow(size_t group) const { return firstRows[group]; }
+    uint64_t groupHash(size_t group) const { return hashes[group]; }
+    std::string_view groupKey(size_t group) const {
+        return std::string_view(keyBytes.data() + keyOffsets[group], keyOffsets[group + 1] - keyOffsets[group]);
+    }
+
+private:
+    // Doubles the slot array and re-inserts every group using its stored hash
+    void grow() {
+        std::vector<uint32_t> bigger(slots.size() * 2, 0);
+        size_t mask = bigger.size() - 1;
+        for (uint32_t group = 0; group < firstRows.size(); ++group) {
+            size_t slot = hashes[group] & mask;
+            while (bigger[slot] != 0) slot = (slot + 1) & mask;
+            bigger[slot] = group + 1;
+        }
+        slots = std::move(bigger);
+    }
+
+    std::vector<uint32_t> slots;        // group index + 1, 0 = empty
+    std::vector<char> keyBytes;
+    std::vector<size_t> keyOffsets{0};
+    std::vector<uint64_t> hashes;
+    std::vector<uint32_t> firstRows;
+};
+
+// Appends the GROUP BY values of a row to `key` (fixed-width types and dictionary codes raw,
+// plain strings length-prefixed)
+static void appendGroupKey(std::string& key, const Table& table, const std::vector<size_t>& groupColumns, uint32_t row) {
+    for (size_t colIndex : groupColumns) {
+        const ColumnData& column = table.data[colIndex];
+        switch (column.type) {
+            case DataType::INTEGER:
+            case DataType::DATE: {
+                int32_t value = column.intAt(row);
+                key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+                break;
+            }
+            case DataType::FLOAT: {
+                float value = column.floatAt(row);
+                if (value == 0.0f) value = 0.0f; // -0.0 and 0.0 are the same group
+                key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+                break;
+            }
+            case DataType::CHAR:
+                key.push_back(column.charAt(row));
+                break;
+            case DataType::VARCHAR: {
+                if (column.dictionaryEncoded) {
+                    // Codes identify the strings within the column, so the key never reads them
+                    uint16_t code = column.codes[row];
+                    key.append(reinterpret_cast<const char*>(&code), sizeof(code));
+                    break;
+                }
+                std::string_view value = column.stringAt(row);
+                uint32_t length = static_cast<uint32_t>(value.size());
+                key.append(reinterpret_cast<const char*>(&length), sizeof(length));
+                key.append(value);
+                break;
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Execution
+
+// What one worker builds from the morsels it processed
+struct PartialAggregate {
+    GroupHashTable groups;
+    std::vector<AggState> states;   // groups.size() * numAggregates (numAggregates without GROUP BY)
+    std::vector<uint32_t> groupIds; // scratch: group of each row in the current batch
+    std::string key;                // scratch: encoded group key
+};
+
+// Aggregates one batch of rows into a partial
+static void aggregateBatch(const Table& table, const AggregateQuery& query, PartialAggregate& partial,
+                           const uint32_t* rowIds, size_t count) {
+    const size_t numAggregates = query.aggregates.size();
+
+    if (query.groupColumns.empty()) {
+        // Filter output that happens to be contiguous can use the range kernels
+        bool contiguous = (rowIds[count - 1] - rowIds[0] + 1 == count);
+        for (size_t a = 0; a < numAggregates; ++a) {
+            AggState& state = partial.states[a];
+            if (contiguous) {
+                accumulateRange(table, query.aggregates[a], rowIds[0], rowIds[0] + count, state);
+            } else {
+                accumulate(table, query.aggregates[a], count,
+                           [rowIds](size_t i) { return rowIds[i]; },
+                           [&state](size_t) -> AggState& { return state; });
+            }
+        }
+        return;
+    }
+
+    // Hash aggregation: map each row of the batch to its group, then update one aggregate at a time
+    partial.groupIds.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        partial.key.clear();
+        appendGroupKey(partial.key, table, query.groupColumns, rowIds[i]);
+        partial.groupIds[i] = partial.groups.findOrInsert(partial.key, GroupHashTable::hashKey(partial.key), rowIds[i]);
+    }
+    partial.states.resize(partial.groups.size() * numAggregates);
+    for (size_t a = 0; a < numAggregates; ++a) {
+        accumulate(table, query.aggregates[a], count,
+                   [rowIds](size_t i) { return rowIds[i]; },
+                   [&, a](size_t i) -> AggState& { return partial.states[partial.groupIds[i] * numAggregates + a]; });
+    }
+}
+
+// Aggregates all rows [begin, end) of one morsel (no WHERE) into a partial
+static void aggregateMorsel(const Table& table, const AggregateQuery& query,
+                            size_t begin, size_t end, PartialAggregate& partial) {
+    if (query.groupColumns.empty()) {
+        // No WHERE and no groups: reduce the column arrays directly
+        for (size_t a = 0; a < query.aggregates.size(); ++a) {
+            accumulateRange(table, query.aggregates[a], begin, end, partial.states[a]);
+        }
+        return;
+    }
+
+    uint32_t rowIds[kFilterBlockSize];
+    for (size_t start = begin; start < end; start += kFilterBlockSize) {
+        size_t count = std::min(kFilterBlockSize, end - start);
+        for (size_t i = 0; i < count; ++i) rowIds[i] = static_cast<uint32_t>(start + i);
+        aggregateBatch(table, query, partial, rowIds, count);
+    }
+}
+
+// Merges the groups of all partials. Every partial's groups are split into
+// kAggregatePartitions by the top bits of their hash; partition p of every partial is then
+// merged into one table by a single task, so partitions merge in parallel without locks.
+// Returns one (partial table, group) list per partition.
+static std::vector<PartialAggregate> mergePartials(const Table& table, const AggregateQuery& query,
+                                                   std::vector<PartialAggregate>& partials) {
+    const size_t numAggregates = query.aggregates.size();
+    const int partitionShift = 64 - std::countr_zero(kAggregatePartitions);
+
+    // 1) Radix-partition each partial's groups (one task per partial)
+    std::vector<std::vector<std::vector<uint32_t>>> buckets(partials.size(),
+        std::vector<std::vector<uint32_t>>(kAggregatePartitions));
+    ThreadPool& pool = ThreadPool::instance();
+    pool.parallelFor(partials.size(), [&](size_t, size_t w) {
+        for (uint32_t g = 0; g < partials[w].groups.size(); ++g) {
+            buckets[w][partials[w].groups.groupHash(g) >> partitionShift].push_back(g);
+        }
+    });
+
+    // 2) Merge each partition across all partials (one task per partition)
+    std::vector<PartialAggregate> merged(kAggregatePartitions);
+    pool.parallelFor(kAggregatePartitions, [&](size_t, size_t p) {
+        PartialAggregate& target = merged[p];
+        for (size_t w = 0; w < partials.size(); ++w) {
+            const PartialAggregate& source = partials[w];
+            for (uint32_t g : buckets[w][p]) {
+                uint32_t group = target.groups.findOrInsert(source.groups.groupKey(g), source.groups.groupHash(g),
+                                                            source.groups.firstRow(g));
+                target.states.resize(target.groups.size() * numAggregates);
+                for (size_t a = 0; a < numAggregates; ++a) {
+                    mergeState(table, query.aggregates[a], target.states[group * numAggregates + a],
+                               source.states[g * numAggregates + a]);
+                }
+            }
+        }
+    });
+
+    return merged;
+}
+
+AggregateResult runAggregate(const Table& table, const AggregateQuery& query, const BoundPredicate* predicate,
+                             ScanStats* stats) {
+    AggregateResult result;
+    result.columnNames = query.outputNames;
+    const size_t numAggregates = query.aggregates.size();
+
+    // Every pool worker aggregates the morsels it takes into its own partial
+    ThreadPool& pool = ThreadPool::instance();
+    std::vector<PartialAggregate> partials(pool.threadCount());
+    if (query.groupColumns.empty()) {
+        for (auto& partial : partials) partial.states.resize(numAggregates);
+    }
+    if (predicate != nullptr) {
+        // WHERE: the scan plan streams matching rows (from an index or the vectorized filter)
+        ScanPlan plan(table, predicate);
+        plan.collectStats(stats);
+        plan.run([&](size_t worker, size_t, const uint32_t* rowIds, size_t count) {
+            aggregateBatch(table, query, partials[worker], rowIds, count);
+        });
+    } else {
+        pool.parallelFor(morselCount(table.size()), [&](size_t worker, size_t morsel) {
+            size_t begin = morsel * kMorselRows;
+            size_t end = std::min(table.size(), begin + kMorselRows);
+            aggregateMorsel(table, query, begin, end, partials[worker]);
+        });
+    }
+
+    // Ungrouped: fold the per-worker states into one row
+    if (query.groupColumns.empty()) {
+        std::vector<AggState> states(numAggregates);
+        for (const auto& partial : partials) {
+            for (size_t a = 0; a < numAggregates; ++a) {
+                mergeState(table, query.aggregates[a], states[a], partial.states[a]);
+            }
+        }
+        std::vector<Value> row;
+        for (const auto& output : query.outputs) {
+            row.push_back(finalizeState(table, query.aggregates[output.index], states[output.index]));
+        }
+        result.rows.push_back(std::move(row));
+        return result;
+    }
+
+    // Grouped: merge the partials of the workers that found any groups
+    partials.erase(std::remove_if(partials.begin(), partials.end(),
+                                  [](const PartialAggregate& partial) { return partial.groups.size() == 0; }),
+                   partials.end());
+    std::vector<PartialAggregate> merged;
+    if (partials.size() <= 1) {
+        merged = std::move(partials);
+    } else {
+        merged = mergePartials(table, query, partials);
+    }
+
+    // Emit groups in order of first appearance in the table, whatever thread found them
+    std::vector<std::pair<size_t, uint32_t>> order; // (partition, group)
+    for (size_t p = 0; p < merged.size(); ++p) {
+        for (uint32_t g = 0; g < merged[p].groups.size(); ++g) {
+            order.emplace_back(p, g);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&merged](const auto& a, const auto& b) {
+        return merged[a.first].groups.firstRow(a.second) < merged[b.first].groups.firstRow(b.second);
+    });
+
+    result.rows.reserve(order.size());
+    for (const auto& [p, g] : order) {
+        const PartialAggregate& partial = merged[p];
+        std::vector<Value> row;
+        row.reserve(query.outputs.size());
+        for (const auto& output : query.outputs) {
+            if (output.isAggregate) {
+                row.push_back(finalizeState(table, query.aggregates[output.index],
+                                            partial.states[g * numAggregates + output.index]));
+            } else {
+                const ColumnData& column = table.data[query.groupColumns[output.index]];
+                row.push_back(cellValue(column, partial.groups.firstRow(g)));
+            }
+        }
+        result.rows.push_back(std::move(row));
+    }
+
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------
+void sortAggregateResult(AggregateResult& result, const std::vector<std::pair<SelectItem, bool>>& orderByColumns) {
+    std::vector<std::pair<size_t, bool>> keys;
+    for (const auto& [item, isDesc] : orderByColumns) {
+        std::string name = item.label();    // as the result headers write it
+        auto it = std::find(result.columnNames.begin(), result.columnNames.end(), name);
+        if (it == result.columnNames.end()) {
+            throw std::runtime_error("Column '" + name + "' not found in the query result.");
+        }
+        keys.emplace_back(static_cast<size_t>(it - result.columnNames.begin()), isDesc);
+    }
+
+    std::stable_sort(result.rows.begin(), result.rows.end(),
+        [&keys](const std::vector<Value>& a, const std::vector<Value>& b) {
+            for (const auto& [index, isDesc] : keys) {
+                if (a[index] != b[index]) {
+                    return isDesc ? (b[index] < a[index]) : (a[index] < b[index]);
+                }
+            }
+            return false;
+        });
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "database.h"
+#include "condition.h"
+
+// Number of hash partitions used to merge per-thread GROUP BY tables in parallel (power of two)
+constexpr size_t kAggregatePartitions = 64;
+
+// Supported aggregate functions
+enum class AggregateFunction { COUNT, SUM, AVG, MIN, MAX };
+
+// One aggregate of the SELECT list, bound to the table
+struct AggregateSpec {
+    AggregateFunction function;
+    int columnIndex = -1;   // -1 for COUNT(*)
+    std::string label;      // column header, e.g. "AVG(salary)"
+};
+
+// One column of the result: a GROUP BY column or an aggregate
+struct AggregateOutput {
+    bool isAggregate;
+    size_t index;           // into AggregateQuery::groupColumns or AggregateQuery::aggregates
+};
+
+// A SELECT with aggregates and/or GROUP BY, resolved against a table
+struct AggregateQuery {
+    std::vector<size_t> groupColumns;       // GROUP BY column indices
+    std::vector<AggregateSpec> aggregates;
+    std::vector<AggregateOutput> outputs;   // in SELECT list order
+    std::vector<std::string> outputNames;
+};
+
+// Result of an aggregate query: one row per group (a single row without GROUP BY).
+// COUNT and SUM over INTEGER are BIGINT values, AVG and SUM over FLOAT DOUBLE,
+// and an aggregate over no rows is NULL. VARCHAR values point into the table.
+struct AggregateResult {
+    std::vector<std::string> columnNames;
+    std::vector<std::vector<Value>> rows;
+};
+
+// Resolves the SELECT list and GROUP BY columns.
+// Throws if a column doesn't exist, if an aggregate doesn't fit the column type
+// (SUM/AVG need INTEGER or FLOAT) or if a plain column is selected without being grouped.
+AggregateQuery bindAggregateQuery(const Table& table,
+                                  const std::vector<SelectItem>& selectItems,
+                                  const std::vector<std::string_view>& groupByColumns);
+
+// Runs the aggregation over the rows that pass `predicate` (all rows if it is null).
+// The table is split into morsels (kMorselRows) that the thread pool's workers aggregate into
+// per-worker partials; rows are consumed straight from the filter blocks, nothing is materialized.
+// Without GROUP BY the aggregates are accumulated column by column (SIMD sum/min/max on
+// contiguous INTEGER and FLOAT ranges). With GROUP BY each worker hashes rows into its own
+// open-addressing group table with typed accumulators, and the tables are merged per hash partition.
+// Groups come out in order of first appearance. What the WHERE scan skips is added to `stats` if given.
+AggregateResult runAggregate(const Table& table, const AggregateQuery& query, const BoundPredicate* predicate,
+                             ScanStats* stats = nullptr);
+
+// Applies ORDER BY to an aggregate result. Names refer to result columns
+// (a GROUP BY column or an aggregate label such as COUNT(*)). The sort is stable.
+void sortAggregateResult(AggregateResult& result, const std::vector<std::pair<SelectItem, bool>>& orderByColumns);
@@ -0,0 +1,216 @@
+#include "aggregate_kernels.h"
+
+// ---------------------------------------------------------------------------------------
+// Sums
+
+#ifdef MINIDB_X86_SIMD
+
+static int64_t sumInt32Sse2(const int32_t* values, size_t n, size_t& done) {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        // Sign-extend to 64 bits: interleave each value with its sign word
+        __m128i sign = _mm_srai_epi32(x, 31);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(x, sign));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(x, sign));
+    }
+    done = i;
+    int64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return lanes[0] + lanes[1];
+}
+
+TARGET_AVX2 static int64_t sumInt32Avx2(const int32_t* values, size_t n, size_t& done) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+    }
+    done = i;
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+static double sumFloatSse2(const float* values, size_t n, size_t& done) {
+    __m128d acc = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(values + i);
+        acc = _mm_add_pd(acc, _mm_cvtps_pd(x));
+        acc = _mm_add_pd(acc, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+    }
+    done = i;
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    return lanes[0] + lanes[1];
+}
+
+TARGET_AVX2 static double sumFloatAvx2(const float* values, size_t n, size_t& done) {
+    __m256d acc = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(values + i);
+        acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_castps256_ps128(x)));
+        acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)));
+    }
+    done = i;
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+#endif
+
+int64_t sumInt32(const int32_t* values, size_t n) {
+    int64_t sum = 0;
+    size_t done = 0;
+#ifdef MINIDB_X86_SIMD
+    switch (activeSimdLevel()) {
+        case SimdLevel::AVX2: sum = sumInt32Avx2(values, n, done); break;
+        case SimdLevel::SSE2: sum = sumInt32Sse2(values, n, done); break;
+        case SimdLevel::SCALAR: break;
+    }
+#endif
+    for (size_t i = done; i < n; ++i) sum += values[i];
+    return sum;
+}
+
+double sumFloat(const float* values, size_t n) {
+    double sum = 0.0;
+    size_t done = 0;
+#ifdef MINIDB_X86_SIMD
+    switch (activeSimdLevel()) {
+        case SimdLevel::AVX2: sum = sumFloatAvx2(values, n, done); break;
+        case SimdLevel::SSE2: sum = sumFloatSse2(values, n, done); break;
+        case SimdLevel::SCALAR: break;
+    }
+#endif
+    for (size_t i = done; i < n; ++i) sum += values[i];
+    return sum;
+}
+
+// ---------------------------------------------------------------------------------------
+// MIN / MAX
+// The vector loops keep one running best per lane (starting from values[0]) and reduce the lanes at the end.
+
+#ifdef MINIDB_X86_SIMD
+
+template <bool IS_MIN>
+static int32_t extremeInt32Sse2(const int32_t* values, size_t n, size_t& done) {
+    __m128i best = _mm_set1_epi32(values[0]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        // SSE2 has no 32-bit min/max: select with a compare mask
+        __m128i take = IS_MIN ? _mm_cmplt_epi32(x, best) : _mm_cmpgt_epi32(x, best);
+        best = _mm_or_si128(_mm_and_si128(take, x), _mm_andnot_si128(take, best));
+    }
+    done = i;
+    int32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), best);
+    int32_t result = lanes[0];
+    for (int k = 1; k < 4; ++k) {
+        if (IS_MIN ? lanes[k] < result : lanes[k] > result) result = lanes[k];
+    }
+    return result;
+}
+
+template <bool IS_MIN>
+TARGET_AVX2 static int32_t extremeInt32Avx2(const int32_t* values, size_t n, size_t& done) {
+    __m256i best = _mm256_set1_epi32(values[0]);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        best = IS_MIN ? _mm256_min_epi32(best, x) : _mm256_max_epi32(best, x);
+    }
+    done = i;
+    int32_t lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), best);
+    int32_t result = lanes[0];
+    for (int k = 1; k < 8; ++k) {
+        if (IS_MIN ? lanes[k] < result : lanes[k] > result) result = lanes[k];
+    }
+    return result;
+}
+
+// min_ps/max_ps return the second operand when either is NaN, so a NaN in `x` never replaces `best`
+template <bool IS_MIN>
+static float extremeFloatSse2(const float* values, size_t n, size_t& done) {
+    __m128 best = _mm_set1_ps(values[0]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(values + i);
+        best = IS_MIN ? _mm_min_ps(x, best) : _mm_max_ps(x, best);
+    }
+    done = i;
+    float lanes[4];
+    _mm_storeu_ps(lanes, best);
+    float result = lanes[0];
+    for (int k = 1; k < 4; ++k) {
+        if (IS_MIN ? lanes[k] < result : lanes[k] > result) result = lanes[k];
+    }
+    return result;
+}
+
+template <bool IS_MIN>
+TARGET_AVX2 static float extremeFloatAvx2(const float* values, size_t n, size_t& done) {
+    __m256 best = _mm256_set1_ps(values[0]);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(values + i);
+        best = IS_MIN ? _mm256_min_ps(x, best) : _mm256_max_ps(x, best);
+    }
+    done = i;
+    float lanes[8];
+    _mm256_storeu_ps(lanes, best);
+    float result = lanes[0];
+    for (int k = 1; k < 8; ++k) {
+        if (IS_MIN ? lanes[k] < result : lanes[k] > result) result = lanes[k];
+    }
+    return result;
+}
+
+#endif
+
+template <bool IS_MIN>
+static int32_t extremeInt32(const int32_t* values, size_t n) {
+    int32_t result = values[0];
+    size_t done = 1;
+#ifdef MINIDB_X86_SIMD
+    switch (activeSimdLevel()) {
+        case SimdLevel::AVX2: result = extremeInt32Avx2<IS_MIN>(values, n, done); break;
+        case SimdLevel::SSE2: result = extremeInt32Sse2<IS_MIN>(values, n, done); break;
+        case SimdLevel::SCALAR: break;
+    }
+#endif
+    for (size_t i = done; i < n; ++i) {
+        if (IS_MIN ? values[i] < result : values[i] > result) result = values[i];
+    }
+    return result;
+}
+
+template <bool IS_MIN>
+static float extremeFloat(const float* values, size_t n) {
+    float result = values[0];
+    size_t done = 1;
+#ifdef MINIDB_X86_SIMD
+    switch (activeSimdLevel()) {
+        case SimdLevel::AVX2: result = extremeFloatAvx2<IS_MIN>(values, n, done); break;
+        case SimdLevel::SSE2: result = extremeFloatSse2<IS_MIN>(values, n, done); break;
+        case SimdLevel::SCALAR: break;
+    }
+#endif
+    for (size_t i = done; i < n; ++i) {
+        if (IS_MIN ? values[i] < result : values[i] > result) result = values[i];
+    }
+    return result;
+}
+
+int32_t minInt32(const int32_t* values, size_t n) { return extremeInt32<true>(values, n); }
+int32_t maxInt32(const int32_t* values, size_t n) { return extremeInt32<false>(values, n); }
+float minFloat(const float* values, size_t n) { return extremeFloat<true>(values, n); }
+float maxFloat(const float* values, size_t n) { return extremeFloat<false>(values, n); }
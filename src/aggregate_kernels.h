@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "simd.h"
+
+// Vectorized reductions used by ungrouped aggregates over contiguous column ranges.
+// The level is chosen at runtime like the filter kernels (AVX2 / SSE2 / scalar).
+
+// Sum of n INTEGER values, accumulated in 64 bits.
+int64_t sumInt32(const int32_t* values, size_t n);
+
+// Sum of n FLOAT values, accumulated in double precision.
+double sumFloat(const float* values, size_t n);
+
+// Smallest / largest of n values (n must be > 0).
+// For floats a NaN is never picked over a number, except when it comes first (same as the scalar `<` scan).
+int32_t minInt32(const int32_t* values, size_t n);
+int32_t maxInt32(const int32_t* values, size_t n);
+float minFloat(const float* values, size_t n);
+float maxFloat(const float* values, size_t n);
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cstring>
+
+#include "arena.h"
+
+void* Arena::allocate(size_t size, size_t alignment) {
+    ++allocations;
+    bytesUsed += size;
+
+    if (size > blockSize / 4) {
+        // Oversized: its own block, slotted in before the current one so bumping carries on there
+        Block block{std::make_unique<char[]>(size), size};
+        void* result = block.data.get();
+        blocks.insert(blocks.empty() ? blocks.end() : blocks.end() - 1, std::move(block));
+        return result;
+    }
+
+    auto aligned = [alignment](char* p) {
+        uintptr_t address = reinterpret_cast<uintptr_t>(p);
+        return reinterpret_cast<char*>((address + alignment - 1) & ~(uintptr_t{alignment} - 1));
+    };
+    char* start = cursor ? aligned(cursor) : nullptr;
+    if (!start || start + size > limit) {
+        addBlock(size + alignment);
+        start = aligned(cursor);
+    }
+    cursor = start + size;
+    return start;
+}
+
+std::string_view Arena::copyString(std::string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+    char* copy = static_cast<char*>(allocate(text.size(), 1));
+    std::memcpy(copy, text.data(), text.size());
+    return std::string_view(copy, text.size());
+}
+
+const char* Arena::copyLengthPrefixed(std::string_view text) {
+    uint32_t length = static_cast<uint32_t>(text.size());
+    char* entry = static_cast<char*>(allocate(sizeof(length) + text.size(), alignof(uint32_t)));
+    std::memcpy(entry, &length, sizeof(length));
+    std::memcpy(entry + sizeof(length), text.data(), text.size());
+    return entry;
+}
+
+void Arena::addBlock(size_t minSize) {
+    size_t size = std::max(blockSize, minSize);
+    blocks.push_back(Block{std::make_unique<char[]>(size), size});
+    cursor = blocks.back().data.get();
+    limit = cursor + size;
+}
+
+void Arena::reset() {
+    // Keep one regular block so a steady stream of small commands never calls malloc
+    auto keep = std::find_if(blocks.begin(), blocks.end(), [this](const Block& block) { return block.size == blockSize; });
+    if (keep == blocks.end()) {
+        blocks.clear();
+        cursor = limit = nullptr;
+    } else {
+        Block block = std::move(*keep);
+        blocks.clear();
+        blocks.push_back(std::move(block));
+        cursor = blocks.back().data.get();
+        limit = cursor + blocks.back().size;
+    }
+    bytesUsed = 0;
+    allocations = 0;
+}
+
+ArenaStats Arena::stats() const {
+    ArenaStats result;
+    result.bytesUsed = bytesUsed;
+    result.allocations = allocations;
+    result.blocks = blocks.size();
+    for (const auto& block : blocks) {
+        result.bytesReserved += block.size;
+    }
+    return result;
+}
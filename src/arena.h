@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Default size of an arena block
+constexpr size_t kArenaBlockSize = 64 * 1024;
+
+// What an arena has handed out since it was created (or last reset)
+struct ArenaStats {
+    size_t bytesUsed = 0;       // bytes requested by allocations
+    size_t bytesReserved = 0;   // bytes held in blocks
+    size_t allocations = 0;
+    size_t blocks = 0;
+};
+
+// Bump allocator: memory is carved out of large blocks and only given back all at once,
+// by reset() or by destroying the arena. Allocating is a pointer bump, there is no per-object
+// header and no free. Requests bigger than a quarter block get a block of their own so they
+// don't waste the rest of the current one.
+// Used for the strings of a table's VARCHAR columns, plain values and dictionary entries alike
+// (freed with the table), and for per-command scratch memory (reset after every command).
+// Not thread-safe.
+class Arena {
+public:
+    explicit Arena(size_t blockSize = kArenaBlockSize) : blockSize(blockSize) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Returns `size` bytes aligned to `alignment` (a power of two), valid until reset()
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    // Copies `text` into the arena
+    std::string_view copyString(std::string_view text);
+
+    // Copies `text` into the arena as a 4-byte length followed by the bytes, so a single pointer
+    // is enough to find it again (see lengthPrefixedString)
+    const char* copyLengthPrefixed(std::string_view text);
+
+    // Releases everything allocated so far. The first block is kept for reuse.
+    void reset();
+
+    ArenaStats stats() const;
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    // Starts a new block of at least `minSize` bytes and makes it current
+    void addBlock(size_t minSize);
+
+    size_t blockSize;
+    std::vector<Block> blocks;
+    char* cursor = nullptr;     // next free byte of the current (last) block
+    char* limit = nullptr;      // end of the current block
+    size_t bytesUsed = 0;
+    size_t allocations = 0;
+};
+
+// The string stored at `entry` by Arena::copyLengthPrefixed
+inline std::string_view lengthPrefixedString(const char* entry) {
+    uint32_t length;
+    std::memcpy(&length, entry, sizeof(length));
+    return std::string_view(entry + sizeof(length), length);
+}
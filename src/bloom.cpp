@@ -0,0 +1,53 @@
+#include <functional>
+
+#include "bloom.h"
+
+// Odd constants that spread one 32-bit key over the 8 words of a block (same as Parquet / Impala)
+static constexpr uint32_t kSalts[8] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+// murmur3 finalizer
+static uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t bloomHash(std::string_view value) {
+    // std::hash is not guaranteed to mix well, so finish with a mixer
+    return mix64(std::hash<std::string_view>{}(value));
+}
+
+uint64_t bloomHash(int32_t value) {
+    return mix64(static_cast<uint32_t>(value));
+}
+
+BlockedBloomFilter::BlockedBloomFilter(size_t blockCount) : blocks(blockCount == 0 ? 1 : blockCount) {}
+
+size_t BlockedBloomFilter::blockIndex(uint64_t hash) const {
+    // Upper 32 bits scaled to the block count (no modulo)
+    return static_cast<size_t>(((hash >> 32) * blocks.size()) >> 32);
+}
+
+void BlockedBloomFilter::add(uint64_t hash) {
+    Block& block = blocks[blockIndex(hash)];
+    uint32_t key = static_cast<uint32_t>(hash);
+    for (int i = 0; i < 8; ++i) {
+        block.words[i] |= uint32_t{1} << ((key * kSalts[i]) >> 27);
+    }
+}
+
+bool BlockedBloomFilter::mayContain(uint64_t hash) const {
+    const Block& block = blocks[blockIndex(hash)];
+    uint32_t key = static_cast<uint32_t>(hash);
+    bool all = true;
+    for (int i = 0; i < 8; ++i) {
+        all &= (block.words[i] >> ((key * kSalts[i]) >> 27)) & 1;
+    }
+    return all;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Hash of a value as used by the Bloom filters (64 bits, well mixed)
+uint64_t bloomHash(std::string_view value);
+uint64_t bloomHash(int32_t value);      // DATE (days since the epoch)
+
+// Split-block Bloom filter.
+// The filter is an array of 256-bit blocks (8 x 32-bit words). A key picks one block with the
+// upper half of its hash and sets one bit in each of the block's 8 words, derived from the lower
+// half. Adding or probing a key touches a single 32-byte block, i.e. one cache line, and the 8
+// words are independent so the compiler can do them with vector instructions.
+class BlockedBloomFilter {
+public:
+    explicit BlockedBloomFilter(size_t blockCount);
+
+    void add(uint64_t hash);
+
+    // False means the key was never added; true means it probably was
+    bool mayContain(uint64_t hash) const;
+
+    size_t memoryUsage() const { return blocks.capacity() * sizeof(Block); }
+
+private:
+    struct alignas(32) Block {
+        uint32_t words[8] = {};
+    };
+
+    size_t blockIndex(uint64_t hash) const;
+
+    std::vector<Block> blocks;
+};
@@ -0,0 +1,304 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// B+tree from a key to row ids, used by secondary indexes.
+// Entries are (key, row id) pairs kept in (key, row) order, so duplicate keys are allowed and
+// the rows of one key come out ascending. Nodes live in two vectors and point to each other by
+// index; a node holds its keys in one array and its rows / children in another, so a search
+// inside a node is a binary search over a few cache lines. Leaves are linked for range scans.
+template <typename Key>
+class BPlusTree {
+public:
+    // Entries per leaf and separators per inner node
+    static constexpr size_t kLeafCapacity = 64;
+    static constexpr size_t kInnerCapacity = 64;
+
+    BPlusTree() { clear(); }
+
+    void clear() {
+        leaves.assign(1, Leaf{});
+        inners.clear();
+        root = 0;
+        height = 0;
+        entryCount = 0;
+    }
+
+    size_t size() const { return entryCount; }
+
+    // Approximate memory held by the nodes
+    size_t memoryUsage() const {
+        return leaves.capacity() * sizeof(Leaf) + inners.capacity() * sizeof(Inner);
+    }
+
+    // Adds one entry
+    void insert(const Key& key, uint32_t row) {
+        Split split;
+        if (insertInto(root, height, key, row, split)) {
+            // The root split: grow the tree by one level
+            Inner newRoot;
+            newRoot.count = 1;
+            newRoot.keys[0] = split.key;
+            newRoot.rows[0] = split.row;
+            newRoot.children[0] = root;
+            newRoot.children[1] = split.node;
+            inners.push_back(std::move(newRoot));
+            root = static_cast<uint32_t>(inners.size() - 1);
+            ++height;
+        }
+        ++entryCount;
+    }
+
+    // Replaces the tree with `entries`, which must be sorted by (key, row).
+    // Builds full leaves left to right, then each inner level on top, in O(n).
+    void bulkLoad(const std::vector<std::pair<Key, uint32_t>>& entries) {
+        clear();
+        if (entries.empty()) {
+            return;
+        }
+        leaves.clear();
+
+        // 1) Leaves
+        std::vector<uint32_t> level;        // nodes of the level being built
+        std::vector<std::pair<Key, uint32_t>> firsts; // first entry under each node
+        for (size_t start = 0; start < entries.size(); start += kLeafCapacity) {
+            size_t count = std::min(kLeafCapacity, entries.size() - start);
+            Leaf leaf;
+            leaf.count = static_cast<uint16_t>(count);
+            for (size_t i = 0; i < count; ++i) {
+                leaf.keys[i] = entries[start + i].first;
+                leaf.rows[i] = entries[start + i].second;
+            }
+            if (!leaves.empty()) {
+                leaves.back().next = static_cast<uint32_t>(leaves.size());
+            }
+            leaves.push_back(std::move(leaf));
+            level.push_back(static_cast<uint32_t>(leaves.size() - 1));
+            firsts.push_back(entries[start]);
+        }
+
+        // 2) Inner levels until a single root is left
+        height = 0;
+        while (level.size() > 1) {
+            std::vector<uint32_t> parents;
+            std::vector<std::pair<Key, uint32_t>> parentFirsts;
+            for (size_t start = 0; start < level.size(); start += kInnerCapacity + 1) {
+                size_t count = std::min(kInnerCapacity + 1, level.size() - start);
+                Inner inner;
+                inner.count = static_cast<uint16_t>(count - 1);
+                for (size_t i = 0; i < count; ++i) {
+                    inner.children[i] = level[start + i];
+                    if (i > 0) {
+                        inner.keys[i - 1] = firsts[start + i].first;
+                        inner.rows[i - 1] = firsts[start + i].second;
+                    }
+                }
+                inners.push_back(std::move(inner));
+                parents.push_back(static_cast<uint32_t>(inners.size() - 1));
+                parentFirsts.push_back(firsts[start]);
+            }
+            level = std::move(parents);
+            firsts = std::move(parentFirsts);
+            ++height;
+        }
+        root = level[0];
+        entryCount = entries.size();
+    }
+
+    // Calls visit(row) for every entry with lo <= key <= hi, in key order.
+    // A null bound is open; the inclusive flags turn <= into <.
+    // visit returns false to stop the scan early.
+    template <typename Visit>
+    void scan(const Key* lo, bool loInclusive, const Key* hi, bool hiInclusive, Visit visit) const {
+        if (entryCount == 0) {
+            return;
+        }
+
+        // Find the first leaf that can hold a key >= lo
+        uint32_t node = root;
+        for (size_t level = height; level > 0; --level) {
+            const Inner& inner = inners[node];
+            size_t child = 0;
+            if (lo != nullptr) {
+                // Children left of the first separator >= lo only hold smaller keys
+                child = std::lower_bound(inner.keys, inner.keys + inner.count, *lo) - inner.keys;
+            }
+            node = inner.children[child];
+        }
+
+        for (uint32_t leafIndex = node; leafIndex != kNone; leafIndex = leaves[leafIndex].next) {
+            const Leaf& leaf = leaves[leafIndex];
+            size_t i = 0;
+            if (lo != nullptr) {
+                i = loInclusive ? std::lower_bound(leaf.keys, leaf.keys + leaf.count, *lo) - leaf.keys
+                                : std::upper_bound(leaf.keys, leaf.keys + leaf.count, *lo) - leaf.keys;
+            }
+            for (; i < leaf.count; ++i) {
+                if (hi != nullptr && (hiInclusive ? *hi < leaf.keys[i] : !(leaf.keys[i] < *hi))) {
+                    return;
+                }
+                if (!visit(leaf.rows[i])) {
+                    return;
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    struct Leaf {
+        uint16_t count = 0;
+        uint32_t next = kNone;              // leaf to the right
+        Key keys[kLeafCapacity];
+        uint32_t rows[kLeafCapacity];
+    };
+
+    // Separator i is the first entry under children[i + 1]
+    struct Inner {
+        uint16_t count = 0;                 // number of separators
+        Key keys[kInnerCapacity];
+        uint32_t rows[kInnerCapacity];
+        uint32_t children[kInnerCapacity + 1];
+    };
+
+    // A node that split off to the right, with the first entry under it
+    struct Split {
+        Key key;
+        uint32_t row = 0;
+        uint32_t node = 0;
+    };
+
+    // Position of (key, row) among n entries: the first entry that is greater
+    static size_t upperPosition(const Key* keys, const uint32_t* rows, size_t n, const Key& key, uint32_t row) {
+        size_t lo = 0, hi = n;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            bool entryGreater = key < keys[mid] || (!(keys[mid] < key) && row < rows[mid]);
+            if (entryGreater) hi = mid;
+            else lo = mid + 1;
+        }
+        return lo;
+    }
+
+    // Inserts into the subtree at `node` (`level` 0 = leaf). Returns true if the node split.
+    bool insertInto(uint32_t node, size_t level, const Key& key, uint32_t row, Split& split) {
+        if (level == 0) {
+            return insertIntoLeaf(node, key, row, split);
+        }
+
+        size_t child;
+        {
+            const Inner& inner = inners[node];
+            child = upperPosition(inner.keys, inner.rows, inner.count, key, row);
+        }
+        Split childSplit;
+        if (!insertInto(inners[node].children[child], level - 1, key, row, childSplit)) {
+            return false;
+        }
+
+        // Put the new child's separator at position `child`
+        if (inners[node].count == kInnerCapacity) {
+            // Full: move the upper half to a new node, the middle separator goes up
+            Inner right;
+            Inner& left = inners[node];
+            size_t middle = kInnerCapacity / 2;
+            right.count = static_cast<uint16_t>(kInnerCapacity - middle - 1);
+            for (size_t i = 0; i < right.count; ++i) {
+                right.keys[i] = std::move(left.keys[middle + 1 + i]);
+                right.rows[i] = left.rows[middle + 1 + i];
+            }
+            for (size_t i = 0; i <= right.count; ++i) {
+                right.children[i] = left.children[middle + 1 + i];
+            }
+            split.key = std::move(left.keys[middle]);
+            split.row = left.rows[middle];
+            left.count = static_cast<uint16_t>(middle);
+
+            inners.push_back(std::move(right));
+            split.node = static_cast<uint32_t>(inners.size() - 1);
+
+            // Add the child's separator to whichever half it belongs to
+            if (child <= middle) {
+                insertSeparator(node, child, childSplit);
+            } else {
+                insertSeparator(split.node, child - middle - 1, childSplit);
+            }
+            return true;
+        }
+
+        insertSeparator(node, child, childSplit);
+        return false;
+    }
+
+    void insertSeparator(uint32_t node, size_t position, Split& childSplit) {
+        Inner& inner = inners[node];
+        for (size_t i = inner.count; i > position; --i) {
+            inner.keys[i] = std::move(inner.keys[i - 1]);
+            inner.rows[i] = inner.rows[i - 1];
+            inner.children[i + 1] = inner.children[i];
+        }
+        inner.keys[position] = std::move(childSplit.key);
+        inner.rows[position] = childSplit.row;
+        inner.children[position + 1] = childSplit.node;
+        ++inner.count;
+    }
+
+    bool insertIntoLeaf(uint32_t node, const Key& key, uint32_t row, Split& split) {
+        size_t position = upperPosition(leaves[node].keys, leaves[node].rows, leaves[node].count, key, row);
+
+        if (leaves[node].count < kLeafCapacity) {
+            insertEntry(node, position, key, row);
+            return false;
+        }
+
+        // Full. Rows are mostly appended with growing ids, so when the entry goes to the very end
+        // the new leaf starts with just that entry and the old one stays full.
+        size_t keep = (position == kLeafCapacity) ? kLeafCapacity : kLeafCapacity / 2;
+        Leaf right;
+        {
+            Leaf& left = leaves[node];
+            right.count = static_cast<uint16_t>(kLeafCapacity - keep);
+            for (size_t i = 0; i < right.count; ++i) {
+                right.keys[i] = std::move(left.keys[keep + i]);
+                right.rows[i] = left.rows[keep + i];
+            }
+            left.count = static_cast<uint16_t>(keep);
+            right.next = left.next;
+        }
+        leaves.push_back(std::move(right));
+        uint32_t rightIndex = static_cast<uint32_t>(leaves.size() - 1);
+        leaves[node].next = rightIndex;
+
+        if (position <= keep && position < kLeafCapacity) {
+            insertEntry(node, position, key, row);
+        } else {
+            insertEntry(rightIndex, position - keep, key, row);
+        }
+
+        split.key = leaves[rightIndex].keys[0];
+        split.row = leaves[rightIndex].rows[0];
+        split.node = rightIndex;
+        return true;
+    }
+
+    void insertEntry(uint32_t node, size_t position, const Key& key, uint32_t row) {
+        Leaf& leaf = leaves[node];
+        for (size_t i = leaf.count; i > position; --i) {
+            leaf.keys[i] = std::move(leaf.keys[i - 1]);
+            leaf.rows[i] = leaf.rows[i - 1];
+        }
+        leaf.keys[position] = key;
+        leaf.rows[position] = row;
+        ++leaf.count;
+    }
+
+    std::vector<Leaf> leaves;
+    std::vector<Inner> inners;
+    uint32_t root = 0;
+    size_t height = 0;      // number of inner levels above the leaves
+    size_t entryCount = 0;
+};
@@ -0,0 +1,96 @@
+#include <bit>
+
+#include "compression.h"
+
+const char* columnEncodingName(ColumnEncoding encoding) {
+    switch (encoding) {
+        case ColumnEncoding::PLAIN:     return "plain";
+        case ColumnEncoding::RLE:       return "rle";
+        case ColumnEncoding::BITPACKED: return "bitpacked";
+    }
+    return "?";
+}
+
+EncodedGroup::EncodedGroup(const int32_t* values, size_t n, bool isChar) : isChar(isChar), rowCount(n) {
+    if (n == 0) {
+        return;
+    }
+
+    // One pass for the range and the number of runs
+    int32_t lo = values[0], hi = values[0];
+    size_t runs = 1;
+    for (size_t i = 1; i < n; ++i) {
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+        runs += (values[i] != values[i - 1]);
+    }
+    uint8_t bits = static_cast<uint8_t>(std::bit_width(static_cast<uint32_t>(hi) - static_cast<uint32_t>(lo)));
+
+    // Smallest encoding wins; on a tie PLAIN, then BITPACKED, as they decode fastest
+    size_t plainBytes = n * (isChar ? sizeof(char) : sizeof(int32_t));
+    size_t packedBytes = (n * bits + 63) / 64 * sizeof(uint64_t);
+    size_t rleBytes = runs * (sizeof(int32_t) + sizeof(uint16_t));
+
+    if (rleBytes < plainBytes && rleBytes < packedBytes) {
+        kind = ColumnEncoding::RLE;
+        runValues.reserve(runs);
+        runEnds.reserve(runs);
+        for (size_t i = 1; i <= n; ++i) {
+            if (i == n || values[i] != values[i - 1]) {
+                runValues.push_back(values[i - 1]);
+                runEnds.push_back(static_cast<uint16_t>(i));
+            }
+        }
+    } else if (packedBytes < plainBytes) {
+        kind = ColumnEncoding::BITPACKED;
+        base = lo;
+        width = bits;
+        packed.assign((n * bits + 63) / 64, 0);
+        for (size_t i = 0; i < n && bits > 0; ++i) {
+            uint64_t offset = static_cast<uint32_t>(values[i]) - static_cast<uint32_t>(lo);
+            size_t bit = i * bits;
+            packed[bit / 64] |= offset << (bit % 64);
+            if (bit % 64 + bits > 64) {
+                packed[bit / 64 + 1] |= offset >> (64 - bit % 64);
+            }
+        }
+    } else if (isChar) {
+        plainChars.assign(values, values + n);
+    } else {
+        plainInts.assign(values, values + n);
+    }
+}
+
+template <typename T>
+void EncodedGroup::decodeInto(size_t start, size_t count, T* out) const {
+    switch (kind) {
+        case ColumnEncoding::PLAIN:
+            if (isChar) std::copy(plainChars.begin() + start, plainChars.begin() + start + count, out);
+            else std::copy(plainInts.begin() + start, plainInts.begin() + start + count, out);
+            break;
+        case ColumnEncoding::RLE:
+            forEachRun(start, count, [out](int32_t value, size_t offset, size_t length) {
+                std::fill(out + offset, out + offset + length, static_cast<T>(value));
+            });
+            break;
+        case ColumnEncoding::BITPACKED:
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = static_cast<T>(base + static_cast<int32_t>(unpack(start + i)));
+            }
+            break;
+    }
+}
+
+void EncodedGroup::decode(size_t start, size_t count, int32_t* out) const {
+    decodeInto(start, count, out);
+}
+
+void EncodedGroup::decode(size_t start, size_t count, char* out) const {
+    decodeInto(start, count, out);
+}
+
+size_t EncodedGroup::memoryUsage() const {
+    return sizeof(EncodedGroup) + plainInts.capacity() * sizeof(int32_t) + plainChars.capacity() +
+           runValues.capacity() * sizeof(int32_t) + runEnds.capacity() * sizeof(uint16_t) +
+           packed.capacity() * sizeof(uint64_t);
+}
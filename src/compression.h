@@ -0,0 +1,92 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Lightweight compression of full row groups of INTEGER, DATE and CHAR columns.
+// A group is encoded once, when its last row is appended, with whichever of these is smallest:
+//   PLAIN      the values as they are (4 bytes, 1 for CHAR)
+//   RLE        run-length: one (value, end) pair per run of equal values
+//   BITPACKED  frame of reference: value - group minimum, packed in as few bits as the group's
+//              range needs (a constant group takes 0 bits)
+// Every encoding keeps random access: PLAIN and BITPACKED in O(1), RLE with a binary search
+// over the run ends. CHAR values are encoded as their (signed) int32 value.
+enum class ColumnEncoding { PLAIN, RLE, BITPACKED };
+
+// Name of the encoding for SHOW STORAGE ("plain", "rle", "bitpacked")
+const char* columnEncodingName(ColumnEncoding encoding);
+
+class EncodedGroup {
+public:
+    // Encodes `n` values; `isChar` selects 1-byte plain storage
+    EncodedGroup(const int32_t* values, size_t n, bool isChar);
+
+    ColumnEncoding encoding() const { return kind; }
+    size_t size() const { return rowCount; }
+    uint8_t bitWidth() const { return width; }
+    size_t runCount() const { return runEnds.size(); }
+
+    // Value i of the group
+    int32_t at(size_t i) const {
+        switch (kind) {
+            case ColumnEncoding::PLAIN:
+                return isChar ? static_cast<int32_t>(plainChars[i]) : plainInts[i];
+            case ColumnEncoding::RLE:
+                return runValues[std::upper_bound(runEnds.begin(), runEnds.end(), i) - runEnds.begin()];
+            case ColumnEncoding::BITPACKED:
+                return base + static_cast<int32_t>(unpack(i));
+        }
+        return 0;
+    }
+
+    // The stored values of a PLAIN group, nullptr for the other encodings
+    const int32_t* plainIntData() const { return kind == ColumnEncoding::PLAIN && !isChar ? plainInts.data() : nullptr; }
+    const char* plainCharData() const { return kind == ColumnEncoding::PLAIN && isChar ? plainChars.data() : nullptr; }
+
+    // Decodes values [start, start + count) into `out`
+    void decode(size_t start, size_t count, int32_t* out) const;
+    void decode(size_t start, size_t count, char* out) const;
+
+    // RLE: calls fn(value, offset, length) for every run overlapping [start, start + count),
+    // clipped to it; offset is relative to `start`
+    template <typename Fn>
+    void forEachRun(size_t start, size_t count, Fn fn) const {
+        size_t end = start + count;
+        size_t run = std::upper_bound(runEnds.begin(), runEnds.end(), start) - runEnds.begin();
+        for (size_t pos = start; pos < end; ++run) {
+            size_t runEnd = std::min<size_t>(end, runEnds[run]);
+            fn(runValues[run], pos - start, runEnd - pos);
+            pos = runEnd;
+        }
+    }
+
+    size_t memoryUsage() const;
+
+private:
+    uint32_t unpack(size_t i) const {
+        if (width == 0) return 0;
+        size_t bit = i * width;
+        size_t word = bit / 64;
+        size_t shift = bit % 64;
+        uint64_t value = packed[word] >> shift;
+        if (shift + width > 64) {
+            value |= packed[word + 1] << (64 - shift);
+        }
+        return static_cast<uint32_t>(value & ((uint64_t{1} << width) - 1));
+    }
+
+    template <typename T>
+    void decodeInto(size_t start, size_t count, T* out) const;
+
+    ColumnEncoding kind = ColumnEncoding::PLAIN;
+    bool isChar = false;
+    uint8_t width = 0;                  // BITPACKED: bits per value
+    size_t rowCount = 0;
+    int32_t base = 0;                   // BITPACKED: group minimum
+    std::vector<int32_t> plainInts;     // PLAIN (INTEGER, DATE)
+    std::vector<char> plainChars;       // PLAIN (CHAR)
+    std::vector<int32_t> runValues;     // RLE: run r holds runValues[r] ...
+    std::vector<uint16_t> runEnds;      // ... on rows [runEnds[r - 1], runEnds[r])
+    std::vector<uint64_t> packed;       // BITPACKED
+};
@@ -1,328 +1,1107 @@
 #include "condition.h"
 #include "database.h"
 #include "utils.h"
+#include "thread_pool.h"
+#include "date.h"
 #include <cmath>
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <type_traits>
+#include "fmt/format.h"
 
-// Extended parse to handle multi-character operators
-std::vector<std::pair<std::string, Condition>> parseWhereClause(const std::string& wherePart) {
-    // https://www.geeksforgeeks.org/pair-in-cpp-stl/ (std::pair)
-    std::vector<std::pair<std::string, Condition>> conditions;
-
-    // Naive split on spaces
-    std::vector<std::string> tokens = split(wherePart, ' ');
-
-    std::string logicalOp;         // e.g., AND, OR
-    std::string currentColumn;
-    std::string currentOp;
-    std::string currentValue;
-    bool inCondition = false;      // Are we building a condition?
-    bool inQuote     = false;      // Are we building a multi-token string value?
-    std::string valueBuffer;
-    std::vector<std::string> inValueList;
-
-    // If we saw "NOT" but haven't yet seen "IN", store it here
-    bool nextConditionShouldNegate = false;
-
-    //  Converts the currently parsed condition into a Condition object,
-    //  adds it to conditions, and resets state variables for the next condition
-    //  lambda function with & (can access vars outside lambda function)
-    auto finalizeCondition = [&](bool forceNegate = false) {
-        Condition cond;
-        cond.column = currentColumn;
-        cond.op     = currentOp;
-        cond.negate = (forceNegate || nextConditionShouldNegate);
-
-        if (cond.op == "IN") {
-            cond.inValues = inValueList;
-        } else {
-            cond.value = currentValue;
+// Helper: Evaluate a VARCHAR condition once per dictionary entry instead of once per row.
+// = and IN look their literals up in the dictionary; other operators compare every entry.
+static void bindDictionaryCodes(const ColumnData& column, BoundCondition& bound) {
+    const StringDictionary& dictionary = column.dictionary;
+    bound.onCodes = true;
+    bound.codeMatches.assign(dictionary.size(), 0);
+    if (bound.isIn) {
+        for (const auto& value : bound.stringValues) {
+            int32_t code = dictionary.find(value);
+            if (code >= 0) bound.codeMatches[code] = 1;
+        }
+    } else if (bound.op == CompareOp::EQ) {
+        int32_t code = dictionary.find(bound.stringValue);
+        if (code >= 0) bound.codeMatches[code] = 1;
+    } else {
+        std::string_view literal(bound.stringValue);
+        for (uint32_t code = 0; code < dictionary.size(); ++code) {
+            bound.codeMatches[code] = compareValues(dictionary.at(code), literal, bound.op);
         }
+    }
+}
 
-        conditions.push_back(std::make_pair(logicalOp, cond));
+// Helper: The INTEGER / FLOAT value of a literal. Numbers come converted by the parser; a quoted
+// or bare number ('42') is converted here. False if the literal is not a number of that type.
+static bool literalInt(const Literal& literal, int32_t& value) {
+    if (literal.kind == Literal::Kind::NUMBER) {
+        if (literal.intValue < std::numeric_limits<int32_t>::min() || literal.intValue > std::numeric_limits<int32_t>::max()) {
+            return false;
+        }
+        value = static_cast<int32_t>(literal.intValue);
+        return true;
+    }
+    const char* end = literal.text.data() + literal.text.size();
+    auto [last, error] = std::from_chars(literal.text.data(), end, value);
+    return error == std::errc() && last == end;
+}
 
-        // Reset state
-        currentColumn.clear();
-        currentOp.clear();
-        currentValue.clear();
-        inValueList.clear();
-        valueBuffer.clear();
-        inCondition = false;
-        inQuote     = false;
-        nextConditionShouldNegate = false;
-    };
+static bool literalFloat(const Literal& literal, float& value) {
+    if (literal.kind == Literal::Kind::NUMBER) {
+        value = literal.floatValue;
+        return true;
+    }
+    const char* end = literal.text.data() + literal.text.size();
+    auto [last, error] = std::from_chars(literal.text.data(), end, value);
+    return error == std::errc() && last == end;
+}
 
-    for (size_t i = 0; i < tokens.size(); ++i) {
-        std::string token = tokens[i];
-        if (token.empty()) continue;
+// Helper: Resolve one parsed condition against the table
+// All the per-row work that doesn't depend on the row is done here, once per query.
+static BoundCondition bindLiterals(const Table& table, const Condition& cond) {
+    BoundCondition bound;
+    bound.column = std::string(cond.column);
+    bound.negate = cond.negate;
+    bound.parameter = cond.parameter;
 
-        // 1) Check for logical operators
-        if (isLogical(token)) {
-            // If we see NOT, set the flag so if we see "IN" next, it's "NOT IN"
-            if (token == "NOT") {
-                nextConditionShouldNegate = true;
-            }
-            else {
-                // It's AND or OR
-                // If we are already building a condition, finalize it first
-                if (inCondition) {
-                    finalizeCondition(false);
+    // Find the column in the table that matches the condition's column name
+    int colIndex = table.findColumn(cond.column);
+
+    // If the column doesn't exist in the table, throw an error
+    if (colIndex < 0) {
+        throw std::runtime_error("Column '" + bound.column + "' does not exist.");
+    }
+    bound.columnIndex = static_cast<size_t>(colIndex);
+    bound.type = table.columns[colIndex].type;
+
+    // ****************************************// 
+    // Special handling for the "IN" operator
+    // ****************************************// 
+    if (cond.op == "IN") {
+        bound.isIn = true;
+        for (const auto& iv : cond.inValues) {
+            switch (bound.type) {
+                case DataType::INTEGER: {
+                    int32_t value = 0;
+                    if (literalInt(iv, value)) {
+                        bound.intValues.push_back(value);
+                    }
+                    // Skip values that cannot be converted to integers
+                    break;
                 }
-                logicalOp = token; // e.g. AND or OR
+                case DataType::FLOAT: {
+                    float value = 0.0f;
+                    if (literalFloat(iv, value)) {
+                        bound.floatValues.push_back(value);
+                    }
+                    // Skip values that cannot be converted to floats
+                    break;
+                }
+                case DataType::CHAR:
+                    if (!iv.text.empty()) {
+                        bound.charValues.push_back(iv.text[0]);
+                    }
+                    break;
+                case DataType::DATE: {
+                    int32_t days = 0;
+                    if (parseDate(iv.text, days)) {
+                        bound.intValues.push_back(days);
+                    }
+                    // Skip values that are not valid dates
+                    break;
+                }
+                case DataType::VARCHAR:
+                    bound.stringValues.emplace_back(iv.text);
+                    break;
             }
-            continue;
         }
 
-        // 2) If not a logical operator, we are parsing a condition piece
-        if (!inCondition) {
-            // Start a new condition
-            inCondition   = true;
-            currentColumn = token; // Take the column name and save it to our condition
+        // Build the lookup set once for the whole query
+        switch (bound.type) {
+            case DataType::INTEGER:
+            case DataType::DATE:    bound.intSet = IntInSet(bound.intValues); break;
+            case DataType::FLOAT:   bound.floatSet = FloatInSet(bound.floatValues); break;
+            case DataType::CHAR:    bound.charSet = CharInSet(bound.charValues); break;
+            case DataType::VARCHAR: bound.stringSet = StringInSet(bound.stringValues); break;
         }
-        else if (currentOp.empty()) {
-            // Check for multi-character operators
-            // e.g. if token == ">" and next token == "=", combine into ">="
-            if ((token == ">" || token == "<" || token == "!") &&
-                i + 1 < tokens.size() && tokens[i+1] == "=") {
-                currentOp = token + "=";
-                ++i; // Skip the next token
-            }
-            else if (token == "IN") {
-                // Check if we had a preceding NOT
-                currentOp = "IN";
-            }
-            else {
-                // Simple operator: =, >, <, >=, <=, !=
-                currentOp = token;
-            }
+        if (table.data[colIndex].dictionaryEncoded) {
+            bindDictionaryCodes(table.data[colIndex], bound);
         }
-        else {
-            // We have column & operator, now parse value(s)
-            if (currentOp == "IN") {
-                // We might see something like: ( 'Anton', 'Maria');
-                // or multiple tokens with parentheses
+        return bound;
+    }
+
+    // *******************************************************************// 
+    // If there is no "IN" operator, then there is Conditional Operator
+    // *******************************************************************// 
+    bound.op = parseCompareOp(cond.op);
+    if (bound.parameter >= 0) {
+        return bound;   // '?': the literal comes with every execution
+    }
 
-                // Remove leading '(' if present
-                if (!token.empty() && token.front() == '(') {
-                    token.erase(token.begin());
+    const std::string_view text = cond.value.text;
+    try {
+        switch (bound.type) {
+            case DataType::INTEGER:
+                if (!literalInt(cond.value, bound.intValue)) {
+                    throw std::runtime_error("Not an INTEGER.");
                 }
-                // Remove trailing ')' or ';' or ',' if present
-                while (!token.empty() &&
-                       (token.back() == ')' || token.back() == ';' || token.back() == ',')) {
-                    token.pop_back();
+                break;
+            case DataType::FLOAT:
+                if (!literalFloat(cond.value, bound.floatValue)) {
+                    throw std::runtime_error("Not a FLOAT.");
                 }
-
-                // Now we might have a chunk like "'Anton'," or "'Maria'"
-                // Split by comma if multiple items remain in the same token
-                std::vector<std::string> pieces = split(token, ',');
-                for (auto &p : pieces) {
-                    p = trim(p);       // remove extra spaces
-                    p = stripQuotes(p);
-                    if (!p.empty()) {
-                        inValueList.push_back(p);
-                    }
+                break;
+            case DataType::CHAR:
+                if (text.empty()) {
+                    throw std::runtime_error("Empty string in WHERE clause for char comparison.");
                 }
+                bound.charValue = text[0];
+                break;
+            case DataType::DATE:
+                // Parsed once here; rows are compared as days since the epoch
+                bound.intValue = parseDateOrThrow(text);
+                break;
+            case DataType::VARCHAR:
+                bound.stringValue = std::string(text);
+                break;
+        }
+    }
+    // *********************// 
+    // The rest of the cases
+    // *********************// 
+    catch (...) {
+        // Catch any errors (e.g., type mismatch) and throw a descriptive error
+        throw std::runtime_error("Type mismatch in WHERE clause: Cannot compare '"
+                                 + std::string(text) + "' to column '" + bound.column + "'");
+    }
+    if (table.data[colIndex].dictionaryEncoded) {
+        bindDictionaryCodes(table.data[colIndex], bound);
+    }
 
-                // If the original token had a `)`, we assume IN list is done
-                if (tokens[i].find(')') != std::string::npos) {
-                    finalizeCondition(nextConditionShouldNegate);
-                }
+    return bound;
+}
+
+// Helper: Set the literal of a '?' condition. The value is already of the column's type.
+static void bindParameterValue(BoundCondition& cond, const Value& value) {
+    switch (cond.type) {
+        case DataType::INTEGER:
+        case DataType::DATE:    cond.intValue = value.asInt(); break;
+        case DataType::FLOAT:   cond.floatValue = value.asFloat(); break;
+        case DataType::CHAR:    cond.charValue = value.asChar(); break;
+        case DataType::VARCHAR: cond.stringValue = std::string(value.asString()); break;
+    }
+}
+
+void bindParameters(const Table& table, BoundCondition& cond, const std::vector<Value>& parameters) {
+    const ColumnData& column = table.data[cond.columnIndex];
+    if (cond.parameter >= 0) {
+        const Value& value = parameters.at(static_cast<size_t>(cond.parameter));
+        if (!valueMatches(cond.type, value)) {
+            throw std::runtime_error("Type mismatch in WHERE clause: parameter " + std::to_string(cond.parameter + 1) +
+                                     " cannot be compared to column '" + cond.column + "'");
+        }
+        bindParameterValue(cond, value);
+    } else if (column.dictionaryEncoded == cond.onCodes &&
+               (!cond.onCodes || cond.codeMatches.size() == column.dictionary.size())) {
+        return;     // codes (if any) are still those of the current dictionary
+    }
+    cond.onCodes = false;
+    cond.codeMatches.clear();
+    if (column.dictionaryEncoded) {
+        bindDictionaryCodes(column, cond);
+    }
+}
+
+void bindParameters(const Table& table, BoundPredicate& predicate, const std::vector<Value>& parameters) {
+    for (auto& cond : predicate.conditions) {
+        bindParameters(table, cond, parameters);
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Estimates for ordering
+
+// Default guesses when the table can't tell (e.g. a '?' whose value comes later)
+constexpr double kDefaultEqualSelectivity = 0.1;
+constexpr double kDefaultRangeSelectivity = 1.0 / 3.0;
+
+// Helper: Fraction of values in [lo, hi] below `v` (linear interpolation over the column's range)
+static double fractionBelow(double lo, double hi, double v) {
+    if (hi <= lo) return v > lo ? 1.0 : 0.0;
+    return std::clamp((v - lo) / (hi - lo), 0.0, 1.0);
+}
+
+// Helper: Guess the fraction of rows that pass a condition from what the table already keeps:
+// the dictionary for encoded VARCHAR columns (each entry assumed equally frequent), the zone maps'
+// overall min/max and distinct counts for the other columns, fixed guesses otherwise.
+static double estimateSelectivity(const Table& table, const BoundCondition& cond) {
+    const ColumnData& column = table.data[cond.columnIndex];
+    double selectivity = 0.0;
+
+    if (cond.onCodes && cond.parameter < 0) {
+        size_t matching = std::count(cond.codeMatches.begin(), cond.codeMatches.end(), 1);
+        selectivity = cond.codeMatches.empty() ? 0.0 : static_cast<double>(matching) / cond.codeMatches.size();
+    } else {
+        // Overall range and a lower bound for the number of distinct values
+        double lo = 0.0, hi = 0.0;
+        size_t distinct = 0;
+        bool numeric = cond.type != DataType::VARCHAR;
+        for (size_t g = 0; g < column.zones.size(); ++g) {
+            const ZoneMap& zone = column.zones[g];
+            double zoneLo = 0.0, zoneHi = 0.0;
+            switch (cond.type) {
+                case DataType::INTEGER:
+                case DataType::DATE:  zoneLo = zone.intMin; zoneHi = zone.intMax; break;
+                case DataType::FLOAT: zoneLo = zone.floatMin; zoneHi = zone.floatMax; break;
+                case DataType::CHAR:  zoneLo = zone.charMin; zoneHi = zone.charMax; break;
+                case DataType::VARCHAR: break;
             }
-            else {
-                // Single value for =, !=, >, <, etc.
-                // We want to handle quoted strings, possibly spanning multiple tokens
-                // But because we do naive space-splitting, let's do a simpler approach:
-                if (inQuote || (token.front() == '\'' || token.front() == '"')) {
-                    // Append to valueBuffer
-                    if (!valueBuffer.empty()) valueBuffer += " ";
-                    valueBuffer += token;
-
-                    // If we have matching quotes at start and end, finalize
-                    char start = valueBuffer.front();
-                    char end   = valueBuffer.back();
-                    if ((start == '\'' && end == '\'') || (start == '"' && end == '"')) {
-                        // We have a fully quoted string
-                        currentValue = stripQuotes(valueBuffer);
-                        finalizeCondition(nextConditionShouldNegate);
-                    }
-                    else {
-                        // We haven't closed the quote yet
-                        inQuote = true;
-                    }
-                }
-                else {
-                    // Unquoted single token
-                    currentValue = token;
-                    // Condition ends here
-                    finalizeCondition(nextConditionShouldNegate);
-                }
+            lo = (g == 0) ? zoneLo : std::min(lo, zoneLo);
+            hi = (g == 0) ? zoneHi : std::max(hi, zoneHi);
+            distinct = std::max<size_t>(distinct, zone.distinctCount);
+        }
+        double equal = (distinct > 0) ? 1.0 / static_cast<double>(distinct) : kDefaultEqualSelectivity;
+        bool known = cond.parameter < 0 && !column.zones.empty();
+
+        double literal = 0.0;
+        switch (cond.type) {
+            case DataType::INTEGER:
+            case DataType::DATE:  literal = cond.intValue; break;
+            case DataType::FLOAT: literal = cond.floatValue; break;
+            case DataType::CHAR:  literal = cond.charValue; break;
+            case DataType::VARCHAR: break;
+        }
+
+        if (cond.isIn) {
+            size_t values = cond.intValues.size() + cond.floatValues.size() + cond.charValues.size() +
+                            cond.stringValues.size();
+            selectivity = std::min(1.0, static_cast<double>(values) * equal);
+        } else if (!known) {
+            selectivity = (cond.op == CompareOp::EQ) ? kDefaultEqualSelectivity
+                        : (cond.op == CompareOp::NE) ? 1.0 - kDefaultEqualSelectivity : kDefaultRangeSelectivity;
+        } else {
+            bool outside = numeric && (literal < lo || literal > hi);
+            switch (cond.op) {
+                case CompareOp::EQ: selectivity = outside ? 0.0 : equal; break;
+                case CompareOp::NE: selectivity = outside ? 1.0 : 1.0 - equal; break;
+                case CompareOp::LT:
+                case CompareOp::LE:
+                    selectivity = numeric ? fractionBelow(lo, hi, literal) : kDefaultRangeSelectivity;
+                    break;
+                case CompareOp::GT:
+                case CompareOp::GE:
+                    selectivity = numeric ? 1.0 - fractionBelow(lo, hi, literal) : kDefaultRangeSelectivity;
+                    break;
             }
         }
     }
+    return cond.negate ? 1.0 - selectivity : selectivity;
+}
+
+// Helper: Relative cost of testing one row, 1 being a vectorized comparison of a number
+static double estimateCost(const BoundCondition& cond) {
+    if (cond.onCodes) {
+        return 1.5;     // one table lookup per 16-bit code
+    }
+    if (cond.type == DataType::VARCHAR) {
+        return cond.isIn ? 8.0 : 6.0;   // hashing or comparing strings
+    }
+    if (cond.isIn) {
+        size_t values = cond.intValues.size() + cond.floatValues.size() + cond.charValues.size();
+        return values <= kSimdInListMax ? 1.0 + 0.25 * static_cast<double>(values) : 4.0;
+    }
+    return 1.0;
+}
 
-    // If we still have a condition open (e.g. last token was an operator or partial value)
-    if (inCondition && !currentOp.empty()) {
-        // Possibly we were reading a quoted string that ended exactly at the last token
-        if (!valueBuffer.empty()) {
-            currentValue = stripQuotes(valueBuffer);
+BoundCondition bindCondition(const Table& table, const Condition& cond) {
+    BoundCondition bound = bindLiterals(table, cond);
+    bound.selectivity = estimateSelectivity(table, bound);
+    bound.cost = estimateCost(bound);
+    return bound;
+}
+
+// ---------------------------------------------------------------------------------------
+// Predicate trees
+
+// Helper: Build the node for `where`, with NOT pushed down to the conditions:
+// NOT (a AND b) = NOT a OR NOT b, NOT (a OR b) = NOT a AND NOT b, NOT NOT a = a
+static PredicateNode buildNode(const WhereClause& where, bool negate, BoundPredicate& predicate,
+                               const std::function<BoundCondition(const Condition&)>& bindLeaf) {
+    PredicateNode node;
+    switch (where.kind) {
+        case WhereClause::Kind::NONE:
+            break;
+        case WhereClause::Kind::CONDITION: {
+            Condition cond = where.condition;
+            cond.negate = cond.negate != negate;
+            node.kind = PredicateNode::Kind::CONDITION;
+            node.condition = predicate.conditions.size();
+            predicate.conditions.push_back(bindLeaf(cond));
+            break;
+        }
+        case WhereClause::Kind::NOT:
+            return buildNode(where.operands[0], !negate, predicate, bindLeaf);
+        case WhereClause::Kind::AND:
+        case WhereClause::Kind::OR: {
+            bool isAnd = (where.kind == WhereClause::Kind::AND) != negate;
+            node.kind = isAnd ? PredicateNode::Kind::AND : PredicateNode::Kind::OR;
+            for (const auto& operand : where.operands) {
+                PredicateNode child = buildNode(operand, negate, predicate, bindLeaf);
+                if (child.kind == node.kind) {
+                    // a AND (b AND c) is one AND of three operands
+                    for (auto& grandchild : child.operands) node.operands.push_back(std::move(grandchild));
+                } else {
+                    node.operands.push_back(std::move(child));
+                }
+            }
+            break;
         }
-        finalizeCondition(/*forceNegate*/nextConditionShouldNegate);
     }
+    return node;
+}
 
-    return conditions;
+BoundPredicate buildPredicate(const WhereClause& where, const std::function<BoundCondition(const Condition&)>& bindLeaf) {
+    BoundPredicate predicate;
+    predicate.root = buildNode(where, false, predicate, bindLeaf);
+    return predicate;
 }
 
-// Helper: Evaluate a condition for a single row
-// row - is the object we are evaluating
-// table - is the metadata (somehow we need to know datatypes)
-// cond - are the rules how we are evaluating the row
-bool evaluateCondition(const Row& row, const Table& table, const Condition& cond) {
-    // Find the column in the table that matches the condition's column name
-    auto colIt = std::find_if(
-        table.columns.begin(),
-        table.columns.end(),
-        [&](const Column& col) { return col.name == cond.column; }
-    );
+// Helper: Order the operands of `node` and fill in its estimates
+static void orderNode(const BoundPredicate& predicate, PredicateNode& node) {
+    if (node.kind == PredicateNode::Kind::CONDITION) {
+        node.selectivity = predicate.conditions[node.condition].selectivity;
+        node.cost = predicate.conditions[node.condition].cost;
+        return;
+    }
+    for (auto& operand : node.operands) {
+        orderNode(predicate, operand);
+    }
 
-    // If the column doesn't exist in the table, throw an error
-    if (colIt == table.columns.end()) {
-        throw std::runtime_error("Column '" + cond.column + "' does not exist.");
+    // An operand is worth running early when it is cheap and likely to decide the result:
+    // false for AND, true for OR (the classic cost / (1 - selectivity) rank)
+    bool isAnd = node.kind == PredicateNode::Kind::AND;
+    auto rank = [isAnd](const PredicateNode& operand) {
+        double decisive = isAnd ? 1.0 - operand.selectivity : operand.selectivity;
+        return operand.cost / std::max(decisive, 1e-9);
+    };
+    std::stable_sort(node.operands.begin(), node.operands.end(),
+                     [&rank](const PredicateNode& a, const PredicateNode& b) { return rank(a) < rank(b); });
+
+    // Expected cost with short-circuiting: each operand only sees the rows still undecided
+    double undecided = 1.0;
+    node.cost = 0.0;
+    for (const auto& operand : node.operands) {
+        node.cost += undecided * operand.cost;
+        undecided *= isAnd ? operand.selectivity : 1.0 - operand.selectivity;
+    }
+    node.selectivity = isAnd ? undecided : 1.0 - undecided;
+}
+
+void orderPredicate(BoundPredicate& predicate) {
+    orderNode(predicate, predicate.root);
+}
+
+// Helper: Copy a subtree of `source` into `predicate`, renumbering its conditions
+static PredicateNode copySubtree(BoundPredicate& predicate, const BoundPredicate& source, const PredicateNode& node) {
+    PredicateNode copy = node;
+    if (node.kind == PredicateNode::Kind::CONDITION) {
+        copy.condition = predicate.conditions.size();
+        predicate.conditions.push_back(source.conditions[node.condition]);
+        return copy;
+    }
+    copy.operands.clear();
+    for (const auto& operand : node.operands) {
+        copy.operands.push_back(copySubtree(predicate, source, operand));
+    }
+    return copy;
+}
+
+void addConjunct(BoundPredicate& predicate, const BoundPredicate& source, const PredicateNode& node) {
+    bool first = predicate.empty();
+    PredicateNode copy = copySubtree(predicate, source, node);
+    if (first) {
+        predicate.root = std::move(copy);
+        return;
+    }
+    if (predicate.root.kind != PredicateNode::Kind::AND) {
+        PredicateNode root;
+        root.operands.push_back(std::move(predicate.root));
+        predicate.root = std::move(root);
+    }
+    if (copy.kind == PredicateNode::Kind::AND) {
+        for (auto& operand : copy.operands) predicate.root.operands.push_back(std::move(operand));
+    } else {
+        predicate.root.operands.push_back(std::move(copy));
+    }
+}
+
+BoundPredicate bindConditions(const Table& table, const WhereClause& where) {
+    BoundPredicate predicate = buildPredicate(where, [&table](const Condition& cond) {
+        return bindCondition(table, cond);
+    });
+    orderPredicate(predicate);
+    return predicate;
+}
+
+// ---------------------------------------------------------------------------------------
+// Descriptions (EXPLAIN)
+
+static const char* compareOpText(CompareOp op) {
+    switch (op) {
+        case CompareOp::EQ: return "=";
+        case CompareOp::NE: return "!=";
+        case CompareOp::GT: return ">";
+        case CompareOp::LT: return "<";
+        case CompareOp::GE: return ">=";
+        case CompareOp::LE: return "<=";
+    }
+    return "?";
+}
+
+std::string describeCondition(const BoundCondition& cond) {
+    auto quoted = [](std::string_view text) { return "'" + std::string(text) + "'"; };
+    auto literal = [&](auto value) -> std::string {
+        using T = decltype(value);
+        if constexpr (std::is_same_v<T, char>) return quoted(std::string(1, value));
+        else if constexpr (std::is_same_v<T, std::string>) return quoted(value);
+        else if constexpr (std::is_same_v<T, float>) return fmt::format("{}", value);
+        else return cond.type == DataType::DATE ? quoted(formatDate(value)) : std::to_string(value);
+    };
+    auto list = [&](const auto& values) {
+        std::string text;
+        for (const auto& value : values) {
+            if (!text.empty()) text += ", ";
+            text += literal(value);
+        }
+        return "(" + text + ")";
+    };
+
+    if (cond.isIn) {
+        std::string values;
+        switch (cond.type) {
+            case DataType::INTEGER:
+            case DataType::DATE:    values = list(cond.intValues); break;
+            case DataType::FLOAT:   values = list(cond.floatValues); break;
+            case DataType::CHAR:    values = list(cond.charValues); break;
+            case DataType::VARCHAR: values = list(cond.stringValues); break;
+        }
+        return cond.column + (cond.negate ? " NOT IN " : " IN ") + values;
+    }
+
+    std::string value;
+    if (cond.parameter >= 0) {
+        value = "?" + std::to_string(cond.parameter + 1);
+    } else {
+        switch (cond.type) {
+            case DataType::INTEGER:
+            case DataType::DATE:    value = literal(cond.intValue); break;
+            case DataType::FLOAT:   value = literal(cond.floatValue); break;
+            case DataType::CHAR:    value = literal(cond.charValue); break;
+            case DataType::VARCHAR: value = literal(cond.stringValue); break;
+        }
+    }
+    std::string text = cond.column + " " + compareOpText(cond.op) + " " + value;
+    return cond.negate ? "NOT " + text : text;
+}
+
+static std::string describeNode(const BoundPredicate& predicate, const PredicateNode& node, bool nested) {
+    if (node.kind == PredicateNode::Kind::CONDITION) {
+        return describeCondition(predicate.conditions[node.condition]);
+    }
+    std::string text;
+    for (const auto& operand : node.operands) {
+        if (!text.empty()) text += (node.kind == PredicateNode::Kind::AND) ? " AND " : " OR ";
+        text += describeNode(predicate, operand, true);
     }
+    return (nested && node.operands.size() > 1) ? "(" + text + ")" : text;
+}
 
-    // std::distance calculates the number of steps from table.columns.begin() to colIt.
-    size_t colIndex = std::distance(table.columns.begin(), colIt);
-    const Column& column = *colIt; // Get the column metadata
-    const Value& value = row.values[colIndex]; // Get the value from the row for this column
+std::string describePredicate(const BoundPredicate& predicate) {
+    return predicate.empty() ? "" : describeNode(predicate, predicate.root, false);
+}
+
+// Helper: Evaluate a bound condition for a single row
+// table - holds the column arrays
+// rowId - is the position of the row we are evaluating
+// cond - are the rules how we are evaluating the row (already resolved to the column's type)
+bool evaluateCondition(const Table& table, size_t rowId, const BoundCondition& cond) {
+    // Only this column's array is touched, the rest of the row stays where it is
+    const ColumnData& column = table.data[cond.columnIndex];
 
     bool result = false; // Store the result of the condition evaluation
 
-    try {
-        // ****************************************// 
-        // Special handling for the "IN" operator
-        // ****************************************// 
-        if (cond.op == "IN") {
-            // Type-Safety: Ensure that the variant currently holds a value of type T before accessing it.
-            // Avoid Errors: Accessing the wrong type using std::get would throw a std::bad_variant_access exception. For example:
-            if (std::holds_alternative<std::string>(value)) {
-                // Handle IN operator for strings
-                const std::string& strValue = std::get<std::string>(value);
-                result = (std::find(cond.inValues.begin(), cond.inValues.end(), strValue)
-                          != cond.inValues.end());
-            } else if (std::holds_alternative<int>(value)) {
-                // Handle IN operator for integers
-                int intValue = std::get<int>(value);
-                for (const auto &iv : cond.inValues) {
-                    try {
-                        if (intValue == std::stoi(iv)) {
-                            result = true;
-                            break; // Exit loop if a match is found
-                        }
-                    } catch (...) {
-                        // Skip values that cannot be converted to integers
-                    }
-                }
-            } else if (std::holds_alternative<float>(value)) {
-                // Handle IN operator for floats
-                float floatValue = std::get<float>(value);
-                for (const auto &iv : cond.inValues) {
-                    try {
-                        float cmp = std::stof(iv);
-                        if (std::fabs(floatValue - cmp) < 1e-6) { // Allow for floating-point precision
-                            result = true;
-                            break; // Exit loop if a match is found
-                        }
-                    } catch (...) {
-                        // Skip values that cannot be converted to floats
-                    }
-                }
-            } else if (std::holds_alternative<char>(value)) {
-                // Handle IN operator for characters
-                char charValue = std::get<char>(value);
-                for (const auto &iv : cond.inValues) {
-                    if (!iv.empty() && iv[0] == charValue) {
-                        result = true;
-                        break; // Exit loop if a match is found
-                    }
-                }
-            }
-        } 
-        // *******************************************************************// 
-        // If there is no "IN" operator, then there is Conditional Operator
-        // *******************************************************************// 
-        else {
-            if (column.type == DataType::DATE) {
-                // Handle comparisons for date columns
-                if (!std::holds_alternative<std::string>(value)) {
-                    throw std::runtime_error("Invalid value for DATE column: " + cond.column);
-                }
-                const std::string& dateValue = std::get<std::string>(value);
-                result = compareValues(dateValue, cond.value, cond.op);
+    if (cond.isIn) {
+        switch (cond.type) {
+            case DataType::INTEGER:
+            case DataType::DATE:    result = cond.intSet.contains(column.intAt(rowId)); break;
+            case DataType::FLOAT:   result = cond.floatSet.contains(column.floatAt(rowId)); break;
+            case DataType::CHAR:    result = cond.charSet.contains(column.charAt(rowId)); break;
+            case DataType::VARCHAR:
+                result = cond.onCodes ? cond.codeMatches[column.codes[rowId]] != 0
+                                      : cond.stringSet.contains(column.stringAt(rowId));
+                break;
+        }
+    } else if (cond.onCodes) {
+        result = cond.codeMatches[column.codes[rowId]] != 0;
+    } else {
+        switch (cond.type) {
+            case DataType::INTEGER:
+            case DataType::DATE:
+                result = compareValues(column.intAt(rowId), cond.intValue, cond.op);
+                break;
+            case DataType::FLOAT: {
+                // Floats are compared with precision handling
+                float floatValue = column.floatAt(rowId);
+                if (cond.op == CompareOp::EQ) result = (std::fabs(floatValue - cond.floatValue) < 1e-6);
+                else if (cond.op == CompareOp::NE) result = (std::fabs(floatValue - cond.floatValue) >= 1e-6);
+                else result = compareValues(floatValue, cond.floatValue, cond.op);
+                break;
             }
-            else if (std::holds_alternative<int>(value)) {
-                // Handle comparisons for integers
-                int intValue = std::get<int>(value);
-                int condValue = std::stoi(cond.value);
-                result = compareValues(intValue, condValue, cond.op);
+            case DataType::CHAR:
+                result = compareValues(column.charAt(rowId), cond.charValue, cond.op);
+                break;
+            case DataType::VARCHAR:
+                result = compareValues(column.stringAt(rowId), std::string_view(cond.stringValue), cond.op);
+                break;
+        }
+    }
+
+    // Apply negation if the condition specifies it (for "NOT IN" or "NOT <op>")
+    return cond.negate ? !result : result;
+}
+
+bool BoundPredicate::operator()(const Table& table, size_t rowId) const {
+    return evaluatePredicate(root, [&](size_t c) { return evaluateCondition(table, rowId, conditions[c]); });
+}
+
+// Helper: Evaluate one bound condition for the rows of block [start, start + count) selected by `mask`
+// Numeric and char columns go through the vectorized kernels over the whole block (cheaper than
+// picking rows); strings and codes are only tested for the selected rows.
+// Bit i of `bits` is set when row start + i is selected and matches.
+static void evaluateConditionBlock(const Table& table, const BoundCondition& cond,
+                                   size_t start, size_t count, const uint64_t* mask, uint64_t* bits) {
+    const ColumnData& column = table.data[cond.columnIndex];
+    size_t words = (count + 63) / 64;
+
+    // Sets a bit for every selected row whose value passes `test`
+    bool masked = false;
+    auto scalarBlock = [&](auto test) {
+        for (size_t w = 0; w < words; ++w) {
+            uint64_t result = 0;
+            for (uint64_t pending = mask[w]; pending != 0; pending &= pending - 1) {
+                int bit = __builtin_ctzll(pending);
+                result |= static_cast<uint64_t>(test(start + w * 64 + bit)) << bit;
             }
-            else if (std::holds_alternative<float>(value)) {
-                // Handle comparisons for floats with precision handling
-                float floatValue = std::get<float>(value);
-                float condValue = std::stof(cond.value);
-                if (cond.op == "=") result = (std::fabs(floatValue - condValue) < 1e-6);
-                else if (cond.op == "!=") result = (std::fabs(floatValue - condValue) >= 1e-6);
-                else result = compareValues(floatValue, condValue, cond.op);
+            bits[w] = result;
+        }
+        masked = true;
+    };
+
+    // Run-length encoded group: the condition is tested once per run and whole runs of bits are set
+    const EncodedGroup* group = column.encodedGroupAt(start);
+    if (group != nullptr && group->encoding() == ColumnEncoding::RLE) {
+        std::fill(bits, bits + (count + 63) / 64, 0);
+        group->forEachRun(start % kRowGroupSize, count, [&](int32_t value, size_t offset, size_t length) {
+            bool match = false;
+            if (cond.type == DataType::CHAR) {
+                char c = static_cast<char>(value);
+                match = cond.isIn ? cond.charSet.contains(c) : compareValues(c, cond.charValue, cond.op);
+            } else {
+                match = cond.isIn ? cond.intSet.contains(value) : compareValues(value, cond.intValue, cond.op);
             }
-            else if (std::holds_alternative<char>(value)) {
-                // Handle comparisons for characters
-                char charValue = std::get<char>(value);
-                if (cond.value.empty()) {
-                    throw std::runtime_error("Empty string in WHERE clause for char comparison.");
-                }
-                result = compareValues(charValue, cond.value[0], cond.op);
+            if (match) bitmapSetRange(bits, offset, offset + length);
+        });
+        if (cond.negate) {
+            bitmapNot(bits, count);
+        }
+        bitmapAnd(bits, mask, count);
+        return;
+    }
+
+    switch (cond.type) {
+        case DataType::INTEGER:
+        case DataType::DATE: {
+            // Compressed groups are decoded a block at a time into `scratch`
+            int32_t scratch[kFilterBlockSize];
+            const int32_t* values = column.intBlock(start, count, scratch);
+            if (!cond.isIn) filterInt32(values, count, cond.op, cond.intValue, bits);
+            else if (cond.intValues.size() <= kSimdInListMax) filterInt32In(values, count, cond.intValues, bits);
+            else scalarBlock([&](size_t r) { return cond.intSet.contains(values[r - start]); });
+            break;
+        }
+        case DataType::FLOAT: {
+            const float* values = column.floats.data() + start;
+            if (!cond.isIn) filterFloat(values, count, cond.op, cond.floatValue, bits);
+            else if (cond.floatValues.size() <= kSimdInListMax) filterFloatIn(values, count, cond.floatValues, bits);
+            else scalarBlock([&](size_t r) { return cond.floatSet.contains(column.floatAt(r)); });
+            break;
+        }
+        case DataType::CHAR: {
+            char scratch[kFilterBlockSize];
+            const char* values = column.charBlock(start, count, scratch);
+            if (!cond.isIn) filterChar(values, count, cond.op, cond.charValue, bits);
+            else if (cond.charValues.size() <= kSimdInListMax) filterCharIn(values, count, cond.charValues, bits);
+            else scalarBlock([&](size_t r) { return cond.charSet.contains(values[r - start]); });
+            break;
+        }
+        case DataType::VARCHAR: {
+            if (cond.onCodes) {
+                // One table lookup per row on the 16-bit codes, no string is read
+                const uint16_t* codes = column.codes.data();
+                const uint8_t* matches = cond.codeMatches.data();
+                scalarBlock([&](size_t r) { return matches[codes[r]] != 0; });
+            } else if (cond.isIn) {
+                scalarBlock([&](size_t r) { return cond.stringSet.contains(column.stringAt(r)); });
+            } else {
+                std::string_view literal(cond.stringValue);
+                scalarBlock([&](size_t r) { return compareValues(column.stringAt(r), literal, cond.op); });
             }
-            else if (std::holds_alternative<std::string>(value)) {
-                // Handle comparisons for strings
-                const std::string& strValue = std::get<std::string>(value);
-                result = compareValues(strValue, cond.value, cond.op);
+            break;
+        }
+    }
+
+    if (cond.negate) {
+        bitmapNot(bits, count);
+    }
+    if (masked) {
+        // A negated scalar result has bits set for unselected rows too
+        if (cond.negate) bitmapAnd(bits, mask, count);
+    } else {
+        bitmapAnd(bits, mask, count);
+    }
+}
+
+// Helper: Evaluate a predicate node for the rows of a block selected by `mask` (see evaluateConditionBlock).
+// The operands run in the order orderPredicate chose and each one only looks at the rows still
+// undecided: an AND operand at the rows that passed every earlier operand, an OR operand at the rows
+// that failed them; once no row is undecided the remaining operands are skipped.
+static void evaluateNodeBlock(const Table& table, const BoundPredicate& predicate, const PredicateNode& node,
+                              size_t start, size_t count, const uint64_t* mask, uint64_t* bits) {
+    size_t words = (count + 63) / 64;
+    if (node.kind == PredicateNode::Kind::CONDITION) {
+        evaluateConditionBlock(table, predicate.conditions[node.condition], start, count, mask, bits);
+        return;
+    }
+
+    uint64_t undecided[kFilterBlockWords];
+    uint64_t operandBits[kFilterBlockWords];
+    std::copy(mask, mask + words, undecided);
+    bool isAnd = node.kind == PredicateNode::Kind::AND;
+    for (const auto& operand : node.operands) {
+        if (bitmapNone(undecided, count)) break;
+        evaluateNodeBlock(table, predicate, operand, start, count, undecided, operandBits);
+        for (size_t w = 0; w < words; ++w) {
+            // AND: rows that passed stay undecided; OR: rows that passed are decided
+            undecided[w] = isAnd ? operandBits[w] : (undecided[w] & ~operandBits[w]);
+        }
+    }
+    for (size_t w = 0; w < words; ++w) {
+        bits[w] = isAnd ? undecided[w] : (mask[w] & ~undecided[w]);
+    }
+}
+
+static_assert(kRowGroupSize % kFilterBlockSize == 0 && kMorselRows % kRowGroupSize == 0,
+              "row groups must be whole filter blocks and morsels whole row groups");
+
+// What a zone map says about a condition over one row group
+enum class ZoneMatch { NONE, SOME, ALL };
+
+// Compares the literal `v` with a group whose values lie in [lo, hi]
+template <typename T>
+static ZoneMatch matchRange(const T& lo, const T& hi, CompareOp op, const T& v) {
+    switch (op) {
+        case CompareOp::EQ:
+            if (v < lo || hi < v) return ZoneMatch::NONE;
+            return (!(lo < v) && !(v < hi)) ? ZoneMatch::ALL : ZoneMatch::SOME;
+        case CompareOp::NE:
+            if (v < lo || hi < v) return ZoneMatch::ALL;
+            return (!(lo < v) && !(v < hi)) ? ZoneMatch::NONE : ZoneMatch::SOME;
+        case CompareOp::LT:
+            if (!(lo < v)) return ZoneMatch::NONE;
+            return (hi < v) ? ZoneMatch::ALL : ZoneMatch::SOME;
+        case CompareOp::LE:
+            if (v < lo) return ZoneMatch::NONE;
+            return !(v < hi) ? ZoneMatch::ALL : ZoneMatch::SOME;
+        case CompareOp::GT:
+            if (!(v < hi)) return ZoneMatch::NONE;
+            return (v < lo) ? ZoneMatch::ALL : ZoneMatch::SOME;
+        case CompareOp::GE:
+            if (hi < v) return ZoneMatch::NONE;
+            return !(lo < v) ? ZoneMatch::ALL : ZoneMatch::SOME;
+    }
+    return ZoneMatch::SOME;
+}
+
+// FLOAT (in)equality uses a tolerance, so the range is widened and never proves "all rows"
+static ZoneMatch matchFloatRange(float lo, float hi, CompareOp op, float v) {
+    if (op != CompareOp::EQ && op != CompareOp::NE) {
+        return matchRange(lo, hi, op, v);
+    }
+    bool outside = (v + 2 * kFloatEpsilon < lo || v - 2 * kFloatEpsilon > hi);
+    if (!outside) return ZoneMatch::SOME;
+    return op == CompareOp::EQ ? ZoneMatch::NONE : ZoneMatch::ALL;
+}
+
+// IN list: no row matches if every literal misses, all rows do if one literal is the only value
+template <typename T, typename Match>
+static ZoneMatch matchRangeIn(const std::vector<T>& values, Match matchOne) {
+    ZoneMatch result = ZoneMatch::NONE;
+    for (const auto& value : values) {
+        ZoneMatch match = matchOne(value);
+        if (match == ZoneMatch::ALL) return ZoneMatch::ALL;
+        if (match == ZoneMatch::SOME) result = ZoneMatch::SOME;
+    }
+    return result;
+}
+
+static ZoneMatch matchZone(const ZoneMap& zone, const BoundCondition& cond) {
+    ZoneMatch result = ZoneMatch::SOME;
+    switch (cond.type) {
+        case DataType::INTEGER:
+        case DataType::DATE: {
+            auto matchOne = [&](int32_t v) { return matchRange(zone.intMin, zone.intMax, CompareOp::EQ, v); };
+            result = cond.isIn ? matchRangeIn(cond.intValues, matchOne)
+                               : matchRange(zone.intMin, zone.intMax, cond.op, cond.intValue);
+            break;
+        }
+        case DataType::FLOAT: {
+            auto matchOne = [&](float v) { return matchFloatRange(zone.floatMin, zone.floatMax, CompareOp::EQ, v); };
+            result = cond.isIn ? matchRangeIn(cond.floatValues, matchOne)
+                               : matchFloatRange(zone.floatMin, zone.floatMax, cond.op, cond.floatValue);
+            break;
+        }
+        case DataType::CHAR: {
+            auto matchOne = [&](char v) { return matchRange(zone.charMin, zone.charMax, CompareOp::EQ, v); };
+            result = cond.isIn ? matchRangeIn(cond.charValues, matchOne)
+                               : matchRange(zone.charMin, zone.charMax, cond.op, cond.charValue);
+            break;
+        }
+        case DataType::VARCHAR: {
+            std::string_view lo(zone.stringMin), hi(zone.stringMax);
+            auto matchOne = [&](const std::string& v) { return matchRange(lo, hi, CompareOp::EQ, std::string_view(v)); };
+            result = cond.isIn ? matchRangeIn(cond.stringValues, matchOne)
+                               : matchRange(lo, hi, cond.op, std::string_view(cond.stringValue));
+            break;
+        }
+    }
+
+    if (cond.negate && result != ZoneMatch::SOME) {
+        result = (result == ZoneMatch::NONE) ? ZoneMatch::ALL : ZoneMatch::NONE;
+    }
+    return result;
+}
+
+// Bloom index probe of one = / IN condition: the index and the hashes of its literals
+struct BloomProbe {
+    const TableIndex* index = nullptr;
+    std::vector<uint64_t> hashes;
+};
+
+// One probe per condition; conditions that can't use a Bloom filter get an empty probe
+static std::vector<BloomProbe> bloomProbes(const Table& table, const BoundPredicate& predicate) {
+    std::vector<BloomProbe> probes(predicate.conditions.size());
+    for (size_t t = 0; t < predicate.conditions.size(); ++t) {
+        const BoundCondition& cond = predicate.conditions[t];
+        if (!cond.isIn && cond.op != CompareOp::EQ) continue;
+        const TableIndex* index = table.findIndex(cond.columnIndex, IndexKind::BLOOM);
+        if (index == nullptr) continue;
+
+        probes[t].index = index;
+        if (cond.type == DataType::DATE) {
+            if (cond.isIn) {
+                for (int32_t value : cond.intValues) probes[t].hashes.push_back(bloomHash(value));
+            } else {
+                probes[t].hashes.push_back(bloomHash(cond.intValue));
             }
+        } else if (cond.isIn) {
+            for (const auto& value : cond.stringValues) probes[t].hashes.push_back(bloomHash(value));
+        } else {
+            probes[t].hashes.push_back(bloomHash(cond.stringValue));
         }
     }
-    // *********************// 
-    // The rest of the cases
-    // *********************// 
-    catch (...) {
-        // Catch any errors (e.g., type mismatch) and throw a descriptive error
-        throw std::runtime_error("Type mismatch in WHERE clause: Cannot compare '"
-                                 + cond.value + "' to column '" + cond.column + "'");
+    return probes;
+}
+
+// What the zone maps of row group `group` say about a predicate node: AND is NONE as soon as one
+// operand is, OR is ALL as soon as one operand is.
+// When min/max can't rule a = / IN condition out, its Bloom filter (if any) gets a try.
+static ZoneMatch matchZones(const Table& table, const BoundPredicate& predicate, const PredicateNode& node,
+                            size_t group, const std::vector<BloomProbe>& probes) {
+    if (node.kind == PredicateNode::Kind::CONDITION) {
+        const BoundCondition& cond = predicate.conditions[node.condition];
+        ZoneMatch match = matchZone(table.data[cond.columnIndex].zones[group], cond);
+        const BloomProbe& probe = probes[node.condition];
+        if (match == ZoneMatch::SOME && probe.index != nullptr && !probe.index->groupMayContain(group, probe.hashes)) {
+            // None of the values is in the group: the condition is false on every row (true if negated)
+            match = cond.negate ? ZoneMatch::ALL : ZoneMatch::NONE;
+        }
+        return match;
     }
 
-    // Apply negation if the condition specifies it (for "NOT IN" or "NOT <op>")
-    return cond.negate ? !result : result;
+    bool isAnd = node.kind == PredicateNode::Kind::AND;
+    ZoneMatch decisive = isAnd ? ZoneMatch::NONE : ZoneMatch::ALL;
+    ZoneMatch result = isAnd ? ZoneMatch::ALL : ZoneMatch::NONE;
+    for (const auto& operand : node.operands) {
+        ZoneMatch match = matchZones(table, predicate, operand, group, probes);
+        if (match == decisive) return decisive;
+        if (match == ZoneMatch::SOME) result = ZoneMatch::SOME;
+    }
+    return result;
 }
 
 // Helper: Apply WHERE clause to rows
-std::vector<Row> filterRows(const Table& table, const std::vector<std::pair<std::string, Condition>>& conditions) {
-    std::vector<Row> filteredRows;
+void filterRows(const Table& table, const BoundPredicate& predicate,
+                size_t begin, size_t end, const SelectionConsumer& consume, ScanStats* stats) {
+    SelectionVector blockSelection;
+    blockSelection.reserve(kFilterBlockSize);
 
-    for (const auto& row : table.rows) {
-        bool overallResult = (conditions.empty() || conditions[0].first.empty()) ? true : false;
+    uint64_t all[kFilterBlockWords];
+    uint64_t result[kFilterBlockWords];
+    std::vector<BloomProbe> probes = bloomProbes(table, predicate);
+    size_t skipped = 0, passed = 0;
 
-        for (const auto& [logicalOp, cond] : conditions) {
-            bool condResult = evaluateCondition(row, table, cond);
+    for (size_t start = begin; start < end;) {
+        // Row groups whose zone maps (or Bloom filters) rule the predicate out are skipped without reading a value;
+        // in groups where the zone maps prove every row passes, no condition is evaluated
+        size_t group = start / kRowGroupSize;
+        size_t groupEnd = std::min(end, (group + 1) * kRowGroupSize);
+        ZoneMatch zone = predicate.empty() ? ZoneMatch::ALL : matchZones(table, predicate, predicate.root, group, probes);
+        if (zone == ZoneMatch::NONE) {
+            skipped += groupEnd - start;
+            start = groupEnd;
+            continue;
+        }
+        if (zone == ZoneMatch::ALL) {
+            passed += groupEnd - start;
+        }
 
-            if (logicalOp == "AND") {
-                overallResult = overallResult && condResult;
-            } else if (logicalOp == "OR") {
-                overallResult = overallResult || condResult;
+        for (; start < groupEnd; start += kFilterBlockSize) {
+            size_t count = std::min(kFilterBlockSize, groupEnd - start);
+
+            // Every row of the block
+            std::fill(all, all + kFilterBlockWords, 0);
+            bitmapNot(all, count);
+            if (zone == ZoneMatch::ALL) {
+                std::copy(all, all + kFilterBlockWords, result);
             } else {
-                // For the first condition or if no logicalOp is given
-                overallResult = condResult;
+                evaluateNodeBlock(table, predicate, predicate.root, start, count, all, result);
             }
+
+            // Hand the block's matches to the consumer, nothing is kept here
+            blockSelection.clear();
+            bitmapToSelection(result, count, static_cast<uint32_t>(start), blockSelection);
+            if (!blockSelection.empty()) {
+                consume(blockSelection.data(), blockSelection.size());
+            }
+        }
+    }
+
+    if (stats != nullptr) {
+        stats->rowsSkippedByZones += skipped;
+        stats->rowsPassedByZones += passed;
+        stats->rowsFiltered += (end - begin) - skipped - passed;
+    }
+}
+
+void filterRows(const Table& table, const BoundPredicate& predicate, const SelectionConsumer& consume) {
+    ScanPlan(table, &predicate).runSerial(consume);
+}
+
+SelectionVector filterRows(const Table& table, const BoundPredicate& predicate) {
+    return ScanPlan(table, &predicate).collect();
+}
+
+// ---------------------------------------------------------------------------------------
+// Helper: The conditions every matching row passes: the predicate itself if it is one condition,
+// the conditions directly under a top-level AND otherwise (none for a top-level OR)
+static std::vector<size_t> requiredConditions(const BoundPredicate& predicate) {
+    const PredicateNode& root = predicate.root;
+    if (root.kind == PredicateNode::Kind::CONDITION) {
+        return {root.condition};
+    }
+    std::vector<size_t> required;
+    if (root.kind == PredicateNode::Kind::AND) {
+        for (const auto& operand : root.operands) {
+            if (operand.kind == PredicateNode::Kind::CONDITION) required.push_back(operand.condition);
+        }
+    }
+    return required;
+}
+
+ScanPlan::ScanPlan(const Table& table, const BoundPredicate* predicate) : table(table), predicate(predicate) {
+    if (predicate == nullptr || predicate->empty() || table.indexes.empty()) {
+        return;
+    }
+    if (planBitmaps()) {
+        return;
+    }
+
+    // Any condition the whole predicate depends on can drive the lookup (in the order chosen by
+    // orderPredicate, so the most selective first)
+    size_t maxRows = static_cast<size_t>(static_cast<double>(table.size()) * kIndexMaxSelectivity);
+    for (size_t c : requiredConditions(*predicate)) {
+        const BoundCondition& cond = predicate->conditions[c];
+        const TableIndex* index = table.findIndex(cond.columnIndex, IndexKind::BTREE);
+        if (index == nullptr || !index->canAnswer(cond)) {
+            continue;
+        }
+
+        SelectionVector rows;
+        if (!index->lookup(cond, maxRows, rows)) {
+            continue; // not selective enough
+        }
+
+        // Row order, no duplicates (IN lists may repeat a value), then re-check the whole predicate
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+        bool exact = (predicate->conditions.size() == 1 && cond.type != DataType::FLOAT);
+        if (!exact) {
+            rows.erase(std::remove_if(rows.begin(), rows.end(),
+                                      [&](uint32_t row) { return !(*predicate)(table, row); }),
+                       rows.end());
+        }
+
+        usedIndex = index;
+        accessKind = Access::BTREE;
+        indexRows = std::move(rows);
+        return;
+    }
+}
+
+// Helper: Evaluate a predicate node with bitmap indexes only (every condition has one);
+// AND stops at an empty result, OR at a full one
+static RoaringBitmap matchBitmaps(const BoundPredicate& predicate, const PredicateNode& node,
+                                  const std::vector<const TableIndex*>& bitmaps, uint32_t rowCount) {
+    if (node.kind == PredicateNode::Kind::CONDITION) {
+        return bitmaps[node.condition]->matchBitmap(predicate.conditions[node.condition], rowCount);
+    }
+    bool isAnd = node.kind == PredicateNode::Kind::AND;
+    RoaringBitmap result = matchBitmaps(predicate, node.operands[0], bitmaps, rowCount);
+    for (size_t i = 1; i < node.operands.size(); ++i) {
+        if (isAnd ? result.empty() : result.cardinality() == rowCount) break;
+        RoaringBitmap operand = matchBitmaps(predicate, node.operands[i], bitmaps, rowCount);
+        result = isAnd ? RoaringBitmap::andOf(result, operand) : RoaringBitmap::orOf(result, operand);
+    }
+    return result;
+}
+
+bool ScanPlan::planBitmaps() {
+    const auto& conditions = predicate->conditions;
+    uint32_t rowCount = static_cast<uint32_t>(table.size());
+
+    // Which conditions have a bitmap index on their column
+    std::vector<const TableIndex*> bitmaps(conditions.size(), nullptr);
+    bool allCovered = true;
+    for (size_t c = 0; c < conditions.size(); ++c) {
+        const TableIndex* index = table.findIndex(conditions[c].columnIndex, IndexKind::BITMAP);
+        if (index != nullptr) {
+            bitmaps[c] = index;
+            if (usedIndex == nullptr) usedIndex = index;
+        } else {
+            allCovered = false;
         }
+    }
+    if (usedIndex == nullptr) {
+        return false;
+    }
+
+    if (allCovered) {
+        // The whole WHERE clause is bitmap work; no row is read and the result is exact
+        matchBitmaps(*predicate, predicate->root, bitmaps, rowCount).toVector(indexRows);
+        accessKind = Access::BITMAP;
+        return true;
+    }
+
+    // AND the bitmaps of the covered conditions every match depends on; if that narrows things
+    // down enough, only those rows are checked against the rest of the predicate
+    RoaringBitmap candidates;
+    bool first = true;
+    for (size_t c : requiredConditions(*predicate)) {
+        if (bitmaps[c] == nullptr) continue;
+        RoaringBitmap matches = bitmaps[c]->matchBitmap(conditions[c], rowCount);
+        candidates = first ? std::move(matches) : RoaringBitmap::andOf(candidates, matches);
+        first = false;
+    }
+    size_t maxRows = static_cast<size_t>(static_cast<double>(table.size()) * kIndexMaxSelectivity);
+    if (!first && candidates.cardinality() <= maxRows) {
+        candidates.toVector(indexRows);
+        indexRows.erase(std::remove_if(indexRows.begin(), indexRows.end(),
+                                       [&](uint32_t row) { return !(*predicate)(table, row); }),
+                        indexRows.end());
+        accessKind = Access::BITMAP_CANDIDATES;
+        return true;
+    }
 
-        if (overallResult) {
-            filteredRows.push_back(row);
+    // Not useful here: let the B+tree indexes or a scan handle it
+    usedIndex = nullptr;
+    return false;
+}
+
+size_t ScanPlan::morselCount() const {
+    return ::morselCount(inputSize());
+}
+
+void ScanPlan::runRange(size_t begin, size_t end, const SelectionConsumer& consume) const {
+    if (usedIndex != nullptr) {
+        for (size_t start = begin; start < end; start += kFilterBlockSize) {
+            consume(indexRows.data() + start, std::min(kFilterBlockSize, end - start));
         }
+        return;
+    }
+    if (predicate != nullptr) {
+        filterRows(table, *predicate, begin, end, consume, stats);
+        return;
     }
+    uint32_t rowIds[kFilterBlockSize];
+    for (size_t start = begin; start < end; start += kFilterBlockSize) {
+        size_t count = std::min(kFilterBlockSize, end - start);
+        for (size_t i = 0; i < count; ++i) rowIds[i] = static_cast<uint32_t>(start + i);
+        consume(rowIds, count);
+    }
+}
+
+void ScanPlan::run(const MorselConsumer& consume) const {
+    ThreadPool::instance().parallelFor(morselCount(), [&](size_t worker, size_t morsel) {
+        size_t begin = morsel * kMorselRows;
+        size_t end = std::min(inputSize(), begin + kMorselRows);
+        runRange(begin, end, [&](const uint32_t* rowIds, size_t count) {
+            consume(worker, morsel, rowIds, count);
+        });
+    });
+}
 
-    return filteredRows;
+void ScanPlan::runSerial(const SelectionConsumer& consume) const {
+    runRange(0, inputSize(), consume);
+}
+
+SelectionVector ScanPlan::collect() const {
+    if (usedIndex != nullptr) {
+        return indexRows;
+    }
+
+    // Every morsel is filtered into its own selection vector on the thread pool,
+    // then the vectors are concatenated in morsel order so the result is the same as a serial scan
+    ThreadPool& pool = ThreadPool::instance();
+    size_t morsels = morselCount();
+    std::vector<SelectionVector> morselSelections(morsels);
+    run([&](size_t, size_t morsel, const uint32_t* rowIds, size_t count) {
+        morselSelections[morsel].insert(morselSelections[morsel].end(), rowIds, rowIds + count);
+    });
+
+    if (morsels == 0) {
+        return {};
+    }
+    if (morsels == 1) {
+        return std::move(morselSelections[0]);
+    }
+    std::vector<size_t> offsets(morsels + 1, 0);
+    for (size_t m = 0; m < morsels; ++m) {
+        offsets[m + 1] = offsets[m] + morselSelections[m].size();
+    }
+    SelectionVector selection(offsets[morsels]);
+    pool.parallelFor(morsels, [&](size_t, size_t m) {
+        std::copy(morselSelections[m].begin(), morselSelections[m].end(), selection.begin() + offsets[m]);
+    });
+    return selection;
 }
@@ -1,25 +1,230 @@
 #pragma once
+#include <atomic>
+#include <functional>
 #include <string>
 #include <vector>
 #include "database.h"
+#include "utils.h"
+#include "filter_kernels.h"
+#include "in_list.h"
+#include "index.h"
+#include "parser.h"
 
-struct Condition {
-    std::string column;
-    std::string op;             // e.g. =, >, <, >=, <=, !=, IN, etc.
-    std::string value;          // single value if op != "IN"
-    std::vector<std::string> inValues; // multiple values if op == "IN"
-    bool negate;                // true if there's a preceding NOT
+// A Condition resolved against a concrete table:
+// the column index is looked up once and the literal(s) are converted once to the column's native type.
+struct BoundCondition {
+    std::string column;         // kept for error messages
+    size_t columnIndex = 0;     // position in table.columns / table.data
+    DataType type = DataType::VARCHAR;
+    CompareOp op = CompareOp::EQ;
+    bool isIn = false;          // IN / NOT IN list instead of a single comparison
+    bool negate = false;
+
+    // Single literal (only the member matching `type` is set)
+    int32_t intValue = 0;
+    float floatValue = 0.0f;
+    char charValue = '\0';
+    std::string stringValue;
+
+    // IN list literals (only the vector matching `type` is filled)
+    std::vector<int32_t> intValues;
+    std::vector<float> floatValues;
+    std::vector<char> charValues;
+    std::vector<std::string> stringValues;
+
+    // The same IN list as a set, probed for lists too long for the vectorized kernels
+    IntInSet intSet;
+    FloatInSet floatSet;
+    CharInSet charSet;
+    StringInSet stringSet;
+
+    // VARCHAR column that is dictionary-encoded: codeMatches[c] is 1 when dictionary entry c
+    // passes the comparison / IN list (NOT is applied on top), so rows are tested on their codes
+    bool onCodes = false;
+    std::vector<uint8_t> codeMatches;
+
+    // Prepared statements: number of the '?' that supplies the single literal, -1 for a literal.
+    // The literal fields stay empty until bindParameters fills them.
+    int parameter = -1;
+
+    // Estimates made when binding, used to order the operands of AND / OR:
+    // the fraction of rows expected to pass and the relative cost of testing one row
+    double selectivity = 1.0;
+    double cost = 1.0;
 };
 
-// This function is responsible for parsing a SQL-like WHERE clause into a structured format that can be used for filtering database rows.
-std::vector<std::pair<std::string, Condition>> parseWhereClause(const std::string& wherePart);
+// A node of a compiled WHERE tree. NOT has been pushed down into the conditions (De Morgan),
+// so only AND and OR remain above the leaves.
+struct PredicateNode {
+    enum class Kind { CONDITION, AND, OR };
+    Kind kind = Kind::AND;                  // an AND of nothing is true
+    size_t condition = 0;                   // CONDITION: index into BoundPredicate::conditions
+    std::vector<PredicateNode> operands;    // AND / OR, in evaluation order
+
+    // Estimates of the subtree (see BoundCondition)
+    double selectivity = 1.0;
+    double cost = 0.0;
+};
+
+// The compiled WHERE clause: the bound conditions and the AND / OR tree over them.
+// Operands are ordered so the cheapest, most decisive ones run first: an AND stops at the first
+// false operand and an OR at the first true one, for a single row as well as for a block.
+// Calling it with a row id tells whether that row passes.
+struct BoundPredicate {
+    std::vector<BoundCondition> conditions;
+    PredicateNode root;
+
+    bool empty() const { return conditions.empty(); }
+    bool operator()(const Table& table, size_t rowId) const;
+};
+
+// Evaluates a predicate tree for one row, where leaf(i) is the result of condition i.
+// Short-circuits: operands after the first false (AND) / true (OR) one are not evaluated.
+template <typename Leaf>
+bool evaluatePredicate(const PredicateNode& node, const Leaf& leaf) {
+    switch (node.kind) {
+        case PredicateNode::Kind::CONDITION:
+            return leaf(node.condition);
+        case PredicateNode::Kind::AND:
+            for (const auto& operand : node.operands) {
+                if (!evaluatePredicate(operand, leaf)) return false;
+            }
+            return true;
+        case PredicateNode::Kind::OR:
+            for (const auto& operand : node.operands) {
+                if (evaluatePredicate(operand, leaf)) return true;
+            }
+            return false;
+    }
+    return false;
+}
+
+// Binds a parsed WHERE tree to a table and orders its operands. Throws if a column doesn't exist,
+// if a literal can't be converted to the column type or if the operator is unknown.
+BoundPredicate bindConditions(const Table& table, const WhereClause& where);
+
+// Binds one condition to a table, including its selectivity and cost estimates
+BoundCondition bindCondition(const Table& table, const Condition& cond);
+
+// Builds the tree of a WHERE clause with `bindLeaf` binding each condition (e.g. against one of
+// the tables of a join). Conditions are numbered in the order they are bound. Operands are not reordered.
+BoundPredicate buildPredicate(const WhereClause& where, const std::function<BoundCondition(const Condition&)>& bindLeaf);
+
+// Orders the operands of every AND / OR by the estimates of the conditions: an AND puts first
+// what is cheap and likely false (lowest cost / (1 - selectivity)), an OR what is cheap and
+// likely true (lowest cost / selectivity). Also fills in the estimates of the inner nodes.
+void orderPredicate(BoundPredicate& predicate);
+
+// Adds the subtree `node` of `source` to `predicate` as one more AND operand (with its conditions)
+void addConjunct(BoundPredicate& predicate, const BoundPredicate& source, const PredicateNode& node);
+
+// Makes a bound predicate ready to run again (prepared statements and cached plans):
+// fills every '?' slot from `parameters` (each must match its column's type, see valueMatches)
+// and re-evaluates dictionary codes of VARCHAR conditions whose column's dictionary has grown
+// or been dropped since the predicate was bound.
+void bindParameters(const Table& table, BoundPredicate& predicate, const std::vector<Value>& parameters);
+void bindParameters(const Table& table, BoundCondition& cond, const std::vector<Value>& parameters);
 
 // Checks if a row satisfies a given condition.
-// Uses the column, operator, and value(s) from the condition.
-// Supports various data types and handles NOT logic.
-bool evaluateCondition(const Row& row, const Table& table, const Condition& cond);
-
-// Filters rows in a table based on multiple conditions.
-// Combines results using logical operators (AND, OR).
-// Returns only rows that satisfy all conditions.
-std::vector<Row> filterRows(const Table& table, const std::vector<std::pair<std::string, Condition>>& conditions);
+// Reads the value straight from the table's column array at position rowId,
+// no name lookups or string conversions happen here.
+// Handles NOT logic.
+bool evaluateCondition(const Table& table, size_t rowId, const BoundCondition& cond);
+
+// The condition as text, e.g. "age > 30", "name NOT IN ('a', 'b')", "id = ?1" for a '?' slot
+std::string describeCondition(const BoundCondition& cond);
+
+// The predicate in evaluation order, e.g. "a = 1 AND (b < 2 OR c != 'x')"
+std::string describePredicate(const BoundPredicate& predicate);
+
+// Receives the ids of the matching rows of one block (ascending)
+using SelectionConsumer = std::function<void(const uint32_t* rowIds, size_t count)>;
+
+// What a scan skipped, collected for EXPLAIN ANALYZE (scans add to it from every worker)
+struct ScanStats {
+    std::atomic<size_t> rowsSkippedByZones{0};  // in row groups the zone maps / Bloom filters ruled out
+    std::atomic<size_t> rowsPassedByZones{0};   // in row groups the zone maps proved to match entirely
+    std::atomic<size_t> rowsFiltered{0};        // rows the predicate was evaluated on
+};
+
+// Filters rows in a table with a bound predicate.
+// Runs the predicate over the table in blocks of kFilterBlockSize rows.
+// Row groups whose zone maps (per-group min/max) prove that no row can pass are skipped,
+// and groups where every row must pass are emitted without evaluating anything.
+// The tree is evaluated for the whole block at once into bitmaps (SIMD for INTEGER, FLOAT and CHAR):
+// each AND / OR operand only tests the rows its earlier operands left undecided and is skipped
+// when none are left. The ids of the rows that pass are returned in ascending order.
+// No values are copied; callers read the columns they need through the ids.
+// This overload streams each block's matches to `consume` (in row order, on the calling thread)
+// instead of collecting them.
+void filterRows(const Table& table, const BoundPredicate& predicate, const SelectionConsumer& consume);
+// Same, restricted to rows [begin, end) (e.g. one morsel of a parallel scan), adding to `stats` if given.
+void filterRows(const Table& table, const BoundPredicate& predicate,
+                size_t begin, size_t end, const SelectionConsumer& consume, ScanStats* stats = nullptr);
+// Collecting version: morsels are filtered in parallel on the thread pool and their selections
+// concatenated in order, so the result is the same as a serial scan.
+// Both whole-table versions go through a ScanPlan, so they use an index when one applies.
+SelectionVector filterRows(const Table& table, const BoundPredicate& predicate);
+
+// Receives one block of matching row ids of a parallel scan, together with the pool worker running it
+// and the morsel it belongs to (morsels are numbered in row order, blocks of a morsel come in order).
+using MorselConsumer = std::function<void(size_t worker, size_t morsel, const uint32_t* rowIds, size_t count)>;
+
+// How the rows that pass a WHERE clause are found.
+// When every condition is on a column with a bitmap index, the whole predicate (AND, OR, NOT,
+// NOT IN, ...) is answered with bitmap operations without reading any row. Otherwise the bitmaps of
+// the conditions under the top-level AND that have bitmap indexes are ANDed into a list of candidates.
+// Failing that, when the predicate is a single condition, or one of the conditions under the
+// top-level AND is =, <, >, <=, >= or IN on a B+tree-indexed column, the index is looked up.
+// Candidates are used when they are at most kIndexMaxSelectivity of the table: their row ids are
+// sorted and the whole predicate is re-checked on them only. Otherwise the table is scanned in
+// morsels with the vectorized filter.
+class ScanPlan {
+public:
+    // How the rows are found
+    enum class Access {
+        SCAN,               // vectorized filter over every row group the zone maps don't rule out
+        BTREE,              // B+tree lookup of one condition, re-checked
+        BITMAP,             // bitmap indexes answer the whole predicate
+        BITMAP_CANDIDATES   // ANDed bitmaps of some conditions, re-checked
+    };
+
+    // `predicate` may be null: every row matches
+    ScanPlan(const Table& table, const BoundPredicate* predicate);
+
+    // The index the plan uses, nullptr for a scan
+    const TableIndex* index() const { return usedIndex; }
+    Access access() const { return accessKind; }
+
+    // Scans add what they skip to `stats` from now on (EXPLAIN ANALYZE)
+    void collectStats(ScanStats* scanStats) { stats = scanStats; }
+
+    // Number of rows the plan reads: the table's rows for a scan, the rows found for an index
+    size_t inputSize() const { return usedIndex != nullptr ? indexRows.size() : table.size(); }
+
+    size_t morselCount() const;
+
+    // Streams the matching rows among input rows [begin, end) in row order on the calling thread
+    // (one morsel, or the next chunk of a pipeline scan)
+    void runRange(size_t begin, size_t end, const SelectionConsumer& consume) const;
+
+    // Streams the matching rows on the thread pool
+    void run(const MorselConsumer& consume) const;
+
+    // Streams the matching rows in row order on the calling thread
+    void runSerial(const SelectionConsumer& consume) const;
+
+    // All matching row ids, ascending
+    SelectionVector collect() const;
+
+private:
+    // Tries to answer the predicate with bitmap indexes; true if indexRows holds the result
+    bool planBitmaps();
+
+    const Table& table;
+    const BoundPredicate* predicate;
+    const TableIndex* usedIndex = nullptr;
+    Access accessKind = Access::SCAN;
+    SelectionVector indexRows;      // rows found through the index (already re-checked)
+    ScanStats* stats = nullptr;
+};
@@ -1,150 +1,130 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <algorithm>
+#include <charconv>
+#include <limits>
 
 #include "database.h"
 #include "condition.h"
+#include "sort.h"
+#include "aggregate.h"
+#include "join.h"
+#include "file_io.h"
+#include "thread_pool.h"
 #include "utils.h"
+#include "date.h"
+#include "lexer.h"
+#include "parser.h"
+#include "plan.h"
+#include "pipeline.h"
+#include "explain.h"
 #include "fmt/color.h"
 
-Database::Database() {
-    // Constructor: no special initialization required
+Database::Database() : planCache(std::make_unique<PlanCache>()) {
 }
 
-DataType Database::parseDataType(const std::string& typeStr) {
-    std::string upperTypeStr = toCase(typeStr, CaseType::UPPER);
-    if (upperTypeStr == "INTEGER") return DataType::INTEGER;
-    if (upperTypeStr == "VARCHAR") return DataType::VARCHAR;
-    if (upperTypeStr == "DATE")    return DataType::DATE;
-    if (upperTypeStr == "CHAR")    return DataType::CHAR;
-    if (upperTypeStr == "FLOAT")   return DataType::FLOAT;
-    throw std::runtime_error("Unsupported data type: " + typeStr);
+Database::~Database() = default;
+
+DataType Database::parseDataType(std::string_view typeStr) {
+    static const std::pair<std::string_view, DataType> types[] = {
+        {"INTEGER", DataType::INTEGER}, {"VARCHAR", DataType::VARCHAR}, {"DATE", DataType::DATE},
+        {"CHAR", DataType::CHAR}, {"FLOAT", DataType::FLOAT}};
+    for (const auto& [name, type] : types) {
+        // Case-insensitive, like keywords
+        if (std::equal(name.begin(), name.end(), typeStr.begin(), typeStr.end(),
+                       [](char upper, char c) { return upper == toUpperManual(c); })) {
+            return type;
+        }
+    }
+    throw std::runtime_error("Unsupported data type: " + std::string(typeStr));
 }
 
 void Database::executeCommand(const std::string& command) {
-    std::string trimmedCommand = removeTrailingSemicolon(trim(command));
-
-    // Normalize only the operation (keyword)
-    std::string normalizedCommand = normalizeKeywords(trimmedCommand);
-
-
-    std::stringstream ss(normalizedCommand); // What is stringstream https://stackoverflow.com/questions/20594520/what-exactly-does-stringstream-do
-    std::string normalizedOperation;
-    ss >> normalizedOperation; // The first keyword (SELECT, CREATE, etc.)
+    // Scratch memory lives until the command returns (or throws); its totals are kept for SHOW MEMORY
+    ScratchScope scratchScope{*this};
+
+    // The command is lexed once; the tokens serve both the plan cache key and the parser
+    std::vector<Token> tokens = tokenize(command);
+
+    // A SELECT that ran before (the same tokens) reuses its bound plan: no parsing, no name lookups
+    std::string cacheKey;
+    if (tokens[0].isKeyword("SELECT")) {
+        cacheKey = normalizeQuery(command, tokens);
+        std::shared_ptr<SelectPlan> plan =
+            planCache->find(cacheKey, [this](const SelectPlan& cached) { return planIsCurrent(cached); });
+        if (plan) {
+            runSelect(*plan, {});
+            return;
+        }
+    }
 
-    // Get the rest of the command
-    std::string restOfCommand;
-    std::getline(ss, restOfCommand);
-    restOfCommand = trim(restOfCommand); // Preserve original case for the rest
+    // Parsed into a syntax tree; the handlers only see its fields
+    Statement statement = parseStatement(command, tokens, scratch);
 
-    if (normalizedOperation == "SELECT") {
-        selectFrom(restOfCommand);
-    } else if (normalizedOperation == "CREATE") {
-        createTable(restOfCommand);
-    } else if (normalizedOperation == "DROP") {
-        dropTable(restOfCommand);
-    } else if (normalizedOperation == "INSERT") {
-        insertInto(restOfCommand);
-    } else if (normalizedOperation == "SAVE") {
-        saveToFile(restOfCommand);
-    } else if (normalizedOperation == "LOAD") {
-        loadFromFile(restOfCommand);
-    } else if (normalizedOperation == "LIST" && restOfCommand == "TABLES") {
-        listTables();
-    }
-    // https://cplusplus.com/reference/string/string/rfind/
-    else if (normalizedOperation == "DELETE" && restOfCommand.rfind("FILE", 0) == 0) {
-        deleteFile(restOfCommand.substr(5)); // Pass the file name part
-    }
-    else {
-        throw std::runtime_error("Unknown command: " + normalizedOperation);
+    switch (statement.kind) {
+        case StatementKind::SELECT: {
+            std::shared_ptr<SelectPlan> plan = bindSelect(statement.select);
+            if (!hasKeywordNames(statement.select)) {
+                planCache->insert(cacheKey, plan);
+            }
+            runSelect(*plan, {});
+            break;
+        }
+        case StatementKind::INSERT:       insertInto(statement.insert); break;
+        case StatementKind::CREATE_TABLE: createTable(statement.createTable); break;
+        case StatementKind::CREATE_INDEX: createIndex(statement.createIndex); break;
+        case StatementKind::DROP_TABLE:   dropTable(statement.name); break;
+        case StatementKind::DROP_INDEX:   dropIndex(statement.name); break;
+        case StatementKind::SAVE:         saveToFile(std::string(statement.name), std::string(statement.alias)); break;
+        case StatementKind::LOAD:         loadFromFile(std::string(statement.name), std::string(statement.alias)); break;
+        case StatementKind::DELETE_FILE:  deleteFile(std::string(statement.name)); break;
+        case StatementKind::SET_THREADS:  setThreads(statement.name); break;
+        case StatementKind::SHOW_STORAGE: showStorage(statement.name); break;
+        case StatementKind::SHOW_MEMORY:  showMemory(); break;
+        case StatementKind::LIST_TABLES:  listTables(); break;
+        case StatementKind::SHOW_PLANS:   showPlans(); break;
+        case StatementKind::PREPARE:      preparePlan(statement.name, statement.select); break;
+        case StatementKind::EXECUTE:      executePrepared(statement.name, statement.arguments); break;
+        case StatementKind::DEALLOCATE:   deallocate(statement.name); break;
+        case StatementKind::EXPLAIN:      explain(statement.select, statement.analyze); break;
     }
 }
 
 // ---------------------------------------------------------------------------------------
-void Database::createTable(const std::string& command) {
-    // Expected format: CREATE TABLE table_name (colName colType, colName colType, ...);
-    std::stringstream ss(command);
-    std::string keyword;
-    ss >> keyword;  // Should be "TABLE"
-
-    if (toCase(keyword, CaseType::UPPER)  != "TABLE") {
-        throw std::runtime_error("Syntax error in CREATE TABLE command.");
-    }
-
-    // Read the table name
-    std::string tableName;
-    ss >> tableName;
+void Database::createTable(const CreateTableStatement& create) {
+    // CREATE TABLE table_name (colName colType, colName colType, ...)
+    std::string tableName(create.table);
 
     // Check if table already exists
     if (tables.find(tableName) != tables.end()) {
         throw std::runtime_error("Table '" + tableName + "' already exists.");
     }
 
-    // Read the column definitions between parentheses (...)
-    std::string columnsDef;
-    std::getline(ss, columnsDef);
-    columnsDef = removeTrailingSemicolon(trim(columnsDef));
-
-    // Basic syntax check for parentheses
-    if (columnsDef.size() < 2 || columnsDef.front() != '(' || columnsDef.back() != ')') {
-        throw std::runtime_error("Syntax error in CREATE TABLE command.");
-    }
-
-    // Remove outer parentheses
-    columnsDef = columnsDef.substr(1, columnsDef.size() - 2);
-
-    // Split by commas to get each "name type" pair
-    std::vector<std::string> columnDefs = split(columnsDef, ',');
-
     // Construct the table
     Table table;
     table.name = tableName;
 
-    // Parse each column definition
-    for (auto& colDef : columnDefs) {
-        colDef = trim(colDef);
-        std::stringstream colStream(colDef);
-
-        std::string colName;
-        std::string colTypeStr;
-        colStream >> colName >> colTypeStr;
-
-        if (colName.empty() || colTypeStr.empty()) {
-            throw std::runtime_error("Syntax error in column definition: '" + colDef + "'.");
+    // Add each column (and its storage) to the table
+    for (const auto& definition : create.columns) {
+        if (table.findColumn(definition.name) >= 0) {
+            throw std::runtime_error("Column '" + std::string(definition.name) + "' is defined twice.");
         }
-
-        // Convert string type to enum
-        DataType colType = parseDataType(colTypeStr);
-
-        // Add column to table
-        Column column = { colName, colType };
-        table.columns.push_back(column);
+        Column column = { std::string(definition.name), parseDataType(definition.type) };
+        table.addColumn(column);
     }
 
     // Store the new table in the database
-    tables[tableName] = table;
+    table.generation = nextGeneration++;
+    tables[tableName] = std::move(table);
     fmt::print("Table '{}' created successfully.\n", tableName);
 }
 
-void Database::dropTable(const std::string& command) {
-    // Expected format: DROP TABLE table_name;
-    std::stringstream ss(removeTrailingSemicolon(trim(command)));
-    std::string keyword;
-    ss >> keyword;  // Should be "TABLE"
-
-    if (toCase(keyword, CaseType::UPPER) != "TABLE") {
-        throw std::runtime_error("Syntax error in DROP TABLE command.");
-    }
-
-    // Read the table name
-    std::string tableName;
-    ss >> tableName;
-
-    // Check existence
+void Database::dropTable(std::string_view tableName) {
+    // DROP TABLE table_name
     auto it = tables.find(tableName);
     if (it == tables.end()) {
-        throw std::runtime_error("Table '" + tableName + "' does not exist.");
+        throw std::runtime_error("Table '" + std::string(tableName) + "' does not exist.");
     }
 
     // Erase from the map
@@ -152,379 +132,622 @@ void Database::dropTable(const std::string& command) {
     fmt::print("Table '{}' dropped successfully.\n", tableName);
 }
 
-void Database::insertInto(const std::string& command) {
-    // Expected format: INSERT INTO table_name VALUES (...);
-    std::stringstream ss(command);
-    std::string keyword;
-    ss >> keyword; // Should be "INTO"
-
-    if (toCase(keyword, CaseType::UPPER) != "INTO") {
-        throw std::runtime_error("Syntax error in INSERT INTO command.");
+Table* Database::findTableWithIndex(std::string_view indexName) {
+    for (auto& [tableName, table] : tables) {
+        for (const auto& index : table.indexes) {
+            if (index->name() == indexName) {
+                return &table;
+            }
+        }
     }
+    return nullptr;
+}
 
-    // Read the table name
-    std::string tableName;
-    ss >> tableName;
+void Database::createIndex(const CreateIndexStatement& create) {
+    // CREATE [BITMAP | BLOOM] INDEX index_name ON table_name(column_name)
+    IndexKind kind = IndexKind::BTREE;
+    if (create.kind == "BITMAP") {
+        kind = IndexKind::BITMAP;
+    } else if (create.kind == "BLOOM") {
+        kind = IndexKind::BLOOM;
+    }
+    std::string indexName(create.name);
+    std::string tableName(create.table);
+    std::string columnName(create.column);
 
-    // Check existence
+    if (findTableWithIndex(indexName) != nullptr) {
+        throw std::runtime_error("Index '" + indexName + "' already exists.");
+    }
     auto it = tables.find(tableName);
     if (it == tables.end()) {
         throw std::runtime_error("Table '" + tableName + "' does not exist.");
     }
     Table& table = it->second;
-
-    // Read the next keyword, should be "VALUES"
-    ss >> keyword;
-    if (toCase(keyword, CaseType::UPPER) != "VALUES") {
-        throw std::runtime_error("Syntax error in INSERT INTO command. Missing 'VALUES'.");
+    int colIndex = table.findColumn(columnName);
+    if (colIndex < 0) {
+        throw std::runtime_error("Column '" + columnName + "' not found in table '" + tableName + "'.");
+    }
+    if (const TableIndex* existing = table.findIndex(colIndex, kind)) {
+        throw std::runtime_error("Column '" + columnName + "' already has a " + indexKindName(kind) +
+                                 " index ('" + existing->name() + "').");
+    }
+
+    DataType columnType = table.columns[colIndex].type;
+    if (kind == IndexKind::BITMAP && !TableIndex::supportsBitmap(columnType)) {
+        throw std::runtime_error("Bitmap indexes are only supported on CHAR and VARCHAR columns.");
+    }
+    if (kind == IndexKind::BLOOM && !TableIndex::supportsBloom(columnType)) {
+        throw std::runtime_error("Bloom indexes are only supported on VARCHAR and DATE columns.");
+    }
+
+    // Build from the rows already in the table; appendRow maintains it from now on
+    auto index = std::make_shared<TableIndex>(indexName, columnName, colIndex, columnType, kind);
+    index->build(table.data[colIndex]);
+    table.indexes.push_back(std::move(index));
+    switch (kind) {
+        case IndexKind::BTREE:
+            fmt::print("Index '{}' created on {}({}).\n", indexName, tableName, columnName);
+            break;
+        case IndexKind::BITMAP:
+            fmt::print("Bitmap index '{}' created on {}({}).\n", indexName, tableName, columnName);
+            break;
+        case IndexKind::BLOOM:
+            fmt::print("Bloom index '{}' created on {}({}), using {}.\n", indexName, tableName, columnName,
+                       formatBytes(table.indexes.back()->memoryUsage()));
+            break;
     }
+}
+
+void Database::dropIndex(std::string_view indexName) {
+    // DROP INDEX index_name
+    Table* table = findTableWithIndex(indexName);
+    if (table == nullptr) {
+        throw std::runtime_error("Index '" + std::string(indexName) + "' does not exist.");
+    }
+    auto& indexes = table->indexes;
+    indexes.erase(std::remove_if(indexes.begin(), indexes.end(),
+                                 [&](const auto& index) { return index->name() == indexName; }),
+                  indexes.end());
+    fmt::print("Index '{}' dropped successfully.\n", indexName);
+}
 
-    // Parse values in parentheses
-    std::string valuesDef;
-    std::getline(ss, valuesDef);
-    valuesDef = removeTrailingSemicolon(trim(valuesDef));
+// Converts a literal to a value of the given column type (INSERT values, EXECUTE arguments).
+// `target` says what the value is for in error messages, e.g. "column 'age'".
+static Value literalValue(const Literal& literal, DataType type, const std::string& target) {
+    bool quoted = literal.kind == Literal::Kind::STRING;
 
-    if (valuesDef.size() < 2 || valuesDef.front() != '(' || valuesDef.back() != ')') {
-        throw std::runtime_error("Syntax error in INSERT INTO command.");
+    // Numbers come converted by the parser
+    switch (type) {
+        case DataType::INTEGER:
+            if (literal.kind != Literal::Kind::NUMBER) {
+                throw std::runtime_error("Invalid INTEGER value '" + std::string(literal.text) + "' for " + target + ".");
+            }
+            if (literal.intValue < std::numeric_limits<int32_t>::min() ||
+                literal.intValue > std::numeric_limits<int32_t>::max()) {
+                throw std::runtime_error("INTEGER value " + std::string(literal.text) + " is out of range for " +
+                                         target + ".");
+            }
+            return Value(static_cast<int32_t>(literal.intValue));
+        case DataType::FLOAT:
+            if (literal.kind != Literal::Kind::NUMBER) {
+                throw std::runtime_error("Invalid FLOAT value '" + std::string(literal.text) + "' for " + target + ".");
+            }
+            return Value(literal.floatValue);
+        case DataType::CHAR:
+            // Expecting a single quoted character, e.g. 'a'
+            if (!quoted || literal.text.size() != 1) {
+                throw std::runtime_error("Invalid CHAR format (expected single quoted character).");
+            }
+            return Value(literal.text[0]);
+        case DataType::VARCHAR:
+            // Expecting a quoted string, e.g. 'Hello' (commas, spaces and keywords inside are fine)
+            if (!quoted) {
+                throw std::runtime_error("Invalid string or date format (must be in quotes).");
+            }
+            return Value::string(literal.text);
+        case DataType::DATE:
+            // Expecting a quoted ISO date, e.g. '2024-01-31'; stored as days since the epoch
+            if (!quoted) {
+                throw std::runtime_error("Invalid string or date format (must be in quotes).");
+            }
+            return Value::date(parseDateOrThrow(literal.text));
     }
+    throw std::runtime_error("Unknown data type encountered.");
+}
 
-    // Strip the outer parentheses
-    valuesDef = valuesDef.substr(1, valuesDef.size() - 2);
+void Database::insertInto(const InsertStatement& insert) {
+    // INSERT INTO table_name VALUES (...)
+    auto it = tables.find(insert.table);
+    if (it == tables.end()) {
+        throw std::runtime_error("Table '" + std::string(insert.table) + "' does not exist.");
+    }
+    Table& table = it->second;
 
-    // Split by commas
-    std::vector<std::string> values = split(valuesDef, ',');
+    const std::vector<Literal>& values = insert.values;
     if (values.size() != table.columns.size()) {
         throw std::runtime_error("Column count doesn't match value count.");
     }
 
-    // Create a new row
+    // Convert the literals into a row. Values are 16 bytes and never allocate: a long VARCHAR
+    // points into the command text, which stays alive until the row has been copied into the table.
     Row row;
+    row.values.reserve(values.size());
     for (size_t i = 0; i < values.size(); ++i) {
-        std::string val = trim(values[i]);
-
-        // Convert string to the column’s data type
-        switch (table.columns[i].type) {
-            case DataType::INTEGER: {
-                row.values.push_back(std::stoi(val)); // stoi - string to integer
-                break;
-            }
-            case DataType::FLOAT: {
-                row.values.push_back(std::stof(val)); // stof - string to float
-                break;
-            }
-            case DataType::CHAR: {
-                // Expecting a single quoted character, e.g. 'a'
-                if (val.size() != 3 || val.front() != '\'' || val.back() != '\'') {
-                    throw std::runtime_error("Invalid CHAR format (expected single quoted character).");
-                }
-                row.values.push_back(val[1]);
-                break;
-            }
-            case DataType::VARCHAR:
-            case DataType::DATE: {
-                // Expecting a single quoted string, e.g. 'Hello'
-                if (val.front() == '\'' && val.back() == '\'') {
-                    row.values.push_back(val.substr(1, val.size() - 2));
-                } else {
-                    throw std::runtime_error("Invalid string or date format (must be in quotes).");
-                }
-                break;
-            }
-            default:
-                throw std::runtime_error("Unknown data type encountered.");
-        }
+        row.values.push_back(literalValue(values[i], table.columns[i].type, "column '" + table.columns[i].name + "'"));
     }
 
-    // Add the row to the table
-    table.rows.push_back(row);
-    fmt::print("Row inserted into '{}' successfully.\n", tableName);
+    // Append the values to the table's column arrays
+    table.appendRow(row.values);
+    fmt::print("Row inserted into '{}' successfully.\n", table.name);
 }
 
 // ---------------------------------------------------------------------------------------
-void Database::selectFrom(const std::string& command) {
-    // Expected format (basic version):
-    //   SELECT col1, col2 FROM tableName
+// Binds a SELECT to the tables it reads. Everything that doesn't depend on the values of '?'
+// parameters or on the rows is resolved here, once per plan.
+std::shared_ptr<SelectPlan> Database::bindSelect(const SelectStatement& select) {
+    // SELECT col1, col2 FROM tableName [JOIN otherTable ON tableName.col = otherTable.col]
     //   [WHERE conditions]
+    //   [GROUP BY col1, col2]
     //   [ORDER BY colName [ASC|DESC]]
-    //   [LIMIT number];
-
-    std::string cleanedCommand = removeTrailingSemicolon(trim(command));
-
-    // Let's find positions of FROM, WHERE, ORDER BY, and LIMIT
-    std::size_t fromPos   = cleanedCommand.find(" FROM ");
-    std::size_t wherePos  = cleanedCommand.find(" WHERE ");
-    std::size_t orderPos  = cleanedCommand.find(" ORDER BY ");
-    std::size_t limitPos  = cleanedCommand.find(" LIMIT ");
-
-    if (fromPos == std::string::npos) {
-        throw std::runtime_error("Syntax error in SELECT command (missing 'FROM').");
-    }
-
-    // 1) Extract the SELECT columns part
-    //    substring from [0..fromPos)
-    std::string columnsPart = trim(cleanedCommand.substr(0, fromPos));
-
-    // 2) Identify the portion that starts after FROM
-    //    If there's a WHERE, ORDER BY, or LIMIT, we only take up to the first one we find
-    //    We'll do this by identifying the earliest of wherePos, orderPos, limitPos after fromPos
-    std::size_t tablePartEnd = cleanedCommand.size(); // default end
-
-    // find earliest of wherePos, orderPos, limitPos that is > fromPos
-    std::vector<std::size_t> markers;
-    if (wherePos  != std::string::npos && wherePos  > fromPos) markers.push_back(wherePos);
-    if (orderPos  != std::string::npos && orderPos  > fromPos) markers.push_back(orderPos);
-    if (limitPos  != std::string::npos && limitPos  > fromPos) markers.push_back(limitPos);
-
-    // if we found any markers, pick the smallest
-    if (!markers.empty()) {
-        // so the std::min_element returns iterator and if we want to actually get the real values we can just use *
-        tablePartEnd = *std::min_element(markers.begin(), markers.end());
-    }
-
-    // The table name portion: fromPos + 6 (skip " FROM ") up to tablePartEnd
-    std::string tablePart = trim(
-        cleanedCommand.substr(fromPos + 6, tablePartEnd - (fromPos + 6))
-    );
-
-    // 3) Extract the WHERE part (if any)
-    std::string wherePart;
-    if (wherePos != std::string::npos) {
-        // from wherePos+7 (" WHERE ") until either ORDER BY or LIMIT or end
-        std::size_t whereEnd = cleanedCommand.size();
-        // find if there's an ORDER BY or LIMIT after the WHERE
-        std::vector<std::size_t> afterWhereMarkers;
-        if (orderPos != std::string::npos && orderPos > wherePos) afterWhereMarkers.push_back(orderPos);
-        if (limitPos != std::string::npos && limitPos > wherePos) afterWhereMarkers.push_back(limitPos);
-        if (!afterWhereMarkers.empty()) {
-            whereEnd = *std::min_element(afterWhereMarkers.begin(), afterWhereMarkers.end());
+    //   [LIMIT number]
+    // The plan keeps its own copy of the query's names and literals: it outlives the command
+    auto plan = std::make_shared<SelectPlan>();
+    plan->select = copySelect(select, plan->text);
+    plan->parameterTypes.resize(select.parameterCount);
+    auto addParameter = [&plan](const BoundCondition& cond) {
+        if (cond.parameter >= 0) {
+            plan->parameterTypes[cond.parameter] = cond.type;
         }
-        wherePart = trim(cleanedCommand.substr(wherePos + 7, whereEnd - (wherePos + 7)));
-    }
-
-    // 4) Extract the ORDER BY part (if any)
-    // 1) Extract substring after "ORDER BY " until "LIMIT" or the end
-    std::vector<std::pair<std::string, bool>> orderByColumns;
-    std::string orderByPart;
-    if (orderPos != std::string::npos) {
-        std::size_t orderEnd = (limitPos == std::string::npos)
-                               ? cleanedCommand.size()
-                               : limitPos;
-        orderByPart = trim(cleanedCommand.substr(orderPos + 9, orderEnd - (orderPos + 9)));
-
-        // 2) Split the part by commas first -> multiple columns
-        std::vector<std::string> columns = split(orderByPart, ',');
-        for (auto& col : columns) {
-            // e.g. "age" or "name DESC"
-            col = trim(col);
-
-            // 3) Split each column by spaces to find optional ASC/DESC
-            std::vector<std::string> orderTokens = split(col, ' ');
-            if (!orderTokens.empty()) {
-                std::string columnName = trim(orderTokens[0]);
-                bool isDesc = false;
-
-                // If second token exists, check if it's DESC
-                if (orderTokens.size() > 1) {
-                    std::string direction = toCase(trim(orderTokens[1]), CaseType::UPPER);
-                    if (direction == "DESC") {
-                        isDesc = true;
-                    }
-                }
-
-                // 4) Push result into `orderByColumns`
-                orderByColumns.emplace_back(columnName, isDesc);
-            }
+    };
+
+    // 1) FROM a JOIN b ON a.x = b.y takes the hash join path
+    bool hasAggregates = std::any_of(select.items.begin(), select.items.end(),
+                                     [](const SelectItem& item) { return item.isCall(); });
+    if (select.hasJoin) {
+        if (!select.groupBy.empty() || hasAggregates) {
+            throw std::runtime_error("Aggregates and GROUP BY are not supported on a JOIN.");
         }
-    }
-
-    // 5) Extract the LIMIT part (if any)
-    int limitValue = -1; // -1 means no limit
-    if (limitPos != std::string::npos) {
-        // substring from limitPos+6 (" LIMIT ") to end
-        std::string limitStr = trim(cleanedCommand.substr(limitPos + 7));
-        if (!limitStr.empty()) {
-            limitValue = std::stoi(limitStr);
-            if (limitValue < 0) {
-                throw std::runtime_error("LIMIT value cannot be negative.");
-            }
-        }
-    }
-
-    // 6) Check table existence
-    auto it = tables.find(tablePart);
+        plan->kind = SelectPlan::Kind::JOIN;
+        plan->join = bindJoinQuery(tables, select.join, select.items, select.where);
+        plan->tables = {{plan->join.left->name, plan->join.left->generation},
+                        {plan->join.right->name, plan->join.right->generation}};
+        for (const auto& cond : plan->join.leftFilter.conditions) addParameter(cond);
+        for (const auto& cond : plan->join.rightFilter.conditions) addParameter(cond);
+        for (const auto& cond : plan->join.residual.conditions) addParameter(cond);
+        return plan;
+    }
+
+    // 2) Check table existence
+    auto it = tables.find(select.table);
     if (it == tables.end()) {
-        throw std::runtime_error("Table '" + tablePart + "' does not exist.");
+        throw std::runtime_error("Table '" + std::string(select.table) + "' does not exist.");
     }
-    Table& table = it->second; // reference to the table
-
-    // 7) Determine which columns to select
-    std::vector<int> colIndices;
-    bool selectAll = (columnsPart == "*");
+    const Table& table = it->second;
+    plan->table = &table;
+    plan->tables = {{table.name, table.generation}};
 
-    if (selectAll) {
-        // Wildcard: select all columns
-        for (size_t i = 0; i < table.columns.size(); ++i) {
-            // https://www.geeksforgeeks.org/static_cast-in-cpp/
-            colIndices.push_back(static_cast<int>(i));
-        }
+    if (hasAggregates || !select.groupBy.empty()) {
+        // 3) Aggregates / GROUP BY take their own path
+        plan->kind = SelectPlan::Kind::AGGREGATE;
+        plan->aggregate = bindAggregateQuery(table, select.items, select.groupBy);
     } else {
-        // Split column list by comma
-        std::vector<std::string> selectedCols = split(columnsPart, ',');
-        for (auto& col : selectedCols) {
-            col = trim(col);
-            bool found = false;
-            for (size_t i = 0; i < table.columns.size(); ++i) {
-                if (table.columns[i].name == col) {
+        // 4) Determine which columns to select ("*" stands for all of them)
+        for (const auto& item : select.items) {
+            if (item.column == "*") {
+                for (size_t i = 0; i < table.columns.size(); ++i) {
                     // https://www.geeksforgeeks.org/static_cast-in-cpp/
-                    colIndices.push_back(static_cast<int>(i));
-                    found = true;
-                    break;
+                    plan->columns.push_back(static_cast<int>(i));
                 }
+                continue;
             }
-            if (!found) {
-                throw std::runtime_error("Column '" + col + "' not found in table '" + tablePart + "'.");
+            int colIndex = table.findColumn(item.column);
+            if (colIndex < 0) {
+                throw std::runtime_error("Column '" + std::string(item.column) + "' not found in table '" +
+                                         table.name + "'.");
             }
+            plan->columns.push_back(colIndex);
         }
     }
 
-    // 8) Apply WHERE (filter rows)
-    std::vector<Row> filteredRows = table.rows;
-    if (!wherePart.empty()) {
-        auto conditions = parseWhereClause(wherePart);
-        filteredRows = filterRows(table, conditions);
+    // 5) WHERE: resolve columns, operators and literals once, not once per row
+    plan->hasWhere = !select.where.empty();
+    if (plan->hasWhere) {
+        plan->predicate = bindConditions(table, select.where);
+        for (const auto& cond : plan->predicate.conditions) addParameter(cond);
     }
 
-    // 9) Apply ORDER BY if specified
-    if (!orderByColumns.empty()) {
-        std::sort(filteredRows.begin(), filteredRows.end(),
-            [&table, &orderByColumns](const Row& a, const Row& b) {
-                // Compare row A and row B column by column
-                for (const auto& [colName, isDesc] : orderByColumns) {
-                    // Take the column iterator with the same name as in orderByColumns
-                    auto colIt = std::find_if(
-                        table.columns.begin(),
-                        table.columns.end(),
-                        [&](const Column& c){ return c.name == colName; }
-                    );
-
-                    if (colIt == table.columns.end()) {
-                        throw std::runtime_error("Column '" + colName + "' not found in table.");
-                    }
-
-                    // Convert iterator to an index (colIndex).
-                    size_t colIndex = std::distance(table.columns.begin(), colIt);
-                    const Value& valA = a.values[colIndex];
-                    const Value& valB = b.values[colIndex];
-
-                    // If valA != valB, decide ordering. If they are equal, check next column.
-                    if (valA != valB) {
-                        // int
-                        if (std::holds_alternative<int>(valA)) {
-                            int va = std::get<int>(valA);
-                            int vb = std::get<int>(valB);
-                            return isDesc ? (va > vb) : (va < vb);
-                        }
-                        // std::string
-                        else if (std::holds_alternative<std::string>(valA)) {
-                            const std::string& sa = std::get<std::string>(valA);
-                            const std::string& sb = std::get<std::string>(valB);
-                            return isDesc ? (sa > sb) : (sa < sb);
-                        }
-                        // float
-                        else if (std::holds_alternative<float>(valA)) {
-                            float fa = std::get<float>(valA);
-                            float fb = std::get<float>(valB);
-                            return isDesc ? (fa > fb) : (fa < fb);
-                        }
-                        // char
-                        else if (std::holds_alternative<char>(valA)) {
-                            char ca = std::get<char>(valA);
-                            char cb = std::get<char>(valB);
-                            return isDesc ? (ca > cb) : (ca < cb);
-                        }
-                        else {
-                            throw std::runtime_error("Unhandled data type in sorting logic.");
-                        }
-                    }
-                }
+    if (plan->kind == SelectPlan::Kind::SCAN && !select.orderBy.empty()) {
+        plan->sortKeys = bindSortKeys(table, select.orderBy);
+    }
+    return plan;
+}
+
+bool Database::planIsCurrent(const SelectPlan& plan) const {
+    for (const auto& [name, generation] : plan.tables) {
+        auto it = tables.find(name);
+        if (it == tables.end() || it->second.generation != generation) {
+            return false;
+        }
+    }
+    return true;
+}
 
-                // If all compared columns are equal, retain original orderю
-                return false;
+void Database::runSelect(SelectPlan& plan, const std::vector<Value>& parameters) {
+    // Fill in the '?' slots (and refresh dictionary codes the rows inserted since may have outdated)
+    switch (plan.kind) {
+        case SelectPlan::Kind::SCAN:
+        case SelectPlan::Kind::AGGREGATE:
+            bindParameters(*plan.table, plan.predicate, parameters);
+            break;
+        case SelectPlan::Kind::JOIN:
+            bindParameters(*plan.join.left, plan.join.leftFilter, parameters);
+            bindParameters(*plan.join.right, plan.join.rightFilter, parameters);
+            for (size_t c = 0; c < plan.join.residual.conditions.size(); ++c) {
+                bindParameters(plan.join.residualSides[c] == JoinSide::LEFT ? *plan.join.left : *plan.join.right,
+                               plan.join.residual.conditions[c], parameters);
             }
-        );
+            break;
     }
 
-    // 10) Apply LIMIT if specified
-    if (limitValue >= 0 && static_cast<size_t>(limitValue) < filteredRows.size()) {
-        filteredRows.resize(limitValue); // https://www.geeksforgeeks.org/vector-resize-c-stl/
+    switch (plan.kind) {
+        case SelectPlan::Kind::SCAN:      selectRows(plan); break;
+        case SelectPlan::Kind::AGGREGATE: selectAggregate(plan); break;
+        case SelectPlan::Kind::JOIN:      selectJoin(plan); break;
     }
+}
 
-    // 12) Format and print the results
+void Database::selectRows(const SelectPlan& plan) {
+    // From here on the query works on row ids into the table; values are only read
+    // for the rows and columns that are actually printed.
 
-    // Create a vector of size of number of columns with 0 to save all
-    // max width for each column for the proper print
-    std::vector<size_t> colWidths(colIndices.size(), 0);
+    // 6) The pipeline, pulled from the sink: scan (with WHERE) -> ORDER BY -> LIMIT -> projection.
+    // Without ORDER BY, LIMIT stops pulling as soon as it has its rows, so the scan starts with
+    // a single row group and only reads on while rows are still missing.
+    SelectPipeline pipeline = buildPipeline(plan);
 
-    // Compute max width for each column
-    for (size_t i = 0; i < colIndices.size(); ++i) {
-        colWidths[i] = table.columns[colIndices[i]].name.size();
-        for (const auto& row : filteredRows) {
-            const auto& value = row.values[colIndices[i]];
-            size_t valueLength = 0;
-            if (std::holds_alternative<int>(value)) {
-                valueLength = std::to_string(std::get<int>(value)).size();
-            } else if (std::holds_alternative<float>(value)) {
-                valueLength = fmt::format("{:.2f}", std::get<float>(value)).size();
-            } else if (std::holds_alternative<std::string>(value)) {
-                valueLength = std::get<std::string>(value).size();
-            } else {
-                // char
-                valueLength = 1;
-            }
-            if (valueLength > colWidths[i]) {
-                colWidths[i] = valueLength;
-            }
-        }
+    // 7) Format and print the results batch by batch; long results are streamed
+    ProjectOperator& project = *pipeline.project;
+    GridSink sink(project.headers(), [&project] { return project.widthBounds(); });
+    runPipeline(project, sink);
+}
+
+// Formats one value the same way SELECT prints it. The text lives in `arena`
+// (the command's scratch arena), so result grids don't allocate a string per cell.
+static std::string_view formatCell(Arena& arena, const Value& value) {
+    if (value.type() == ValueType::STRING) {
+        return arena.copyString(value.asString());
+    }
+    fmt::memory_buffer buffer;
+    switch (value.type()) {
+        case ValueType::INT:    fmt::format_to(std::back_inserter(buffer), "{}", value.asInt()); break;
+        case ValueType::BIGINT: fmt::format_to(std::back_inserter(buffer), "{}", value.asBigInt()); break;
+        case ValueType::FLOAT:  fmt::format_to(std::back_inserter(buffer), "{:.2f}", value.asFloat()); break;
+        case ValueType::DOUBLE: fmt::format_to(std::back_inserter(buffer), "{:.2f}", value.asDouble()); break;
+        default:                return arena.copyString(formatValue(value));
+    }
+    return arena.copyString(std::string_view(buffer.data(), buffer.size()));
+}
+
+// Prints a result grid in the same layout as SELECT. `cells` holds the rows one after another,
+// headers.size() cells per row.
+static void printResultGrid(const std::vector<std::string>& headers, const std::vector<std::string_view>& cells) {
+    size_t columnCount = headers.size();
+    std::vector<size_t> colWidths(columnCount, 0);
+    for (size_t i = 0; i < columnCount; ++i) {
+        colWidths[i] = headers[i].size();
+    }
+    for (size_t c = 0; c < cells.size(); ++c) {
+        colWidths[c % columnCount] = std::max(colWidths[c % columnCount], cells[c].size());
     }
 
-    // Print header
     fmt::print("|");
-    for (size_t i = 0; i < colIndices.size(); ++i) {
-        // OpenAI model code (haven't found this thing in documentation, but it works :) )
-        fmt::print(" {:<{}} |", table.columns[colIndices[i]].name, colWidths[i]);
+    for (size_t i = 0; i < headers.size(); ++i) {
+        fmt::print(" {:<{}} |", headers[i], colWidths[i]);
     }
     fmt::print("\n");
 
-    // Print separator
     fmt::print("|");
-    for (size_t i = 0; i < colIndices.size(); ++i) {
-        // OpenAI model code (haven't found this thing in documentation, but it works :) )
+    for (size_t i = 0; i < headers.size(); ++i) {
         fmt::print(" {:-<{}} |", "", colWidths[i]);
     }
     fmt::print("\n");
 
-    // Print rows
-    for (const auto& row : filteredRows) {
+    for (size_t row = 0; row < cells.size(); row += columnCount) {
         fmt::print("|");
-        for (size_t i = 0; i < colIndices.size(); ++i) {
-            const auto& value = row.values[colIndices[i]];
-            if (std::holds_alternative<int>(value)) {
-                // OpenAI model code (haven't found this thing in documentation, but it works :) )
-                fmt::print(" {:<{}} |", std::get<int>(value), colWidths[i]);
-            } else if (std::holds_alternative<float>(value)) {
-                // OpenAI model code (haven't found this thing in documentation, but it works :) )
-                fmt::print(" {:<{}} |", fmt::format("{:.2f}", std::get<float>(value)), colWidths[i]);
-            } else if (std::holds_alternative<std::string>(value)) {
-                // OpenAI model code (haven't found this thing in documentation, but it works :) )
-                fmt::print(" {:<{}} |", std::get<std::string>(value), colWidths[i]);
+        for (size_t i = 0; i < columnCount; ++i) {
+            fmt::print(" {:<{}} |", cells[row + i], colWidths[i]);
+        }
+        fmt::print("\n");
+    }
+}
+
+void Database::selectAggregate(const SelectPlan& plan) {
+    const auto& orderByColumns = plan.select.orderBy;
+    int limitValue = plan.select.limit;
+
+    // WHERE is applied while aggregating; matching rows are never copied out
+    AggregateResult result = runAggregate(*plan.table, plan.aggregate, plan.hasWhere ? &plan.predicate : nullptr);
+
+    // ORDER BY / LIMIT apply to the groups
+    if (!orderByColumns.empty()) {
+        sortAggregateResult(result, orderByColumns);
+    }
+    if (limitValue >= 0 && static_cast<size_t>(limitValue) < result.rows.size()) {
+        result.rows.resize(limitValue);
+    }
+
+    std::vector<std::string_view> cells;
+    cells.reserve(result.rows.size() * result.columnNames.size());
+    for (const auto& row : result.rows) {
+        for (const auto& value : row) {
+            cells.push_back(formatCell(scratch, value));
+        }
+    }
+    printResultGrid(result.columnNames, cells);
+}
+
+void Database::selectJoin(const SelectPlan& plan) {
+    const JoinQuery& query = plan.join;
+    const auto& orderByColumns = plan.select.orderBy;
+    int limitValue = plan.select.limit;
+
+    // Without ORDER BY the join itself can stop after LIMIT pairs
+    JoinRows rows = runHashJoin(query, orderByColumns.empty() ? limitValue : -1);
+    if (!orderByColumns.empty()) {
+        sortJoinRows(query, rows, orderByColumns);
+    }
+    if (limitValue >= 0 && static_cast<size_t>(limitValue) < rows.size()) {
+        rows.resize(limitValue);
+    }
+
+    // Only the projected columns of the matching pairs are read
+    std::vector<std::string> headers;
+    for (const auto& column : query.columns) {
+        headers.push_back(column.label);
+    }
+    std::vector<std::string_view> cells;
+    cells.reserve(rows.size() * query.columns.size());
+    for (const auto& [leftRow, rightRow] : rows) {
+        for (const auto& column : query.columns) {
+            if (column.side == JoinSide::LEFT) {
+                cells.push_back(formatCell(scratch, query.left->data[column.columnIndex].valueAt(leftRow)));
             } else {
-                // char
-                // OpenAI model code (haven't found this thing in documentation, but it works :) )
-                fmt::print(" {:<{}} |", std::get<char>(value), colWidths[i]);
+                cells.push_back(formatCell(scratch, query.right->data[column.columnIndex].valueAt(rightRow)));
             }
         }
-        fmt::print("\n");
     }
+    printResultGrid(headers, cells);
+}
+
+void Database::explain(const SelectStatement& select, bool analyze) {
+    // Bound the same way as a plain SELECT (but not cached), then described or run with statistics
+    std::shared_ptr<SelectPlan> plan = bindSelect(select);
+    if (analyze) {
+        explainAnalyze(*plan);
+    } else {
+        explainPlan(*plan);
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Prepared statements
+
+void Database::prepare(const std::string& name, const std::string& query) {
+    ScratchScope scratchScope{*this};
+    Statement statement = parseStatement(query, scratch, true);
+    if (statement.kind != StatementKind::SELECT) {
+        throw std::runtime_error("Only SELECT statements can be prepared.");
+    }
+    preparePlan(name, statement.select);
+}
+
+void Database::preparePlan(std::string_view name, const SelectStatement& select) {
+    // PREPARE name AS SELECT ... WHERE column = ? ...
+    if (preparedPlans.find(name) != preparedPlans.end()) {
+        throw std::runtime_error("Prepared statement '" + std::string(name) + "' already exists.");
+    }
+    preparedPlans.emplace(name, bindSelect(select));
+    fmt::print("Statement '{}' prepared ({} parameter(s)).\n", name, select.parameterCount);
+}
+
+SelectPlan& Database::currentPlan(std::string_view name) {
+    auto it = preparedPlans.find(name);
+    if (it == preparedPlans.end()) {
+        throw std::runtime_error("Prepared statement '" + std::string(name) + "' does not exist.");
+    }
+    if (!planIsCurrent(*it->second)) {
+        // A table it reads was dropped or reloaded since: bind the query again
+        // (throws, and keeps the statement, if the table is gone)
+        it->second = bindSelect(it->second->select);
+    }
+    return *it->second;
+}
+
+static void checkParameterCount(std::string_view name, const SelectPlan& plan, size_t count) {
+    if (count != plan.parameterTypes.size()) {
+        throw std::runtime_error("Prepared statement '" + std::string(name) + "' takes " +
+                                 std::to_string(plan.parameterTypes.size()) + " parameter(s), got " +
+                                 std::to_string(count) + ".");
+    }
+}
+
+void Database::executePrepared(std::string_view name, const std::vector<Literal>& arguments) {
+    // EXECUTE name(value, ...): each value is converted to the type of its '?' slot, like an INSERT value
+    SelectPlan& plan = currentPlan(name);
+    checkParameterCount(name, plan, arguments.size());
+    std::vector<Value> parameters;
+    parameters.reserve(arguments.size());
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        parameters.push_back(literalValue(arguments[i], plan.parameterTypes[i], "parameter " + std::to_string(i + 1)));
+    }
+    runSelect(plan, parameters);
+}
+
+void Database::execute(const std::string& name, const std::vector<Value>& parameters) {
+    ScratchScope scratchScope{*this};
+    SelectPlan& plan = currentPlan(name);
+    checkParameterCount(name, plan, parameters.size());
+    runSelect(plan, parameters);
+}
+
+void Database::deallocate(std::string_view name) {
+    // DEALLOCATE name
+    auto it = preparedPlans.find(name);
+    if (it == preparedPlans.end()) {
+        throw std::runtime_error("Prepared statement '" + std::string(name) + "' does not exist.");
+    }
+    preparedPlans.erase(it);
+    fmt::print("Statement '{}' deallocated.\n", name);
+}
+
+// ---------------------------------------------------------------------------------------
+void Database::setThreads(std::string_view count) {
+    // SET THREADS n
+    int threadCount = 0;
+    auto [end, error] = std::from_chars(count.data(), count.data() + count.size(), threadCount);
+    if (error != std::errc() || end != count.data() + count.size()) {
+        throw std::runtime_error("Invalid thread count: " + std::string(count));
+    }
+    if (threadCount < 1) {
+        throw std::runtime_error("Thread count must be at least 1.");
+    }
+
+    ThreadPool::instance().setThreadCount(static_cast<size_t>(threadCount));
+    fmt::print("Queries will use {} thread(s).\n", threadCount);
+}
+
+static const char* dataTypeName(DataType type) {
+    switch (type) {
+        case DataType::INTEGER: return "INTEGER";
+        case DataType::VARCHAR: return "VARCHAR";
+        case DataType::DATE:    return "DATE";
+        case DataType::CHAR:    return "CHAR";
+        case DataType::FLOAT:   return "FLOAT";
+    }
+    return "?";
+}
+
+// Describes how a column is stored: its VARCHAR dictionary, or how many row groups use each encoding
+static std::string describeEncoding(const ColumnData& column) {
+    switch (column.type) {
+        case DataType::FLOAT:
+            return "plain";
+        case DataType::VARCHAR:
+            return column.dictionaryEncoded ? fmt::format("dictionary ({} distinct)", column.dictionary.size())
+                                            : "plain";
+        case DataType::INTEGER:
+        case DataType::DATE:
+        case DataType::CHAR:
+            break;
+    }
+
+    size_t counts[3] = {0, 0, 0};
+    size_t packedBits = 0;
+    for (const auto& group : column.encoded) {
+        ++counts[static_cast<size_t>(group.encoding())];
+        if (group.encoding() == ColumnEncoding::BITPACKED) packedBits += group.bitWidth();
+    }
+    std::vector<std::string> parts;
+    for (ColumnEncoding encoding : {ColumnEncoding::RLE, ColumnEncoding::BITPACKED, ColumnEncoding::PLAIN}) {
+        size_t count = counts[static_cast<size_t>(encoding)];
+        if (count == 0) continue;
+        std::string part = fmt::format("{} x{}", columnEncodingName(encoding), count);
+        if (encoding == ColumnEncoding::BITPACKED) {
+            part += fmt::format(" (avg {:.1f} bits)", static_cast<double>(packedBits) / count);
+        }
+        parts.push_back(part);
+    }
+    if (column.size() > column.sealedRows()) {
+        parts.push_back("open x1");
+    }
+    if (parts.empty()) {
+        return "-";
+    }
+    std::string result = parts[0];
+    for (size_t i = 1; i < parts.size(); ++i) {
+        result += ", " + parts[i];
+    }
+    return result;
+}
+
+void Database::showStorage(std::string_view tableName) {
+    // SHOW STORAGE table_name
+    auto it = tables.find(tableName);
+    if (it == tables.end()) {
+        throw std::runtime_error("Table '" + std::string(tableName) + "' does not exist.");
+    }
+    const Table& table = it->second;
+
+    std::vector<std::string_view> cells;
+    size_t totalBytes = 0, totalRaw = 0;
+    for (size_t i = 0; i < table.columns.size(); ++i) {
+        const ColumnData& column = table.data[i];
+        // What the values would take as plain arrays (strings packed back to back with their offsets)
+        size_t rawBytes = 0;
+        switch (column.type) {
+            case DataType::INTEGER:
+            case DataType::DATE:    rawBytes = column.size() * sizeof(int32_t); break;
+            case DataType::FLOAT:   rawBytes = column.size() * sizeof(float); break;
+            case DataType::CHAR:    rawBytes = column.size(); break;
+            case DataType::VARCHAR:
+                rawBytes = column.size() * sizeof(size_t);
+                for (size_t r = 0; r < column.size(); ++r) rawBytes += column.stringAt(r).size();
+                break;
+        }
+        size_t bytes = column.memoryUsage();
+        totalBytes += bytes;
+        totalRaw += rawBytes;
+        cells.insert(cells.end(), {table.columns[i].name, dataTypeName(column.type),
+                                   scratch.copyString(describeEncoding(column)),
+                                   scratch.copyString(formatBytes(bytes)), scratch.copyString(formatBytes(rawBytes))});
+    }
+    printResultGrid({"column", "type", "encoding", "bytes", "uncompressed"}, cells);
+    fmt::print("{} rows in groups of {}, {} in memory ({} uncompressed).\n", table.size(), kRowGroupSize,
+               formatBytes(totalBytes), formatBytes(totalRaw));
+}
+
+void Database::showMemory() {
+    // One row per table arena, then the scratch arena as the previous command left it
+    std::vector<std::string> headers = {"arena", "used", "allocations", "reserved", "blocks"};
+    std::vector<std::string_view> cells;
+    auto addRow = [&](std::string_view name, const ArenaStats& stats) {
+        cells.insert(cells.end(), {name, scratch.copyString(formatBytes(stats.bytesUsed)),
+                                   scratch.copyString(std::to_string(stats.allocations)),
+                                   scratch.copyString(formatBytes(stats.bytesReserved)),
+                                   scratch.copyString(std::to_string(stats.blocks))});
+    };
+    for (const auto& [name, table] : tables) {
+        addRow(scratch.copyString("table " + name), table.strings->stats());
+    }
+    addRow("previous command", lastCommandScratch);
+    printResultGrid(headers, cells);
+}
+
+void Database::showPlans() {
+    // One row per prepared statement, then the plan cache of plain SELECTs
+    std::vector<std::string> headers = {"statement", "plan", "tables", "parameters"};
+    std::vector<std::string_view> cells;
+    for (const auto& [name, plan] : preparedPlans) {
+        std::string kind = plan->kind == SelectPlan::Kind::SCAN ? "scan"
+                         : plan->kind == SelectPlan::Kind::AGGREGATE ? "aggregate" : "join";
+        std::string tableNames;
+        for (const auto& table : plan->tables) {
+            tableNames += (tableNames.empty() ? "" : ", ") + table.first;
+        }
+        std::string parameterTypes;
+        for (DataType type : plan->parameterTypes) {
+            parameterTypes += (parameterTypes.empty() ? "" : ", ") + std::string(dataTypeName(type));
+        }
+        cells.insert(cells.end(), {scratch.copyString(name), scratch.copyString(kind),
+                                   scratch.copyString(tableNames), scratch.copyString(parameterTypes)});
+    }
+    if (!cells.empty()) {
+        printResultGrid(headers, cells);
+    } else {
+        fmt::print("No prepared statements.\n");
+    }
+    fmt::print("Plan cache: {} of {} plans, {} hits, {} misses.\n",
+               planCache->size(), kPlanCacheSize, planCache->hits(), planCache->misses());
 }
 
 void Database::listTables() {
@@ -546,17 +769,46 @@ void Database::listTables() {
                 std::cout << ", ";
             }
         }
-        std::cout << "\n  Number of Rows: " << table.rows.size() << "\n";
+        std::cout << "\n  Number of Rows: " << table.size() << "\n";
+
+        size_t memory = 0;
+        std::vector<std::string> dictionaryColumns;
+        for (size_t i = 0; i < table.columns.size(); ++i) {
+            const ColumnData& column = table.data[i];
+            memory += column.memoryUsage();
+            if (column.dictionaryEncoded) {
+                dictionaryColumns.push_back(fmt::format("{} ({} distinct)", table.columns[i].name,
+                                                        column.dictionary.size()));
+            }
+        }
+        std::cout << "  Memory: " << formatBytes(memory) << "\n";
+        if (!dictionaryColumns.empty()) {
+            std::cout << "  Dictionary-encoded: ";
+            for (size_t i = 0; i < dictionaryColumns.size(); ++i) {
+                std::cout << dictionaryColumns[i];
+                if (i < dictionaryColumns.size() - 1) {
+                    std::cout << ", ";
+                }
+            }
+            std::cout << "\n";
+        }
+        if (!table.indexes.empty()) {
+            std::cout << "  Indexes: ";
+            for (size_t i = 0; i < table.indexes.size(); ++i) {
+                const TableIndex& index = *table.indexes[i];
+                std::cout << fmt::format("{} ({} on {}, {})", index.name(), indexKindName(index.kind()),
+                                         index.columnName(), formatBytes(index.memoryUsage()));
+                if (i < table.indexes.size() - 1) {
+                    std::cout << ", ";
+                }
+            }
+            std::cout << "\n";
+        }
     }
 }
 
-void Database::deleteFile(const std::string& rawFileName) {
-    // Preprocess the file name: trim spaces and remove trailing semicolon
-    std::string cleanedFileName = removeTrailingSemicolon(trim(rawFileName));
-
-    if (cleanedFileName.empty()) {
-        throw std::runtime_error("Syntax error in DELETE FILE command. File name is missing.");
-    }
+void Database::deleteFile(const std::string& cleanedFileName) {
+    // DELETE FILE file_name (the parser guarantees a non-empty name)
 
     // Construct the full file path
     const std::string fullFilePath = "./data" + cleanedFileName;
@@ -565,6 +817,8 @@ void Database::deleteFile(const std::string& rawFileName) {
     if (std::remove(fullFilePath.c_str()) != 0) {
         throw std::runtime_error("Failed to delete file: " + fullFilePath + ". File may not exist.");
     }
+    // The saved index list goes with it, if there is one
+    std::remove((fullFilePath + INDEX_FILE_SUFFIX).c_str());
 
     std::cout << "File '" << fullFilePath << "' deleted successfully." << std::endl;
 }
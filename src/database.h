@@ -1,62 +1,91 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
-#include <variant>
-
-// Enum for supported data types
-enum class DataType {
-    INTEGER,
-    VARCHAR,
-    DATE,
-    CHAR,
-    FLOAT
-};
-
-// Represents a column in a table
-struct Column {
-    std::string name; // Column name
-    DataType type;    // Column data type
-};
+#include <memory>
 
-// A single value in a row
-// using Value - creating new type alias (https://stackoverflow.com/questions/20790932/what-is-the-logic-behind-the-using-keyword-in-c)
-// std::variant - https://www.geeksforgeeks.org/std-variant-in-cpp-17/
-using Value = std::variant<int, float, char, std::string>;
+#include "storage.h"
 
-// Represents a single row of data
-struct Row {
-    std::vector<Value> values; // Values in the row
-};
-
-// Represents a table in the database
-struct Table {
-    std::string name;              // Table name
-    std::vector<Column> columns;   // Column definitions
-    std::vector<Row> rows;         // Rows of data
-};
+struct SelectStatement;
+struct InsertStatement;
+struct CreateTableStatement;
+struct CreateIndexStatement;
+struct Literal;
+struct SelectPlan;
+class PlanCache;
 
 // Main Database class
 class Database {
 private:
-    std::map<std::string, Table> tables; // Map of table names to Table objects
+    // Map of table names to Table objects (looked up by the names of a parsed command, see TableMap)
+    TableMap tables;
+
+    // Per-command scratch memory (e.g. formatted result cells), reset after every executeCommand
+    Arena scratch;
+    ArenaStats lastCommandScratch;  // what the previous command took from `scratch`
+
+    // Resets `scratch` when a command (or API call) returns or throws, recording what it used
+    struct ScratchScope {
+        Database& db;
+        ~ScratchScope() {
+            db.lastCommandScratch = db.scratch.stats();
+            db.scratch.reset();
+        }
+    };
+
+    uint64_t nextGeneration = 1;    // next Table::generation
+    std::map<std::string, std::shared_ptr<SelectPlan>, std::less<>> preparedPlans;   // PREPARE name -> bound plan
+    std::unique_ptr<PlanCache> planCache;   // bound plans of recent plain SELECTs, by normalized text
 
     // Private helpers
-    void createTable(const std::string& command);
-    void dropTable(const std::string& command);
-    void insertInto(const std::string& command);
-    void selectFrom(const std::string& command);
+    // Command handlers, called with the parsed statement (see parser.h)
+    void createTable(const CreateTableStatement& create);
+    void dropTable(std::string_view tableName);
+    void createIndex(const CreateIndexStatement& create);
+    void dropIndex(std::string_view indexName);
+    Table* findTableWithIndex(std::string_view indexName);
+    void insertInto(const InsertStatement& insert);
     void listTables();
+    void showStorage(std::string_view tableName);
+    void showMemory();
+    void setThreads(std::string_view count);
+    void showPlans();
+
+    // SELECT is bound into a SelectPlan (plan.h) and then run; plans are reused by
+    // prepared statements and the plan cache until a table they read is dropped or reloaded
+    std::shared_ptr<SelectPlan> bindSelect(const SelectStatement& select);
+    bool planIsCurrent(const SelectPlan& plan) const;
+    void runSelect(SelectPlan& plan, const std::vector<Value>& parameters);
+    void selectRows(const SelectPlan& plan);
+    void selectAggregate(const SelectPlan& plan);
+    void selectJoin(const SelectPlan& plan);
+    void explain(const SelectStatement& select, bool analyze);     // EXPLAIN [ANALYZE] SELECT ...
+
+    // Prepared statements
+    void preparePlan(std::string_view name, const SelectStatement& select);
+    SelectPlan& currentPlan(std::string_view name);     // re-bound first if a table changed
+    void executePrepared(std::string_view name, const std::vector<Literal>& arguments);
 
     // File IO
-    void saveToFile(const std::string& command);
-    void loadFromFile(const std::string& command);
-    void deleteFile(const std::string& rawFileName);
+    // SAVE table [AS file] (file defaults to table.csv), LOAD file [AS table] (table defaults to the file name)
+    void saveToFile(const std::string& tableName, const std::string& csvFileName);
+    void loadFromFile(const std::string& csvFileName, const std::string& tableName);
+    void deleteFile(const std::string& fileName);
 
-    DataType parseDataType(const std::string& typeStr);
+    DataType parseDataType(std::string_view typeStr);
 
 public:
     Database();
+    ~Database();
     // API for interacting with the database
     void executeCommand(const std::string& command);
+
+    // Prepared statements, the same as PREPARE name AS SELECT ... / EXECUTE name(...) / DEALLOCATE name.
+    // The query is parsed and bound once; each '?' in it is a slot typed by the column it is compared
+    // with, and execute() takes one value of that type per slot, in order (e.g. Value(42),
+    // Value::string("Paris"), Value::date(days)). Throws on an unknown name or mismatched parameters.
+    void prepare(const std::string& name, const std::string& query);
+    void execute(const std::string& name, const std::vector<Value>& parameters);
+    void deallocate(std::string_view name);
 };
@@ -0,0 +1,75 @@
+#include <stdexcept>
+#include <fmt/format.h>
+
+#include "date.h"
+
+// Civil date <-> day number conversions (Howard Hinnant's algorithms, proleptic Gregorian calendar).
+// Years are split into 400-year eras of 146097 days so no table or loop is needed.
+static int32_t daysFromCivil(int32_t year, uint32_t month, uint32_t day) {
+    year -= month <= 2;
+    const int32_t era = (year >= 0 ? year : year - 399) / 400;
+    const uint32_t yearOfEra = static_cast<uint32_t>(year - era * 400);                       // [0, 399]
+    const uint32_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1; // [0, 365]
+    const uint32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;    // [0, 146096]
+    return era * 146097 + static_cast<int32_t>(dayOfEra) - 719468;
+}
+
+static void civilFromDays(int32_t days, int32_t& year, uint32_t& month, uint32_t& day) {
+    days += 719468;
+    const int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const uint32_t dayOfEra = static_cast<uint32_t>(days - era * 146097);
+    const uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const uint32_t mp = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<int32_t>(yearOfEra) + era * 400 + (month <= 2);
+}
+
+static bool isLeapYear(int32_t year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// Reads 1..maxDigits digits starting at `pos`; false if there are none
+static bool readNumber(std::string_view text, size_t& pos, size_t maxDigits, uint32_t& value) {
+    size_t start = pos;
+    value = 0;
+    while (pos < text.size() && pos - start < maxDigits && text[pos] >= '0' && text[pos] <= '9') {
+        value = value * 10 + static_cast<uint32_t>(text[pos] - '0');
+        ++pos;
+    }
+    return pos > start;
+}
+
+bool parseDate(std::string_view text, int32_t& days) {
+    size_t pos = 0;
+    uint32_t year, month, day;
+    if (!readNumber(text, pos, 4, year) || pos != 4) return false;
+    if (pos >= text.size() || text[pos++] != '-') return false;
+    if (!readNumber(text, pos, 2, month)) return false;
+    if (pos >= text.size() || text[pos++] != '-') return false;
+    if (!readNumber(text, pos, 2, day) || pos != text.size()) return false;
+
+    static constexpr uint32_t kDaysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month < 1 || month > 12 || day < 1) return false;
+    uint32_t monthDays = kDaysInMonth[month - 1] + (month == 2 && isLeapYear(static_cast<int32_t>(year)) ? 1 : 0);
+    if (day > monthDays) return false;
+
+    days = daysFromCivil(static_cast<int32_t>(year), month, day);
+    return true;
+}
+
+int32_t parseDateOrThrow(std::string_view text) {
+    int32_t days = 0;
+    if (!parseDate(text, days)) {
+        throw std::runtime_error("Invalid DATE value '" + std::string(text) + "' (expected YYYY-MM-DD).");
+    }
+    return days;
+}
+
+std::string formatDate(int32_t days) {
+    int32_t year;
+    uint32_t month, day;
+    civilFromDays(days, year, month, day);
+    return fmt::format("{:04}-{:02}-{:02}", year, month, day);
+}
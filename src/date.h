@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// DATE values are stored as the number of days since 1970-01-01 (negative before it),
+// so comparing, sorting and range-filtering dates is plain int32 work.
+// Text is only parsed when a date enters the database and formatted when it leaves.
+
+// Parses "YYYY-MM-DD" (month and day may have one digit) into days since the epoch.
+// Returns false if the text is not a valid calendar date between years 0 and 9999.
+bool parseDate(std::string_view text, int32_t& days);
+
+// Same, but throws std::runtime_error for an invalid date
+int32_t parseDateOrThrow(std::string_view text);
+
+// Formats days since the epoch as zero-padded ISO "YYYY-MM-DD"
+std::string formatDate(int32_t days);
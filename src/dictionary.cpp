@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+#include "dictionary.h"
+
+size_t StringDictionary::findSlot(std::string_view value, size_t hash) const {
+    size_t mask = slots.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        uint32_t entry = slots[slot];
+        if (entry == 0 || (hashes[entry - 1] == hash && at(entry - 1) == value)) {
+            return slot;
+        }
+    }
+}
+
+uint32_t StringDictionary::intern(std::string_view value, Arena& arena) {
+    size_t hash = std::hash<std::string_view>{}(value);
+    size_t slot = findSlot(value, hash);
+    if (slots[slot] != 0) {
+        return slots[slot] - 1;
+    }
+
+    uint32_t code = static_cast<uint32_t>(size());
+    entries.push_back(arena.copyLengthPrefixed(value));
+    entryBytes += sizeof(uint32_t) + value.size();
+    hashes.push_back(hash);
+    slots[slot] = code + 1;
+    if (size() * 2 > slots.size()) {
+        grow();
+    }
+    return code;
+}
+
+int32_t StringDictionary::find(std::string_view value) const {
+    uint32_t entry = slots[findSlot(value, std::hash<std::string_view>{}(value))];
+    return static_cast<int32_t>(entry) - 1;
+}
+
+void StringDictionary::grow() {
+    std::vector<uint32_t> bigger(slots.size() * 2, 0);
+    size_t mask = bigger.size() - 1;
+    for (uint32_t code = 0; code < size(); ++code) {
+        size_t slot = hashes[code] & mask;
+        while (bigger[slot] != 0) slot = (slot + 1) & mask;
+        bigger[slot] = code + 1;
+    }
+    slots = std::move(bigger);
+}
+
+std::vector<uint32_t> StringDictionary::sortedRanks() const {
+    std::vector<uint32_t> order(size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return at(a) < at(b); });
+
+    std::vector<uint32_t> ranks(size());
+    for (uint32_t rank = 0; rank < order.size(); ++rank) {
+        ranks[order[rank]] = rank;
+    }
+    return ranks;
+}
+
+size_t StringDictionary::memoryUsage() const {
+    return entries.capacity() * sizeof(const char*) + entryBytes +
+           hashes.capacity() * sizeof(size_t) + slots.capacity() * sizeof(uint32_t);
+}
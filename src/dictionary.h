@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"
+
+// A dictionary-encoded column holds at most this many distinct strings, so codes fit in 16 bits
+constexpr size_t kDictionaryMaxSize = size_t{1} << 16;
+
+// The distinct strings of a dictionary-encoded VARCHAR column.
+// Every string is stored once and numbered (its code) in order of first appearance;
+// rows only keep the code. The strings live in the table's string arena in the same layout as
+// plain VARCHAR values (Arena::copyLengthPrefixed), so they never move, show up in the table's
+// arena statistics and are handed over as they are when the column is decoded.
+// They are found again through an open-addressing hash table.
+class StringDictionary {
+public:
+    StringDictionary() { slots.assign(16, 0); }
+
+    size_t size() const { return entries.size(); }
+
+    std::string_view at(uint32_t code) const { return lengthPrefixedString(entries[code]); }
+
+    // The arena entry holding the string of `code`
+    const char* entry(uint32_t code) const { return entries[code]; }
+
+    // Returns the code of `value`, adding it to the dictionary (its string copied into `arena`)
+    // if it's not there yet
+    uint32_t intern(std::string_view value, Arena& arena);
+
+    // Returns the code of `value`, or -1 if the dictionary doesn't hold it
+    int32_t find(std::string_view value) const;
+
+    // ranks[code] is the position of the code's string in sorted (byte) order,
+    // so comparing ranks compares the strings. Computed on every call.
+    std::vector<uint32_t> sortedRanks() const;
+
+    // Bytes of the dictionary's own arrays plus its strings in the arena
+    size_t memoryUsage() const;
+
+    // Bytes its strings take in the arena (length prefixes included)
+    size_t stringBytes() const { return entryBytes; }
+
+private:
+    // Slot holding `value`, or the empty slot where it would go
+    size_t findSlot(std::string_view value, size_t hash) const;
+
+    // Doubles the slot array and re-inserts every code using its stored hash
+    void grow();
+
+    std::vector<const char*> entries;   // string of every code, in the arena
+    size_t entryBytes = 0;
+    std::vector<size_t> hashes;         // hash of every string, by code
+    std::vector<uint32_t> slots;        // code + 1, 0 = empty
+};
@@ -0,0 +1,375 @@
+#include <algorithm>
+#include <string>
+
+#include "explain.h"
+#include "pipeline.h"
+#include "heap_stats.h"
+#include "thread_pool.h"
+#include "utils.h"
+#include "fmt/format.h"
+
+// ---------------------------------------------------------------------------------------
+// EXPLAIN
+
+// Prints `text` indented by `depth` levels
+static void printLine(int depth, const std::string& text) {
+    fmt::print("{:{}}{}\n", "", depth * 2, text);
+}
+
+static std::string orderByText(const std::vector<std::pair<SelectItem, bool>>& orderBy) {
+    std::string text;
+    for (const auto& [item, isDesc] : orderBy) {
+        if (!text.empty()) text += ", ";
+        text += item.label() + (isDesc ? " DESC" : "");
+    }
+    return text;
+}
+
+// The WHERE tree in evaluation order, one node per line
+static void explainPredicateNode(const BoundPredicate& predicate, const PredicateNode& node, int depth) {
+    std::string estimates = fmt::format("selectivity {:.3f}, cost {:.2f}", node.selectivity, node.cost);
+    if (node.kind == PredicateNode::Kind::CONDITION) {
+        const BoundCondition& cond = predicate.conditions[node.condition];
+        printLine(depth, fmt::format("{} ({}{})", describeCondition(cond), estimates,
+                                     cond.onCodes ? ", on dictionary codes" : ""));
+        return;
+    }
+    const char* name = (node.kind == PredicateNode::Kind::AND) ? "AND" : "OR";
+    printLine(depth, fmt::format("{} of {} ({})", name, node.operands.size(), estimates));
+    for (const auto& operand : node.operands) {
+        explainPredicateNode(predicate, operand, depth + 1);
+    }
+}
+
+// How one table is read: access path, filter and parallelism
+static void explainScan(const std::string& label, const Table& table, const ScanPlan& plan,
+                        const BoundPredicate* predicate, bool startSmall, int depth) {
+    size_t threads = ThreadPool::instance().threadCount();
+    size_t groups = (table.size() + kRowGroupSize - 1) / kRowGroupSize;
+    printLine(depth, fmt::format("{} {}: {} rows in {} row groups", label, table.name, table.size(), groups));
+
+    const TableIndex* index = plan.index();
+    switch (plan.access()) {
+        case ScanPlan::Access::SCAN: {
+            std::string bloom;
+            for (const auto& candidate : table.indexes) {
+                if (candidate->kind() == IndexKind::BLOOM) {
+                    bloom += (bloom.empty() ? ", Bloom filters " : ", ") + candidate->name();
+                }
+            }
+            printLine(depth + 1, predicate == nullptr ? "Access: full scan, no filter"
+                                                      : "Access: full scan; zone maps" + bloom +
+                                                        " rule out row groups, the rest is filtered in blocks of " +
+                                                        std::to_string(kFilterBlockSize) + " rows");
+            break;
+        }
+        case ScanPlan::Access::BTREE:
+            printLine(depth + 1, fmt::format("Access: B+tree index {} on {}: {} rows, re-checked against the filter",
+                                             index->name(), index->columnName(), plan.inputSize()));
+            break;
+        case ScanPlan::Access::BITMAP:
+            printLine(depth + 1, fmt::format("Access: bitmap indexes answer the whole filter (first: {} on {}): "
+                                             "{} rows, no row read", index->name(), index->columnName(), plan.inputSize()));
+            break;
+        case ScanPlan::Access::BITMAP_CANDIDATES:
+            printLine(depth + 1, fmt::format("Access: bitmap index candidates (first: {} on {}): {} rows, "
+                                             "re-checked against the filter", index->name(), index->columnName(),
+                                             plan.inputSize()));
+            break;
+    }
+
+    if (predicate != nullptr && !predicate->empty()) {
+        printLine(depth + 1, "Filter: " + describePredicate(*predicate));
+        explainPredicateNode(*predicate, predicate->root, depth + 2);
+    }
+
+    if (plan.access() != ScanPlan::Access::SCAN) {
+        printLine(depth + 1, fmt::format("Parallelism: {} morsel(s) of the index rows on {} worker(s)",
+                                         plan.morselCount(), threads));
+    } else if (startSmall) {
+        printLine(depth + 1, fmt::format("Parallelism: first chunk of {} rows on the calling thread, doubling up to "
+                                         "one morsel of {} rows per worker ({} worker(s))",
+                                         kRowGroupSize, kMorselRows, threads));
+    } else {
+        printLine(depth + 1, fmt::format("Parallelism: {} morsel(s) of {} rows on {} worker(s)",
+                                         plan.morselCount(), kMorselRows, threads));
+    }
+}
+
+// LIMIT and ORDER BY applied to a whole result (groups, joined rows)
+static void explainSort(const SelectStatement& select, const std::string& what, int& depth) {
+    if (select.limit >= 0) {
+        printLine(depth++, fmt::format("Limit: {}", select.limit));
+    }
+    if (!select.orderBy.empty()) {
+        printLine(depth++, fmt::format("Sort: ORDER BY {} (stable sort of the {})", orderByText(select.orderBy), what));
+    }
+}
+
+void explainPlan(const SelectPlan& plan) {
+    const SelectStatement& select = plan.select;
+    size_t threads = ThreadPool::instance().threadCount();
+    int depth = 0;
+
+    switch (plan.kind) {
+        case SelectPlan::Kind::SCAN: {
+            const Table& table = *plan.table;
+            SelectPipeline pipeline = buildPipeline(plan);
+            std::string columns;
+            for (int c : plan.columns) {
+                columns += (columns.empty() ? "" : ", ") + table.columns[c].name;
+            }
+            printLine(depth++, fmt::format("Output: grid, streamed once the result passes {} rows", kSinkBufferRows));
+            printLine(depth++, "Project: " + columns + " (values read only for the rows that reach it)");
+            if (select.orderBy.empty() && select.limit >= 0) {
+                printLine(depth++, fmt::format("Limit: {} (stops pulling from the scan once {} rows passed)",
+                                               select.limit, select.limit));
+            } else if (usesTopK(plan)) {
+                printLine(depth++, fmt::format("Top-K: ORDER BY {}, k = {} (a bounded heap per worker, {} worker(s), "
+                                               "then merged)", orderByText(select.orderBy), select.limit, threads));
+            } else if (!select.orderBy.empty()) {
+                printLine(depth++, fmt::format("Sort: ORDER BY {} (stable radix sort on normalized keys, in parallel runs "
+                                               "of at least {} rows per worker)", orderByText(select.orderBy),
+                                               kParallelSortMinRowsPerThread));
+            }
+            explainScan("Scan", table, pipeline.scan->scanPlan(), plan.hasWhere ? &plan.predicate : nullptr,
+                        pipeline.scan->startsSmall(), depth);
+            break;
+        }
+
+        case SelectPlan::Kind::AGGREGATE: {
+            const Table& table = *plan.table;
+            explainSort(select, "groups", depth);
+            std::string aggregates;
+            for (const auto& spec : plan.aggregate.aggregates) {
+                aggregates += (aggregates.empty() ? "" : ", ") + spec.label;
+            }
+            if (plan.aggregate.groupColumns.empty()) {
+                printLine(depth++, fmt::format("Aggregate: {} (one state per worker, {} worker(s), vectorized over "
+                                               "contiguous rows)", aggregates, threads));
+            } else {
+                std::string groups;
+                for (size_t c : plan.aggregate.groupColumns) {
+                    groups += (groups.empty() ? "" : ", ") + table.columns[c].name;
+                }
+                printLine(depth++, fmt::format("Aggregate: {} GROUP BY {} (a hash table per worker, {} worker(s), "
+                                               "merged in {} partitions)", aggregates.empty() ? "-" : aggregates,
+                                               groups, threads, kAggregatePartitions));
+            }
+            const BoundPredicate* predicate = plan.hasWhere ? &plan.predicate : nullptr;
+            explainScan("Scan", table, ScanPlan(table, predicate), predicate, false, depth);
+            break;
+        }
+
+        case SelectPlan::Kind::JOIN: {
+            const JoinQuery& query = plan.join;
+            if (select.orderBy.empty() && select.limit >= 0) {
+                printLine(depth++, fmt::format("Limit: {} (the probe stops once {} pairs are found)",
+                                               select.limit, select.limit));
+            } else {
+                explainSort(select, "joined rows", depth);
+            }
+            std::string columns;
+            for (const auto& column : query.columns) {
+                columns += (columns.empty() ? "" : ", ") + column.label;
+            }
+            printLine(depth++, "Project: " + columns);
+
+            // Build on the smaller table, the same rule runHashJoin applies
+            bool buildLeft = query.left->size() < query.right->size();
+            printLine(depth, fmt::format("Hash join: {}.{} = {}.{}, build on {}, probe {} on {} worker(s)",
+                                         query.left->name, query.left->columns[query.leftKey].name,
+                                         query.right->name, query.right->columns[query.rightKey].name,
+                                         (buildLeft ? query.left : query.right)->name,
+                                         (buildLeft ? query.right : query.left)->name, threads));
+            if (!query.residual.empty()) {
+                printLine(depth + 1, "Residual filter on joined rows: " + describePredicate(query.residual));
+            }
+            const BoundPredicate* leftFilter = query.hasLeftFilter ? &query.leftFilter : nullptr;
+            const BoundPredicate* rightFilter = query.hasRightFilter ? &query.rightFilter : nullptr;
+            const BoundPredicate* buildFilter = buildLeft ? leftFilter : rightFilter;
+            const BoundPredicate* probeFilter = buildLeft ? rightFilter : leftFilter;
+            const Table& buildTable = buildLeft ? *query.left : *query.right;
+            const Table& probeTable = buildLeft ? *query.right : *query.left;
+            explainScan("Build scan", buildTable, ScanPlan(buildTable, buildFilter), buildFilter, false, depth + 1);
+            explainScan("Probe scan", probeTable, ScanPlan(probeTable, probeFilter), probeFilter, false, depth + 1);
+            break;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// EXPLAIN ANALYZE
+
+// The stage table printed by EXPLAIN ANALYZE
+class StageReport {
+public:
+    // `stats` and `input` are inclusive; the stage's own time and allocations are the difference
+    void add(const std::string& stage, const OperatorStats& stats, const OperatorStats* input,
+             const std::string& rowsIn, const std::string& skipped) {
+        add(stage, stats, input, rowsIn, std::to_string(stats.rowsOut), skipped);
+    }
+    void add(const std::string& stage, const OperatorStats& stats, const OperatorStats* input,
+             const std::string& rowsIn, const std::string& rowsOut, const std::string& skipped) {
+        double seconds = stats.seconds - (input != nullptr ? input->seconds : 0.0);
+        size_t bytes = stats.bytesAllocated - std::min(stats.bytesAllocated, input != nullptr ? input->bytesAllocated : 0);
+        for (const std::string& cell : {stage, fmt::format("{:.3f} ms", std::max(seconds, 0.0) * 1000.0), rowsIn,
+                                        rowsOut, kHeapStatsEnabled ? formatBytes(bytes) : "-", skipped}) {
+            cells.text += cell;
+            cells.ends.push_back(cells.text.size());
+        }
+    }
+
+    void print() {
+        GridSink sink({"stage", "time", "rows in", "rows out", "allocated", "skipped"},
+                      [] { return std::vector<size_t>(6, 0); });
+        sink.write(cells);
+        sink.finish();
+    }
+
+private:
+    CellBatch cells;
+};
+
+// "skipped" of a scan: rows an index or the zone maps kept the filter from reading
+static std::string skippedText(const Table& table, const ScanPlan& plan, const ScanStats& stats) {
+    if (plan.index() != nullptr) {
+        return fmt::format("{} (index {})", table.size() - plan.inputSize(), plan.index()->name());
+    }
+    return fmt::format("{} (zone maps)", stats.rowsSkippedByZones.load());
+}
+
+static void printZoneSummary(const ScanStats& stats) {
+    fmt::print("Zone maps: {} rows in row groups ruled out, {} rows in row groups matching entirely; "
+               "filter evaluated on {} rows.\n",
+               stats.rowsSkippedByZones.load(), stats.rowsPassedByZones.load(), stats.rowsFiltered.load());
+}
+
+void explainAnalyze(const SelectPlan& plan) {
+    const SelectStatement& select = plan.select;
+    StageReport report;
+    OperatorStats total;
+    size_t resultRows = 0;
+    ScanStats scanStats;
+    bool scanned = false;
+
+    {
+        StatsScope totalScope(total);
+        switch (plan.kind) {
+            case SelectPlan::Kind::SCAN: {
+                const Table& table = *plan.table;
+                OperatorStats planning;
+                SelectPipeline pipeline;
+                {
+                    StatsScope scope(planning);
+                    pipeline = buildPipeline(plan);     // index lookups happen here
+                }
+                pipeline.scan->collectStats(&scanStats);
+                scanned = plan.hasWhere && pipeline.scan->scanPlan().index() == nullptr;
+
+                // Run it to the end, formatting but not printing
+                CellBatch cells;
+                while (pipeline.project->next(cells)) {
+                }
+
+                report.add("plan", planning, nullptr, "-", "-", "-");
+                const OperatorStats& scan = pipeline.scan->stats();
+                report.add("scan", scan, nullptr, std::to_string(table.size()),
+                           skippedText(table, pipeline.scan->scanPlan(), scanStats));
+                const OperatorStats* input = &scan;
+                if (pipeline.sort != nullptr) {
+                    report.add(usesTopK(plan) ? "top-k" : "sort", pipeline.sort->stats(), input, std::to_string(input->rowsOut), "-");
+                    input = &pipeline.sort->stats();
+                }
+                if (pipeline.limit != nullptr) {
+                    report.add("limit", pipeline.limit->stats(), input, std::to_string(input->rowsOut), "-");
+                    input = &pipeline.limit->stats();
+                }
+                report.add("project", pipeline.project->stats(), input, std::to_string(input->rowsOut), "-");
+                resultRows = pipeline.project->stats().rowsOut;
+                break;
+            }
+
+            case SelectPlan::Kind::AGGREGATE: {
+                const Table& table = *plan.table;
+                const BoundPredicate* predicate = plan.hasWhere ? &plan.predicate : nullptr;
+                OperatorStats aggregate;
+                AggregateResult result;
+                {
+                    StatsScope scope(aggregate);
+                    result = runAggregate(table, plan.aggregate, predicate, &scanStats);
+                }
+                aggregate.rowsOut = result.rows.size();
+                std::string skipped = "-";
+                if (predicate != nullptr) {
+                    ScanPlan scanPlan(table, predicate);
+                    skipped = skippedText(table, scanPlan, scanStats);
+                    scanned = scanPlan.index() == nullptr;
+                }
+                report.add("scan + aggregate", aggregate, nullptr, std::to_string(table.size()), skipped);
+
+                size_t groups = result.rows.size();
+                if (!select.orderBy.empty()) {
+                    OperatorStats sort;
+                    {
+                        StatsScope scope(sort);
+                        sortAggregateResult(result, select.orderBy);
+                    }
+                    sort.rowsOut = result.rows.size();
+                    report.add("sort", sort, nullptr, std::to_string(groups), "-");
+                }
+                if (select.limit >= 0 && static_cast<size_t>(select.limit) < result.rows.size()) {
+                    result.rows.resize(select.limit);
+                }
+                resultRows = result.rows.size();
+                if (select.limit >= 0) {
+                    OperatorStats limit;
+                    limit.rowsOut = resultRows;
+                    report.add("limit", limit, nullptr, std::to_string(groups), "-");
+                }
+                break;
+            }
+
+            case SelectPlan::Kind::JOIN: {
+                const JoinQuery& query = plan.join;
+                OperatorStats join;
+                JoinRows rows;
+                {
+                    StatsScope scope(join);
+                    rows = runHashJoin(query, select.orderBy.empty() ? select.limit : -1);
+                }
+                join.rowsOut = rows.size();
+                report.add("hash join", join, nullptr, std::to_string(query.left->size() + query.right->size()), "-");
+
+                size_t pairs = rows.size();
+                if (!select.orderBy.empty()) {
+                    OperatorStats sort;
+                    {
+                        StatsScope scope(sort);
+                        sortJoinRows(query, rows, select.orderBy);
+                    }
+                    sort.rowsOut = rows.size();
+                    report.add("sort", sort, nullptr, std::to_string(pairs), "-");
+                }
+                if (select.limit >= 0 && static_cast<size_t>(select.limit) < rows.size()) {
+                    rows.resize(select.limit);
+                }
+                resultRows = rows.size();
+                if (select.limit >= 0) {
+                    OperatorStats limit;
+                    limit.rowsOut = resultRows;
+                    report.add("limit", limit, nullptr, std::to_string(pairs), "-");
+                }
+                break;
+            }
+        }
+    }
+
+    report.print();
+    if (scanned) {
+        printZoneSummary(scanStats);
+    }
+    std::string allocated = kHeapStatsEnabled ? fmt::format(", {} allocated", formatBytes(total.bytesAllocated)) : "";
+    fmt::print("Total: {:.3f} ms, {} result row(s){}, {} worker(s).\n", total.seconds * 1000.0, resultRows, allocated,
+               ThreadPool::instance().threadCount());
+}
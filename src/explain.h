@@ -0,0 +1,13 @@
+#pragma once
+#include "plan.h"
+
+// EXPLAIN: prints how a bound SELECT would run, top operator first: the sort strategy and LIMIT,
+// how each table is read (full scan with zone maps, B+tree or bitmap index), the WHERE tree in
+// evaluation order with the selectivity and cost estimates that ordered it, and how the work is
+// split over the thread pool. Index lookups are part of choosing the plan, so they do run.
+void explainPlan(const SelectPlan& plan);
+
+// EXPLAIN ANALYZE: runs the query without printing its rows and prints one line per stage:
+// wall time, rows in and out, heap bytes allocated (MINIDB_HEAP_STATS builds only) and rows skipped
+// by indexes or zone maps. Times and allocations are the stage's own (its input's work is subtracted).
+void explainAnalyze(const SelectPlan& plan);
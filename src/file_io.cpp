@@ -5,23 +5,79 @@
 #include <fmt/format.h>
 
 #include "database.h"
+#include "index.h"
+#include "date.h"
 #include "utils.h"
 
-void Database::saveToFile(const std::string& command) {
-    // Split the command on " AS " (case-sensitive match)
-    std::string command_pr = removeTrailingSemicolon(trim(command));
-    int asPos = command_pr.find(" AS ");
-    std::string tableName, csvFileName;
+// Writes a VARCHAR value as a CSV field. Values with a comma, a quote, a line break or spaces at
+// either end (which LOAD would trim) are quoted, with embedded quotes doubled.
+static void writeCsvField(std::ostream& os, std::string_view value) {
+    bool needsQuotes = value.find_first_of(",\"\n\r") != std::string_view::npos ||
+                       (!value.empty() && (value.front() == ' ' || value.front() == '\t' ||
+                                           value.back() == ' ' || value.back() == '\t'));
+    if (!needsQuotes) {
+        os << value;
+        return;
+    }
+    os << '"';
+    for (char c : value) {
+        if (c == '"') os << '"';
+        os << c;
+    }
+    os << '"';
+}
 
-    if (asPos != std::string::npos) {
-        // "AS" is present: Extract table name and CSV file name
-        tableName = trim(command_pr.substr(0, asPos));
-        csvFileName = trim(command_pr.substr(asPos + 4)); // Skip " AS "
-    } else {
-        // "AS" not present: Treat the table name as the CSV file name
-        tableName = trim(command_pr);
-        csvFileName = tableName + ".csv";
+// Reads one CSV record into `fields`; false at the end of the file. Quoted fields may contain
+// commas, doubled quotes and line breaks, and are kept as they are; unquoted fields are trimmed.
+static bool readCsvRecord(std::istream& is, std::vector<std::string>& fields) {
+    std::string line;
+    if (!std::getline(is, line)) {
+        return false;
     }
+    fields.clear();
+    std::string field;
+    bool quoted = false;        // the current field was quoted
+    bool inQuotes = false;
+    size_t i = 0;
+    while (true) {
+        if (i == line.size()) {
+            if (!inQuotes) break;
+            // A line break inside quotes belongs to the value
+            if (!std::getline(is, line)) {
+                throw std::runtime_error("Unterminated quoted value in CSV file.");
+            }
+            field += '\n';
+            i = 0;
+            continue;
+        }
+        char c = line[i++];
+        if (inQuotes) {
+            if (c != '"') {
+                field += c;
+            } else if (i < line.size() && line[i] == '"') {
+                field += '"';
+                ++i;
+            } else {
+                inQuotes = false;
+            }
+        } else if (c == ',') {
+            fields.push_back(quoted ? field : trim(field));
+            field.clear();
+            quoted = false;
+        } else if (c == '"' && trim(field).empty() && !quoted) {
+            field.clear();
+            quoted = inQuotes = true;
+        } else if (!quoted || (c != ' ' && c != '\t' && c != '\r')) {
+            field += c;
+        }
+    }
+    fields.push_back(quoted ? field : trim(field));
+    return true;
+}
+
+void Database::saveToFile(const std::string& tableName, const std::string& fileName) {
+    // Without AS the table name is used as the CSV file name
+    std::string csvFileName = fileName.empty() ? tableName + ".csv" : fileName;
 
     if (tableName.empty() || csvFileName.empty()) {
         throw std::runtime_error("Syntax error in SAVE command. Table name or CSV file name is missing.");
@@ -54,20 +110,19 @@ void Database::saveToFile(const std::string& command) {
     }
     ofs << "\n";
 
-    // Save rows
-    for (const auto& row : table.rows) {
-        for (int i = 0; i < row.values.size(); ++i) {
-            if (std::holds_alternative<int>(row.values[i])) {
-                ofs << std::get<int>(row.values[i]);
-            } else if (std::holds_alternative<float>(row.values[i])) {
-                ofs << std::get<float>(row.values[i]);
-            } else if (std::holds_alternative<char>(row.values[i])) {
-                ofs << std::get<char>(row.values[i]);
-            } else if (std::holds_alternative<std::string>(row.values[i])) {
-                ofs << std::get<std::string>(row.values[i]); // No quotes
+    // Save rows (read straight from the column arrays)
+    for (size_t r = 0; r < table.size(); ++r) {
+        for (size_t i = 0; i < table.columns.size(); ++i) {
+            const ColumnData& column = table.data[i];
+            switch (column.type) {
+                case DataType::INTEGER: ofs << column.intAt(r); break;
+                case DataType::FLOAT:   ofs << column.floatAt(r); break;
+                case DataType::CHAR:    ofs << column.charAt(r); break;
+                case DataType::DATE:    ofs << formatDate(column.intAt(r)); break;
+                case DataType::VARCHAR: writeCsvField(ofs, column.stringAt(r)); break;
             }
 
-            if (i < row.values.size() - 1) {
+            if (i < table.columns.size() - 1) {
                 ofs << ",";
             }
         }
@@ -75,25 +130,34 @@ void Database::saveToFile(const std::string& command) {
     }
 
     ofs.close();
+
+    // Save the index definitions so LOAD can rebuild them (and drop a stale list)
+    const std::string indexFilePath = filepath + INDEX_FILE_SUFFIX;
+    if (table.indexes.empty()) {
+        std::remove(indexFilePath.c_str());
+    } else {
+        std::ofstream indexFile(indexFilePath);
+        if (!indexFile) {
+            throw std::runtime_error("Failed to open file for saving: " + indexFilePath);
+        }
+        for (const auto& index : table.indexes) {
+            indexFile << index->name() << "," << index->columnName();
+            if (index->kind() == IndexKind::BITMAP) {
+                indexFile << ",BITMAP";
+            } else if (index->kind() == IndexKind::BLOOM) {
+                indexFile << ",BLOOM";
+            }
+            indexFile << "\n";
+        }
+    }
+
     std::cout << "Table '" << tableName << "' saved to '" << filepath << "' successfully." << std::endl;
 }
 
 
-void Database::loadFromFile(const std::string& command) {
-    // Split the command on " AS " (case-sensitive match)
-    std::string cleanedCommand = removeTrailingSemicolon(trim(command));
-    int asPos = cleanedCommand.find(" AS ");
-    std::string csvFileName, tableName;
-
-    if (asPos != std::string::npos) {
-        // "AS" is present: Extract CSV file name and table name
-        csvFileName = trim(cleanedCommand.substr(0, asPos));
-        tableName = trim(cleanedCommand.substr(asPos + 4)); // Skip " AS "
-    } else {
-        // "AS" not present: Treat the CSV file name as the table name
-        csvFileName = trim(cleanedCommand);
-        tableName = csvFileName.substr(0, csvFileName.find_last_of('.')); // Remove ".csv"
-    }
+void Database::loadFromFile(const std::string& csvFileName, const std::string& alias) {
+    // Without AS the CSV file name is used as the table name
+    std::string tableName = alias.empty() ? csvFileName.substr(0, csvFileName.find_last_of('.')) : alias; // Remove ".csv"
 
     if (csvFileName.empty() || tableName.empty()) {
         throw std::runtime_error("Syntax error in LOAD command. Table name or CSV file name is missing.");
@@ -121,30 +185,54 @@ void Database::loadFromFile(const std::string& command) {
     std::string line;
 
     // Read column headers
-    if (std::getline(ifs, line)) {
-        std::vector<std::string> columnHeaders = split(line, ',');
+    std::vector<std::string> columnHeaders;
+    if (readCsvRecord(ifs, columnHeaders)) {
         for (const auto& header : columnHeaders) {
-            Column column = {trim(header), DataType::VARCHAR}; // Default type: VARCHAR
-            table.columns.push_back(column);
+            Column column = {header, DataType::VARCHAR}; // Default type: VARCHAR
+            table.addColumn(column);
         }
     }
 
-    // Read rows
-    while (std::getline(ifs, line)) {
-        std::vector<std::string> rowValues = split(line, ',');
+    // Read rows (fields are unquoted and trimmed by readCsvRecord)
+    std::vector<std::string> rowValues;
+    while (readCsvRecord(ifs, rowValues)) {
         if (rowValues.size() != table.columns.size()) {
             throw std::runtime_error("Row data does not match column count in table '" + tableName + "'.");
         }
 
+        // The row's values point into rowValues until appendRow copies them
         Row row;
+        row.values.reserve(rowValues.size());
         for (const auto& value : rowValues) {
-            row.values.push_back(trim(value)); // Add trimmed values to the row
+            row.values.push_back(Value::string(value));
+        }
+        table.appendRow(row.values);
+    }
+
+    // Rebuild the indexes that were saved with the table (bulk loaded, not row by row)
+    std::ifstream indexFile(filepath + INDEX_FILE_SUFFIX);
+    while (indexFile && std::getline(indexFile, line)) {
+        std::vector<std::string> parts = split(line, ',');
+        if (parts.size() != 2 && parts.size() != 3) {
+            continue;
+        }
+        IndexKind kind = IndexKind::BTREE;
+        if (parts.size() == 3 && trim(parts[2]) == "BITMAP") kind = IndexKind::BITMAP;
+        if (parts.size() == 3 && trim(parts[2]) == "BLOOM") kind = IndexKind::BLOOM;
+        std::string indexName = trim(parts[0]);
+        int colIndex = table.findColumn(trim(parts[1]));
+        if (colIndex < 0 || findTableWithIndex(indexName) != nullptr || table.findIndex(colIndex, kind) != nullptr) {
+            fmt::print("Index '{}' could not be restored.\n", indexName);
+            continue;
         }
-        table.rows.push_back(row);
+        auto index = std::make_shared<TableIndex>(indexName, trim(parts[1]), colIndex, table.columns[colIndex].type, kind);
+        index->build(table.data[colIndex]);
+        table.indexes.push_back(std::move(index));
     }
 
     // Add the table to the database
-    tables[tableName] = table;
+    table.generation = nextGeneration++;
+    tables[tableName] = std::move(table);
 
     ifs.close();
     std::cout << "Table '" << tableName << "' loaded successfully from '" << filepath << "'." << std::endl;
@@ -3,6 +3,10 @@
 
 const std::string DATA_FOLDER = "./data";
 
+// SAVE writes the table's index definitions ("name,column[,BITMAP|BLOOM]" per line) next to the CSV file,
+// under the same name plus this suffix; LOAD rebuilds the indexes from it.
+const std::string INDEX_FILE_SUFFIX = ".idx";
+
 // Saves a table to a file in the "data" folder.
 void saveToFile(Database& db, const std::string& filename);
 
@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "filter_kernels.h"
+
+// ---------------------------------------------------------------------------------------
+// Scalar kernels (also used for the tail of every block)
+
+template <CompareOp OP, typename T>
+struct ComparePred {
+    T literal;
+    bool operator()(T value) const { return compareValues(value, literal, OP); }
+};
+
+// Floats: = and != use the same tolerance as evaluateCondition
+template <CompareOp OP>
+struct FloatPred {
+    float literal;
+    bool operator()(float value) const {
+        if constexpr (OP == CompareOp::EQ) return std::fabs(value - literal) <= kFloatEpsilon;
+        else if constexpr (OP == CompareOp::NE) return std::fabs(value - literal) > kFloatEpsilon;
+        else return compareValues(value, literal, OP);
+    }
+};
+
+template <typename T, typename Pred>
+static void scalarKernel(const T* values, size_t n, uint64_t* bits, Pred pred) {
+    for (size_t base = 0; base < n; base += 64) {
+        size_t count = std::min<size_t>(64, n - base);
+        uint64_t word = 0;
+        for (size_t j = 0; j < count; ++j) {
+            word |= static_cast<uint64_t>(pred(values[base + j])) << j;
+        }
+        bits[base / 64] = word;
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Vector kernels. Each one fills `words` full 64-bit words (64 values each);
+// the caller handles the remaining values with the scalar kernel.
+//
+// Integer and char compares only have == and >, so !=, <= and >= are computed
+// as the complement of ==, > and < over the whole word.
+
+#ifdef MINIDB_X86_SIMD
+
+constexpr bool isComplement(CompareOp op) {
+    return op == CompareOp::NE || op == CompareOp::LE || op == CompareOp::GE;
+}
+
+template <CompareOp OP>
+static void int32WordsSse2(const int32_t* values, size_t words, int32_t literal, uint64_t* bits) {
+    const __m128i lit = _mm_set1_epi32(literal);
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t word = 0;
+        for (int k = 0; k < 16; ++k) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + w * 64 + k * 4));
+            __m128i m;
+            if constexpr (OP == CompareOp::EQ || OP == CompareOp::NE) m = _mm_cmpeq_epi32(x, lit);
+            else if constexpr (OP == CompareOp::GT || OP == CompareOp::LE) m = _mm_cmpgt_epi32(x, lit);
+            else m = _mm_cmpgt_epi32(lit, x);
+            word |= static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(m))) << (k * 4);
+        }
+        bits[w] = isComplement(OP) ? ~word : word;
+    }
+}
+
+template <CompareOp OP>
+TARGET_AVX2 static void int32WordsAvx2(const int32_t* values, size_t words, int32_t literal, uint64_t* bits) {
+    const __m256i lit = _mm256_set1_epi32(literal);
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t word = 0;
+        for (int k = 0; k < 8; ++k) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + w * 64 + k * 8));
+            __m256i m;
+            if constexpr (OP == CompareOp::EQ || OP == CompareOp::NE) m = _mm256_cmpeq_epi32(x, lit);
+            else if constexpr (OP == CompareOp::GT || OP == CompareOp::LE) m = _mm256_cmpgt_epi32(x, lit);
+            else m = _mm256_cmpgt_epi32(lit, x);
+            word |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(m))) << (k * 8);
+        }
+        bits[w] = isComplement(OP) ? ~word : word;
+    }
+}
+
+template <CompareOp OP>
+static void charWordsSse2(const char* values, size_t words, char literal, uint64_t* bits) {
+    const __m128i lit = _mm_set1_epi8(literal);
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t word = 0;
+        for (int k = 0; k < 4; ++k) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + w * 64 + k * 16));
+            __m128i m;
+            if constexpr (OP == CompareOp::EQ || OP == CompareOp::NE) m = _mm_cmpeq_epi8(x, lit);
+            else if constexpr (OP == CompareOp::GT || OP == CompareOp::LE) m = _mm_cmpgt_epi8(x, lit);
+            else m = _mm_cmpgt_epi8(lit, x);
+            word |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(m))) << (k * 16);
+        }
+        bits[w] = isComplement(OP) ? ~word : word;
+    }
+}
+
+template <CompareOp OP>
+TARGET_AVX2 static void charWordsAvx2(const char* values, size_t words, char literal, uint64_t* bits) {
+    const __m256i lit = _mm256_set1_epi8(literal);
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t word = 0;
+        for (int k = 0; k < 2; ++k) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + w * 64 + k * 32));
+            __m256i m;
+            if constexpr (OP == CompareOp::EQ || OP == CompareOp::NE) m = _mm256_cmpeq_epi8(x, lit);
+            else if constexpr (OP == CompareOp::GT || OP == CompareOp::LE) m = _mm256_cmpgt_epi8(x, lit);
+            else m = _mm256_cmpgt_epi8(lit, x);
+            word |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(m))) << (k * 32);
+        }
+        bits[w] = isComplement(OP) ? ~word : word;
+    }
+}
+
+// Floats can't use the complement trick (NaN compares false both ways), every operator is explicit.
+template <CompareOp OP>
+static void floatWordsSse2(const float* values, size_t words, float literal, uint64_t* bits) {
+    const __m128 lit = _mm_set1_ps(literal);
+    const __m128 eps = _mm_set1_ps(kFloatEpsilon);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t word = 0;
+        for (int k = 0; k < 16; ++k) {
+            __m128 x = _mm_loadu_ps(values + w * 64 + k * 4);
+            __m128 m;
+            if constexpr (OP == CompareOp::EQ) m = _mm_cmple_ps(_mm_and_ps(_mm_sub_ps(x, lit), absMask), eps);
+            else if constexpr (OP == CompareOp::NE) m = _mm_cmpgt_ps(_mm_and_ps(_mm_sub_ps(x, lit), absMask), eps);
+            else if constexpr (OP == CompareOp::GT) m = _mm_cmpgt_ps(x, lit);
+            else if constexpr (OP == CompareOp::LT) m = _mm_cmplt_ps(x, lit);
+            else if constexpr (OP == CompareOp::GE) m = _mm_cmpge_ps(x, lit);
+            else m = _mm_cmple_ps(x, lit);
+            word |= static_cast<uint64_t>(_mm_movemask_ps(m)) << (k * 4);
+        }
+        bits[w] = word;
+    }
+}
+
+template <CompareOp OP>
+TARGET_AVX2 static void floatWordsAvx2(const float* values, size_t words, float literal, uint64_t* bits) {
+    const __m256 lit = _mm256_set1_ps(literal);
+    const __m256 eps = _mm256_set1_ps(kFloatEpsilon);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t word = 0;
+        for (int k = 0; k < 8; ++k) {
+            __m256 x = _mm256_loadu_ps(values + w * 64 + k * 8);
+            __m256 m;
+            if constexpr (OP == CompareOp::EQ) m = _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(x, lit), absMask), eps, _CMP_LE_OQ);
+            else if constexpr (OP == CompareOp::NE) m = _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(x, lit), absMask), eps, _CMP_GT_OQ);
+            else if constexpr (OP == CompareOp::GT) m = _mm256_cmp_ps(x, lit, _CMP_GT_OQ);
+            else if constexpr (OP == CompareOp::LT) m = _mm256_cmp_ps(x, lit, _CMP_LT_OQ);
+            else if constexpr (OP == CompareOp::GE) m = _mm256_cmp_ps(x, lit, _CMP_GE_OQ);
+            else m = _mm256_cmp_ps(x, lit, _CMP_LE_OQ);
+            word |= static_cast<uint64_t>(_mm256_movemask_ps(m)) << (k * 8);
+        }
+        bits[w] = word;
+    }
+}
+
+#endif
+
+// ---------------------------------------------------------------------------------------
+// Dispatch: full words go to the vector kernel for the active level, the tail to the scalar one.
+
+template <CompareOp OP>
+static void filterInt32Op(const int32_t* values, size_t n, int32_t literal, uint64_t* bits) {
+    size_t words = 0;
+#ifdef MINIDB_X86_SIMD
+    words = n / 64;
+    switch (activeSimdLevel()) {
+        case SimdLevel::AVX2: int32WordsAvx2<OP>(values, words, literal, bits); break;
+        case SimdLevel::SSE2: int32WordsSse2<OP>(values, words, literal, bits); break;
+        case SimdLevel::SCALAR: words = 0; break;
+    }
+#endif
+    scalarKernel(values + words * 64, n - words * 64, bits + words, ComparePred<OP, int32_t>{literal});
+}
+
+template <CompareOp OP>
+static void filterFloatOp(const float* values, size_t n, float literal, uint64_t* bits) {
+    size_t words = 0;
+#ifdef MINIDB_X86_SIMD
+    words = n / 64;
+    switch (activeSimdLevel()) {
+        case SimdLevel::AVX2: floatWordsAvx2<OP>(values, words, literal, bits); break;
+        case SimdLevel::SSE2: floatWordsSse2<OP>(values, words, literal, bits); break;
+        case SimdLevel::SCALAR: words = 0; break;
+    }
+#endif
+    scalarKernel(values + words * 64, n - words * 64, bits + words, FloatPred<OP>{literal});
+}
+
+template <CompareOp OP>
+static void filterCharOp(const char* values, size_t n, char literal, uint64_t* bits) {
+    size_t words = 0;
+#ifdef MINIDB_X86_SIMD
+    words = n / 64;
+    switch (activeSimdLevel()) {
+        case SimdLevel::AVX2: charWordsAvx2<OP>(values, words, literal, bits); break;
+        case SimdLevel::SSE2: charWordsSse2<OP>(values, words, literal, bits); break;
+        case SimdLevel::SCALAR: words = 0; break;
+    }
+#endif
+    scalarKernel(values + words * 64, n - words * 64, bits + words, ComparePred<OP, char>{literal});
+}
+
+// Picks the kernel instantiation for a runtime operator
+#define DISPATCH_COMPARE_OP(KERNEL, ...)                                       \
+    switch (op) {                                                              \
+        case CompareOp::EQ: KERNEL<CompareOp::EQ>(__VA_ARGS__); break;         \
+        case CompareOp::NE: KERNEL<CompareOp::NE>(__VA_ARGS__); break;         \
+        case CompareOp::GT: KERNEL<CompareOp::GT>(__VA_ARGS__); break;         \
+        case CompareOp::LT: KERNEL<CompareOp::LT>(__VA_ARGS__); break;         \
+        case CompareOp::GE: KERNEL<CompareOp::GE>(__VA_ARGS__); break;         \
+        case CompareOp::LE: KERNEL<CompareOp::LE>(__VA_ARGS__); break;         \
+    }
+
+void filterInt32(const int32_t* values, size_t n, CompareOp op, int32_t literal, uint64_t* bits) {
+    DISPATCH_COMPARE_OP(filterInt32Op, values, n, literal, bits)
+}
+
+void filterFloat(const float* values, size_t n, CompareOp op, float literal, uint64_t* bits) {
+    DISPATCH_COMPARE_OP(filterFloatOp, values, n, literal, bits)
+}
+
+void filterChar(const char* values, size_t n, CompareOp op, char literal, uint64_t* bits) {
+    DISPATCH_COMPARE_OP(filterCharOp, values, n, literal, bits)
+}
+
+#undef DISPATCH_COMPARE_OP
+
+// ---------------------------------------------------------------------------------------
+// IN lists: OR together one equality bitmap per literal
+
+template <typename T, typename EqKernel>
+static void filterIn(const T* values, size_t n, const std::vector<T>& literals, uint64_t* bits, EqKernel eqKernel) {
+    std::fill(bits, bits + (n + 63) / 64, 0);
+
+    uint64_t matches[kFilterBlockWords];
+    for (T literal : literals) {
+        eqKernel(values, n, CompareOp::EQ, literal, matches);
+        bitmapOr(bits, matches, n);
+    }
+}
+
+void filterInt32In(const int32_t* values, size_t n, const std::vector<int32_t>& literals, uint64_t* bits) {
+    filterIn(values, n, literals, bits, filterInt32);
+}
+
+void filterFloatIn(const float* values, size_t n, const std::vector<float>& literals, uint64_t* bits) {
+    filterIn(values, n, literals, bits, filterFloat);
+}
+
+void filterCharIn(const char* values, size_t n, const std::vector<char>& literals, uint64_t* bits) {
+    filterIn(values, n, literals, bits, filterChar);
+}
+
+// ---------------------------------------------------------------------------------------
+// Bitmap helpers
+
+void bitmapAnd(uint64_t* dst, const uint64_t* src, size_t n) {
+    for (size_t w = 0; w < (n + 63) / 64; ++w) dst[w] &= src[w];
+}
+
+void bitmapOr(uint64_t* dst, const uint64_t* src, size_t n) {
+    for (size_t w = 0; w < (n + 63) / 64; ++w) dst[w] |= src[w];
+}
+
+void bitmapNot(uint64_t* bits, size_t n) {
+    size_t words = (n + 63) / 64;
+    for (size_t w = 0; w < words; ++w) bits[w] = ~bits[w];
+    // Keep the bits past n cleared
+    if (n % 64 != 0) {
+        bits[words - 1] &= (uint64_t{1} << (n % 64)) - 1;
+    }
+}
+
+void bitmapSetRange(uint64_t* bits, size_t begin, size_t end) {
+    while (begin < end) {
+        size_t word = begin / 64;
+        size_t stop = std::min(end, (word + 1) * 64);
+        size_t length = stop - begin;
+        uint64_t mask = (length == 64) ? ~uint64_t{0} : ((uint64_t{1} << length) - 1);
+        bits[word] |= mask << (begin % 64);
+        begin = stop;
+    }
+}
+
+bool bitmapNone(const uint64_t* bits, size_t n) {
+    for (size_t w = 0; w < (n + 63) / 64; ++w) {
+        if (bits[w] != 0) return false;
+    }
+    return true;
+}
+
+bool bitmapAll(const uint64_t* bits, size_t n) {
+    size_t full = n / 64;
+    for (size_t w = 0; w < full; ++w) {
+        if (bits[w] != ~uint64_t{0}) return false;
+    }
+    if (n % 64 != 0) {
+        uint64_t mask = (uint64_t{1} << (n % 64)) - 1;
+        return (bits[full] & mask) == mask;
+    }
+    return true;
+}
+
+void bitmapToSelection(const uint64_t* bits, size_t n, uint32_t base, SelectionVector& out) {
+    for (size_t w = 0; w < (n + 63) / 64; ++w) {
+        uint64_t word = bits[w];
+        while (word != 0) {
+            // Lowest set bit -> row id, then clear it
+            out.push_back(base + static_cast<uint32_t>(w * 64 + std::countr_zero(word)));
+            word &= word - 1;
+        }
+    }
+}
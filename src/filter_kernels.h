@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "simd.h"
+#include "utils.h"
+
+// Filters are evaluated block by block: each kernel call handles at most this many values
+// and writes one bit per value, so the bitmaps of a block stay in L1 cache.
+constexpr size_t kFilterBlockSize = 2048;
+constexpr size_t kFilterBlockWords = kFilterBlockSize / 64;
+
+// IN lists up to this size are evaluated as a series of vectorized equality compares,
+// longer ones are probed in a hash set / bitmap (see in_list.h).
+constexpr size_t kSimdInListMax = 16;
+
+// FLOAT equality tolerance. 1e-6f is the largest float below 1e-6, so |a - b| < 1e-6 (as double)
+// is the same as |a - b| <= kFloatEpsilon, which lets the vector code compare in single precision.
+constexpr float kFloatEpsilon = 1e-6f;
+
+// Row ids that passed a filter, in ascending order
+using SelectionVector = std::vector<uint32_t>;
+
+// Comparison kernels.
+// Compare `n` values (n <= kFilterBlockSize) against a literal and set bit i of `bits`
+// for every value that matches. Bits past `n` in the last word are cleared.
+// FLOAT equality uses the same 1e-6 tolerance as the row-at-a-time evaluator.
+void filterInt32(const int32_t* values, size_t n, CompareOp op, int32_t literal, uint64_t* bits);
+void filterFloat(const float* values, size_t n, CompareOp op, float literal, uint64_t* bits);
+void filterChar(const char* values, size_t n, CompareOp op, char literal, uint64_t* bits);
+
+// IN-list kernels for short lists: bit i is set when values[i] equals any of the literals.
+void filterInt32In(const int32_t* values, size_t n, const std::vector<int32_t>& literals, uint64_t* bits);
+void filterFloatIn(const float* values, size_t n, const std::vector<float>& literals, uint64_t* bits);
+void filterCharIn(const char* values, size_t n, const std::vector<char>& literals, uint64_t* bits);
+
+// Bitmap helpers used to combine the results of several conditions.
+void bitmapAnd(uint64_t* dst, const uint64_t* src, size_t n);
+void bitmapOr(uint64_t* dst, const uint64_t* src, size_t n);
+void bitmapNot(uint64_t* bits, size_t n);
+void bitmapSetRange(uint64_t* bits, size_t begin, size_t end);   // sets bits [begin, end)
+bool bitmapNone(const uint64_t* bits, size_t n);
+bool bitmapAll(const uint64_t* bits, size_t n);
+
+// Appends base + i to `out` for every set bit i in the first `n` bits.
+void bitmapToSelection(const uint64_t* bits, size_t n, uint32_t base, SelectionVector& out);
@@ -0,0 +1,86 @@
+#include "heap_stats.h"
+
+#ifdef MINIDB_HEAP_STATS
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// The global allocation functions are replaced by malloc / free wrappers that add every request
+// to one relaxed atomic counter. Like the library versions they call the new_handler and retry
+// until it frees memory or gives up.
+
+static std::atomic<size_t> heapBytes{0};
+
+size_t heapBytesAllocated() {
+    return heapBytes.load(std::memory_order_relaxed);
+}
+
+static void* countedAllocate(size_t size, size_t alignment) {
+    size = std::max<size_t>(size, 1);
+    // aligned_alloc wants a size that is a multiple of the alignment
+    size_t alignedSize = (size + alignment - 1) / alignment * alignment;
+    while (true) {
+        void* p = alignment <= alignof(std::max_align_t) ? std::malloc(size) : std::aligned_alloc(alignment, alignedSize);
+        if (p != nullptr) {
+            heapBytes.fetch_add(size, std::memory_order_relaxed);
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+static void* countedAllocateNothrow(size_t size, size_t alignment) noexcept {
+    try {
+        return countedAllocate(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(size_t size) { return countedAllocate(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return countedAllocate(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment) {
+    return countedAllocate(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return countedAllocate(size, static_cast<size_t>(alignment));
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocateNothrow(size, alignof(std::max_align_t));
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocateNothrow(size, alignof(std::max_align_t));
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateNothrow(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateNothrow(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+#else
+
+size_t heapBytesAllocated() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+
+// Heap allocation counting for EXPLAIN ANALYZE's "allocated" column. It is opt-in at compile time
+// (cmake -DMINIDB_HEAP_STATS=ON): counting means replacing the global operator new / delete, so
+// every allocation anywhere in the process pays an atomic add on one shared counter. Regular
+// builds leave the allocator alone and EXPLAIN ANALYZE leaves the column empty.
+#ifdef MINIDB_HEAP_STATS
+constexpr bool kHeapStatsEnabled = true;
+#else
+constexpr bool kHeapStatsEnabled = false;
+#endif
+
+// Bytes requested from the heap by all threads since the program started; 0 without
+// MINIDB_HEAP_STATS. A stage's figure includes whatever other threads allocated meanwhile.
+size_t heapBytesAllocated();
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <functional>
+
+#include "in_list.h"
+
+// Smallest power of two that keeps the table at most half full
+static size_t tableCapacity(size_t count) {
+    size_t capacity = 16;
+    while (capacity < count * 2) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+IntInSet::IntInSet(const std::vector<int32_t>& values) {
+    if (values.empty()) {
+        return;
+    }
+
+    auto [minIt, maxIt] = std::minmax_element(values.begin(), values.end());
+    uint64_t span = static_cast<uint64_t>(static_cast<int64_t>(*maxIt) - *minIt) + 1;
+
+    // Dense domain: one bit per value in [min, max] as long as that's not much bigger than the list itself
+    if (span <= std::max<uint64_t>(64 * values.size(), 4096)) {
+        useBitmap = true;
+        minValue = *minIt;
+        range = span;
+        bitmap.assign((span + 63) / 64, 0);
+        for (int32_t value : values) {
+            uint64_t offset = static_cast<uint64_t>(static_cast<int64_t>(value) - minValue);
+            bitmap[offset / 64] |= uint64_t{1} << (offset % 64);
+        }
+        return;
+    }
+
+    size_t capacity = tableCapacity(values.size());
+    mask = capacity - 1;
+    shift = 64 - std::countr_zero(capacity);
+    slots.assign(capacity, 0);
+    used.assign(capacity, 0);
+    for (int32_t value : values) {
+        size_t slot = hashSlot(value);
+        while (used[slot] && slots[slot] != value) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = value;
+        used[slot] = 1;
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+FloatInSet::FloatInSet(const std::vector<float>& values) : sorted(values) {
+    std::sort(sorted.begin(), sorted.end());
+}
+
+bool FloatInSet::contains(float value) const {
+    // Only the literals around `value` can be within the tolerance
+    auto it = std::lower_bound(sorted.begin(), sorted.end(), value);
+    if (it != sorted.end() && std::fabs(value - *it) < 1e-6) return true;
+    if (it != sorted.begin() && std::fabs(value - *(it - 1)) < 1e-6) return true;
+    return false;
+}
+
+// ---------------------------------------------------------------------------------------
+CharInSet::CharInSet(const std::vector<char>& values) {
+    for (char value : values) {
+        uint8_t v = static_cast<uint8_t>(value);
+        bits[v / 64] |= uint64_t{1} << (v % 64);
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+StringInSet::StringInSet(const std::vector<std::string>& literals) {
+    size_t capacity = tableCapacity(literals.size());
+    mask = capacity - 1;
+    slots.assign(capacity, 0);
+    slotHashes.assign(capacity, 0);
+
+    for (const auto& literal : literals) {
+        size_t hash = std::hash<std::string_view>{}(literal);
+        size_t slot = hash & mask;
+        bool duplicate = false;
+        while (slots[slot] != 0) {
+            if (slotHashes[slot] == hash && values[slots[slot] - 1] == literal) {
+                duplicate = true;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+        if (!duplicate) {
+            values.push_back(literal);
+            slots[slot] = static_cast<uint32_t>(values.size());
+            slotHashes[slot] = hash;
+        }
+    }
+}
+
+bool StringInSet::contains(std::string_view value) const {
+    if (values.empty()) {
+        return false;
+    }
+    size_t hash = std::hash<std::string_view>{}(value);
+    for (size_t slot = hash & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+        if (slotHashes[slot] == hash && values[slots[slot] - 1] == value) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Membership sets for IN lists.
+// They are built once when a WHERE clause is bound (literals already converted to the column type),
+// so testing a row is a single probe instead of a scan over the list.
+
+// INTEGER and DATE: a bitmap over [min, max] when the values are dense enough, an open-addressing hash set otherwise.
+class IntInSet {
+public:
+    IntInSet() = default;
+    explicit IntInSet(const std::vector<int32_t>& values);
+
+    bool contains(int32_t value) const {
+        if (useBitmap) {
+            uint64_t offset = static_cast<uint64_t>(static_cast<int64_t>(value) - minValue);
+            return offset < range && ((bitmap[offset / 64] >> (offset % 64)) & 1);
+        }
+        if (slots.empty()) return false;
+        for (size_t slot = hashSlot(value);; slot = (slot + 1) & mask) {
+            if (!used[slot]) return false;
+            if (slots[slot] == value) return true;
+        }
+    }
+
+private:
+    size_t hashSlot(int32_t value) const {
+        // Fibonacci hashing: multiply and keep the top bits
+        return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(value)) * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+
+    bool useBitmap = false;
+    int64_t minValue = 0;
+    uint64_t range = 0;              // number of bits in the bitmap
+    std::vector<uint64_t> bitmap;
+
+    std::vector<int32_t> slots;      // hash set, linear probing
+    std::vector<uint8_t> used;
+    size_t mask = 0;
+    int shift = 64;
+};
+
+// FLOAT: sorted array searched with the same 1e-6 tolerance as '='.
+class FloatInSet {
+public:
+    FloatInSet() = default;
+    explicit FloatInSet(const std::vector<float>& values);
+
+    bool contains(float value) const;
+
+private:
+    std::vector<float> sorted;
+};
+
+// CHAR: one bit per possible char value.
+class CharInSet {
+public:
+    CharInSet() = default;
+    explicit CharInSet(const std::vector<char>& values);
+
+    bool contains(char value) const {
+        uint8_t v = static_cast<uint8_t>(value);
+        return (bits[v / 64] >> (v % 64)) & 1;
+    }
+
+private:
+    uint64_t bits[4] = {0, 0, 0, 0};
+};
+
+// VARCHAR: open-addressing hash set over the literal strings.
+class StringInSet {
+public:
+    StringInSet() = default;
+    explicit StringInSet(const std::vector<std::string>& values);
+
+    bool contains(std::string_view value) const;
+
+private:
+    std::vector<std::string> values;     // distinct literals
+    std::vector<uint32_t> slots;         // index + 1 into `values`, 0 = empty
+    std::vector<size_t> slotHashes;
+    size_t mask = 0;
+};
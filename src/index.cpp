@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <type_traits>
+
+#include "index.h"
+#include "condition.h"
+
+const char* indexKindName(IndexKind kind) {
+    switch (kind) {
+        case IndexKind::BTREE:  return "B+tree";
+        case IndexKind::BITMAP: return "bitmap";
+        case IndexKind::BLOOM:  return "bloom";
+    }
+    return "unknown";
+}
+
+TableIndex::TableIndex(std::string name, std::string columnName, size_t columnIndex, DataType type, IndexKind kind)
+    : indexName(std::move(name)), column(std::move(columnName)), colIndex(columnIndex), type(type), indexKind(kind) {
+    if (kind == IndexKind::BLOOM) {
+        tree.emplace<std::vector<BlockedBloomFilter>>();
+        return;
+    }
+    if (kind == IndexKind::BITMAP) {
+        if (type == DataType::CHAR) tree.emplace<BitmapValues<char>>();
+        else tree.emplace<BitmapValues<std::string>>();
+        return;
+    }
+    switch (type) {
+        case DataType::INTEGER:
+        case DataType::DATE:    tree.emplace<BPlusTree<int32_t>>(); break;
+        case DataType::FLOAT:   tree.emplace<BPlusTree<float>>(); break;
+        case DataType::CHAR:    tree.emplace<BPlusTree<char>>(); break;
+        case DataType::VARCHAR: tree.emplace<BPlusTree<std::string>>(); break;
+    }
+}
+
+// Sorts (value, row) pairs of the whole column and bulk loads them
+template <typename Key, typename ValueAt>
+static void buildTree(BPlusTree<Key>& tree, size_t rowCount, ValueAt valueAt) {
+    std::vector<std::pair<Key, uint32_t>> entries;
+    entries.reserve(rowCount);
+    for (size_t r = 0; r < rowCount; ++r) {
+        entries.emplace_back(valueAt(r), static_cast<uint32_t>(r));
+    }
+    std::sort(entries.begin(), entries.end());
+    tree.bulkLoad(entries);
+}
+
+void TableIndex::build(const ColumnData& data) {
+    size_t rowCount = data.size();
+    indexedRows = rowCount;
+    if (indexKind != IndexKind::BTREE) {
+        // Bitmap and bloom indexes are filled row by row, in order (bitmaps only see appends)
+        std::visit([](auto& t) { t.clear(); }, tree);
+        for (size_t r = 0; r < rowCount; ++r) {
+            insert(data, static_cast<uint32_t>(r));
+        }
+        return;
+    }
+    switch (type) {
+        case DataType::INTEGER:
+        case DataType::DATE:
+            buildTree(std::get<BPlusTree<int32_t>>(tree), rowCount, [&](size_t r) { return data.intAt(r); });
+            break;
+        case DataType::FLOAT:
+            buildTree(std::get<BPlusTree<float>>(tree), rowCount, [&](size_t r) { return data.floatAt(r); });
+            break;
+        case DataType::CHAR:
+            buildTree(std::get<BPlusTree<char>>(tree), rowCount, [&](size_t r) { return data.charAt(r); });
+            break;
+        case DataType::VARCHAR:
+            buildTree(std::get<BPlusTree<std::string>>(tree), rowCount,
+                      [&](size_t r) { return std::string(data.stringAt(r)); });
+            break;
+    }
+}
+
+void TableIndex::insert(const ColumnData& data, uint32_t row) {
+    indexedRows = std::max<size_t>(indexedRows, row + 1);
+    if (indexKind == IndexKind::BLOOM) {
+        auto& filters = std::get<std::vector<BlockedBloomFilter>>(tree);
+        size_t group = row / kRowGroupSize;
+        while (filters.size() <= group) {
+            filters.emplace_back(kBloomBlocksPerGroup);
+        }
+        filters[group].add(type == DataType::DATE ? bloomHash(data.intAt(row)) : bloomHash(data.stringAt(row)));
+        return;
+    }
+    if (indexKind == IndexKind::BITMAP) {
+        if (type == DataType::CHAR) {
+            std::get<BitmapValues<char>>(tree)[data.charAt(row)].add(row);
+        } else {
+            auto& values = std::get<BitmapValues<std::string>>(tree);
+            std::string_view value = data.stringAt(row);
+            auto it = values.find(value);
+            if (it == values.end()) {
+                it = values.emplace(std::string(value), RoaringBitmap{}).first;
+            }
+            it->second.add(row);
+        }
+        return;
+    }
+    switch (type) {
+        case DataType::INTEGER:
+        case DataType::DATE:    std::get<BPlusTree<int32_t>>(tree).insert(data.intAt(row), row); break;
+        case DataType::FLOAT:   std::get<BPlusTree<float>>(tree).insert(data.floatAt(row), row); break;
+        case DataType::CHAR:    std::get<BPlusTree<char>>(tree).insert(data.charAt(row), row); break;
+        case DataType::VARCHAR:
+            std::get<BPlusTree<std::string>>(tree).insert(std::string(data.stringAt(row)), row);
+            break;
+    }
+}
+
+bool TableIndex::canAnswer(const BoundCondition& cond) const {
+    switch (indexKind) {
+        case IndexKind::BTREE:  return !cond.negate && (cond.isIn || cond.op != CompareOp::NE);
+        case IndexKind::BITMAP: return true;
+        case IndexKind::BLOOM:  return false;
+    }
+    return false;
+}
+
+// Appends the rows with a key in the range to `rows`; false once more than maxRows are collected
+template <typename Key>
+static bool scanRange(const BPlusTree<Key>& tree, const Key* lo, bool loInclusive, const Key* hi, bool hiInclusive,
+                      size_t maxRows, std::vector<uint32_t>& rows) {
+    bool withinLimit = true;
+    tree.scan(lo, loInclusive, hi, hiInclusive, [&](uint32_t row) {
+        if (rows.size() >= maxRows) {
+            withinLimit = false;
+            return false;
+        }
+        rows.push_back(row);
+        return true;
+    });
+    return withinLimit;
+}
+
+// One comparison against a literal as a key range
+template <typename Key>
+static bool lookupCompare(const BPlusTree<Key>& tree, CompareOp op, const Key& value,
+                          size_t maxRows, std::vector<uint32_t>& rows) {
+    switch (op) {
+        case CompareOp::EQ: return scanRange<Key>(tree, &value, true, &value, true, maxRows, rows);
+        case CompareOp::LT: return scanRange<Key>(tree, nullptr, false, &value, false, maxRows, rows);
+        case CompareOp::LE: return scanRange<Key>(tree, nullptr, false, &value, true, maxRows, rows);
+        case CompareOp::GT: return scanRange<Key>(tree, &value, false, nullptr, false, maxRows, rows);
+        case CompareOp::GE: return scanRange<Key>(tree, &value, true, nullptr, false, maxRows, rows);
+        case CompareOp::NE: break;
+    }
+    return false;
+}
+
+// FLOAT equality matches within kFloatEpsilon, so it becomes a small range (a bit wider, to be safe)
+static bool lookupFloat(const BPlusTree<float>& tree, CompareOp op, float value,
+                        size_t maxRows, std::vector<uint32_t>& rows) {
+    if (op != CompareOp::EQ) {
+        return lookupCompare(tree, op, value, maxRows, rows);
+    }
+    float lo = value - 2 * kFloatEpsilon;
+    float hi = value + 2 * kFloatEpsilon;
+    return scanRange(tree, &lo, true, &hi, true, maxRows, rows);
+}
+
+bool TableIndex::lookup(const BoundCondition& cond, size_t maxRows, std::vector<uint32_t>& rows) const {
+    if (!canAnswer(cond)) {
+        return false;
+    }
+    if (indexKind == IndexKind::BITMAP) {
+        RoaringBitmap matches = matchBitmap(cond, indexedRows);
+        if (matches.cardinality() > maxRows) {
+            return false;
+        }
+        matches.toVector(rows);
+        return true;
+    }
+
+    switch (type) {
+        case DataType::INTEGER:
+        case DataType::DATE: {
+            const auto& intTree = std::get<BPlusTree<int32_t>>(tree);
+            if (!cond.isIn) return lookupCompare(intTree, cond.op, cond.intValue, maxRows, rows);
+            for (int32_t value : cond.intValues) {
+                if (!lookupCompare(intTree, CompareOp::EQ, value, maxRows, rows)) return false;
+            }
+            return true;
+        }
+        case DataType::FLOAT: {
+            const auto& floatTree = std::get<BPlusTree<float>>(tree);
+            if (!cond.isIn) return lookupFloat(floatTree, cond.op, cond.floatValue, maxRows, rows);
+            for (float value : cond.floatValues) {
+                if (!lookupFloat(floatTree, CompareOp::EQ, value, maxRows, rows)) return false;
+            }
+            return true;
+        }
+        case DataType::CHAR: {
+            const auto& charTree = std::get<BPlusTree<char>>(tree);
+            if (!cond.isIn) return lookupCompare(charTree, cond.op, cond.charValue, maxRows, rows);
+            for (char value : cond.charValues) {
+                if (!lookupCompare(charTree, CompareOp::EQ, value, maxRows, rows)) return false;
+            }
+            return true;
+        }
+        case DataType::VARCHAR: {
+            const auto& stringTree = std::get<BPlusTree<std::string>>(tree);
+            if (!cond.isIn) return lookupCompare(stringTree, cond.op, cond.stringValue, maxRows, rows);
+            for (const auto& value : cond.stringValues) {
+                if (!lookupCompare(stringTree, CompareOp::EQ, value, maxRows, rows)) return false;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// Union of the bitmaps of every distinct value that passes the (non-negated) condition.
+// Equality and IN go straight to their values, other comparisons walk the distinct values.
+template <typename Key, typename Literal>
+static RoaringBitmap matchValues(const BitmapValues<Key>& values, const BoundCondition& cond,
+                                 const Literal& literal, const std::vector<Key>& inValues) {
+    RoaringBitmap result;
+    auto addValue = [&](const auto& value) {
+        auto it = values.find(value);
+        if (it != values.end()) result = RoaringBitmap::orOf(result, it->second);
+    };
+
+    if (cond.isIn) {
+        for (const auto& value : inValues) addValue(value);
+    } else if (cond.op == CompareOp::EQ) {
+        addValue(literal);
+    } else {
+        for (const auto& [value, rows] : values) {
+            if (compareValues<Literal>(value, literal, cond.op)) result = RoaringBitmap::orOf(result, rows);
+        }
+    }
+    return result;
+}
+
+RoaringBitmap TableIndex::matchBitmap(const BoundCondition& cond, size_t rowCount) const {
+    RoaringBitmap result;
+    if (type == DataType::CHAR) {
+        result = matchValues(std::get<BitmapValues<char>>(tree), cond, cond.charValue, cond.charValues);
+    } else {
+        result = matchValues(std::get<BitmapValues<std::string>>(tree), cond,
+                             std::string_view(cond.stringValue), cond.stringValues);
+    }
+    return cond.negate ? result.complement(static_cast<uint32_t>(rowCount)) : result;
+}
+
+bool TableIndex::groupMayContain(size_t group, const std::vector<uint64_t>& hashes) const {
+    const auto& filters = std::get<std::vector<BlockedBloomFilter>>(tree);
+    if (group >= filters.size()) {
+        return true;
+    }
+    for (uint64_t hash : hashes) {
+        if (filters[group].mayContain(hash)) return true;
+    }
+    return false;
+}
+
+size_t TableIndex::memoryUsage() const {
+    return std::visit([](const auto& t) {
+        using Tree = std::decay_t<decltype(t)>;
+        if constexpr (std::is_same_v<Tree, BitmapValues<char>> || std::is_same_v<Tree, BitmapValues<std::string>>) {
+            size_t bytes = 0;
+            for (const auto& [value, rows] : t) bytes += sizeof(value) + rows.memoryUsage();
+            return bytes;
+        } else if constexpr (std::is_same_v<Tree, std::vector<BlockedBloomFilter>>) {
+            size_t bytes = t.capacity() * sizeof(BlockedBloomFilter);
+            for (const auto& filter : t) bytes += filter.memoryUsage();
+            return bytes;
+        } else {
+            return t.memoryUsage();
+        }
+    }, tree);
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <functional>
+#include <map>
+#include <string>
+#include <variant>
+
+#include "bloom.h"
+#include "btree.h"
+#include "roaring.h"
+#include "storage.h"
+
+struct BoundCondition;
+
+// An index is only used when the lookup returns at most this fraction of the table;
+// past that a vectorized scan is cheaper than sorting and re-checking the row ids.
+constexpr double kIndexMaxSelectivity = 0.1;
+
+enum class IndexKind {
+    BTREE,      // CREATE INDEX: ordered, for selective lookups and ranges
+    BITMAP,     // CREATE BITMAP INDEX: one compressed bitmap per distinct value, for low-cardinality columns
+    BLOOM       // CREATE BLOOM INDEX: a Bloom filter per row group, lets scans skip groups on = / IN
+};
+
+// Name of the index kind for messages ("B+tree", "bitmap", "bloom")
+const char* indexKindName(IndexKind kind);
+
+// Bloom filter size per row group: 8 bits per row
+constexpr size_t kBloomBlocksPerGroup = kRowGroupSize * 8 / 256;
+
+// Distinct values of a bitmap index with the rows holding each of them
+template <typename Key>
+using BitmapValues = std::map<Key, RoaringBitmap, std::less<>>;
+
+// Secondary index on one column.
+// A B+tree index is keyed on the column's native type (int32 for INTEGER and DATE, float, char,
+// string for VARCHAR) with row ids as payload.
+// A bitmap index (CHAR and VARCHAR only) keeps a roaring bitmap of row ids per distinct value,
+// so any condition on the column - including !=, NOT and NOT IN - is a union of a few bitmaps,
+// and conditions on several bitmap-indexed columns combine with bitmap AND/OR.
+// A bloom index (VARCHAR and DATE) keeps one Bloom filter per row group; it can't produce rows,
+// it only tells a scan that a group holds none of the values an = or IN condition looks for.
+// A column can have one index of each kind.
+class TableIndex {
+public:
+    TableIndex(std::string name, std::string columnName, size_t columnIndex, DataType type,
+               IndexKind kind = IndexKind::BTREE);
+
+    const std::string& name() const { return indexName; }
+    const std::string& columnName() const { return column; }
+    size_t columnIndex() const { return colIndex; }
+    IndexKind kind() const { return indexKind; }
+
+    // Bitmap indexes only make sense for a handful of distinct values
+    static bool supportsBitmap(DataType type) { return type == DataType::CHAR || type == DataType::VARCHAR; }
+    // Bloom filters pay off where comparing values is expensive: strings
+    static bool supportsBloom(DataType type) { return type == DataType::VARCHAR || type == DataType::DATE; }
+
+    // Rebuilds the tree from every value of the column (sorted, then bulk loaded)
+    void build(const ColumnData& data);
+
+    // Adds row `row` of the column; called after the row has been appended
+    void insert(const ColumnData& data, uint32_t row);
+
+    // Returns true if the index can answer this condition.
+    // A B+tree answers =, <, >, <=, >= and IN (not negated); a bitmap index answers anything;
+    // a bloom index answers nothing (see groupMayContain).
+    bool canAnswer(const BoundCondition& cond) const;
+
+    // Collects the ids of the rows that may satisfy `cond` (a condition on this column) into `rows`,
+    // unsorted. FLOAT equality returns a slightly wider range, so callers re-check the condition.
+    // Stops and returns false as soon as more than `maxRows` rows match.
+    bool lookup(const BoundCondition& cond, size_t maxRows, std::vector<uint32_t>& rows) const;
+
+    // Bitmap indexes: the exact set of rows (out of rowCount) that satisfy `cond`
+    RoaringBitmap matchBitmap(const BoundCondition& cond, size_t rowCount) const;
+
+    // Bloom indexes: false if no row of row group `group` holds a value with one of these
+    // hashes (see bloomHash)
+    bool groupMayContain(size_t group, const std::vector<uint64_t>& hashes) const;
+
+    size_t memoryUsage() const;
+
+private:
+    std::string indexName;
+    std::string column;
+    size_t colIndex;
+    DataType type;
+    IndexKind indexKind;
+    size_t indexedRows = 0;     // rows of the column covered so far (NOT needs the full row range)
+    std::variant<BPlusTree<int32_t>, BPlusTree<float>, BPlusTree<char>, BPlusTree<std::string>,
+                 BitmapValues<char>, BitmapValues<std::string>,
+                 std::vector<BlockedBloomFilter>> tree;      // bloom: one filter per row group
+};
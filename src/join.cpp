@@ -0,0 +1,328 @@
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+#include "join.h"
+#include "sort.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+// ---------------------------------------------------------------------------------------
+// Binding
+
+// Splits "users.id" into ("users", "id"); an unqualified name gives an empty table part
+static void splitQualifiedName(std::string_view name, std::string_view& table, std::string_view& column) {
+    std::size_t dot = name.find('.');
+    if (dot == std::string_view::npos) {
+        table = {};
+        column = name;
+        return;
+    }
+    table = name.substr(0, dot);
+    column = name.substr(dot + 1);
+}
+
+static const Table& findJoinTable(const TableMap& tables, std::string_view name) {
+    auto it = tables.find(name);
+    if (it == tables.end()) {
+        throw std::runtime_error("Table '" + std::string(name) + "' does not exist.");
+    }
+    return it->second;
+}
+
+JoinColumn resolveJoinColumn(const JoinQuery& query, std::string_view name) {
+    std::string_view tableName, columnName;
+    splitQualifiedName(name, tableName, columnName);
+
+    int leftIndex = (tableName.empty() || tableName == query.left->name) ? query.left->findColumn(columnName) : -1;
+    int rightIndex = (tableName.empty() || tableName == query.right->name) ? query.right->findColumn(columnName) : -1;
+
+    if (leftIndex >= 0 && rightIndex >= 0) {
+        throw std::runtime_error("Column '" + std::string(columnName) + "' is ambiguous, write it as table.column.");
+    }
+    if (leftIndex >= 0) {
+        return {JoinSide::LEFT, static_cast<size_t>(leftIndex), std::string(name)};
+    }
+    if (rightIndex >= 0) {
+        return {JoinSide::RIGHT, static_cast<size_t>(rightIndex), std::string(name)};
+    }
+    if (!tableName.empty() && tableName != query.left->name && tableName != query.right->name) {
+        throw std::runtime_error("Table '" + std::string(tableName) + "' is not part of the JOIN.");
+    }
+    throw std::runtime_error("Column '" + std::string(name) + "' not found in the joined tables.");
+}
+
+static const Table& sideTable(const JoinQuery& query, JoinSide side) {
+    return side == JoinSide::LEFT ? *query.left : *query.right;
+}
+
+JoinQuery bindJoinQuery(const TableMap& tables,
+                        const JoinClause& clause,
+                        const std::vector<SelectItem>& selectItems,
+                        const WhereClause& where) {
+    JoinQuery query;
+    query.left = &findJoinTable(tables, clause.leftTable);
+    query.right = &findJoinTable(tables, clause.rightTable);
+    if (query.left == query.right) {
+        throw std::runtime_error("Joining a table with itself is not supported.");
+    }
+
+    // 1) ON columns
+    int leftKey = query.left->findColumn(clause.leftKey);
+    if (leftKey < 0) {
+        throw std::runtime_error("Column '" + std::string(clause.leftKey) + "' not found in table '" +
+                                 query.left->name + "'.");
+    }
+    int rightKey = query.right->findColumn(clause.rightKey);
+    if (rightKey < 0) {
+        throw std::runtime_error("Column '" + std::string(clause.rightKey) + "' not found in table '" +
+                                 query.right->name + "'.");
+    }
+    query.leftKey = static_cast<size_t>(leftKey);
+    query.rightKey = static_cast<size_t>(rightKey);
+
+    DataType leftType = query.left->columns[query.leftKey].type;
+    DataType rightType = query.right->columns[query.rightKey].type;
+    if (leftType != rightType) {
+        throw std::runtime_error("JOIN columns '" + std::string(clause.leftKey) + "' and '" +
+                                 std::string(clause.rightKey) + "' have different types.");
+    }
+    if (leftType == DataType::FLOAT) {
+        throw std::runtime_error("JOIN on FLOAT columns is not supported.");
+    }
+
+    // 2) SELECT list
+    for (const auto& item : selectItems) {
+        if (item.column == "*") {
+            for (size_t i = 0; i < query.left->columns.size(); ++i) {
+                query.columns.push_back({JoinSide::LEFT, i, query.left->name + "." + query.left->columns[i].name});
+            }
+            for (size_t i = 0; i < query.right->columns.size(); ++i) {
+                query.columns.push_back({JoinSide::RIGHT, i, query.right->name + "." + query.right->columns[i].name});
+            }
+            continue;
+        }
+        query.columns.push_back(resolveJoinColumn(query, item.column));
+    }
+
+    // 3) WHERE: bind every condition against the table it refers to
+    if (where.empty()) {
+        return query;
+    }
+    std::vector<JoinSide> sides;
+    BoundPredicate bound = buildPredicate(where, [&](const Condition& cond) {
+        JoinColumn column = resolveJoinColumn(query, cond.column);
+        const Table& table = sideTable(query, column.side);
+        Condition local = cond;
+        local.column = table.columns[column.columnIndex].name;
+        sides.push_back(column.side);
+        return bindCondition(table, local);
+    });
+
+    // Push every operand of the top-level AND that only reads one table below the join: each side
+    // gets its own predicate, so filtered-out rows are neither hashed nor probed.
+    // The rest (e.g. "a.x = 1 OR b.y = 2") only makes sense on the joined row.
+    std::vector<PredicateNode> conjuncts;
+    if (bound.root.kind == PredicateNode::Kind::AND) {
+        conjuncts = bound.root.operands;
+    } else {
+        conjuncts.push_back(bound.root);
+    }
+    for (const auto& conjunct : conjuncts) {
+        std::vector<bool> readsSide(2, false);
+        std::function<void(const PredicateNode&)> collectSides = [&](const PredicateNode& node) {
+            if (node.kind == PredicateNode::Kind::CONDITION) {
+                readsSide[sides[node.condition] == JoinSide::LEFT ? 0 : 1] = true;
+            }
+            for (const auto& operand : node.operands) collectSides(operand);
+        };
+        collectSides(conjunct);
+
+        if (readsSide[0] && readsSide[1]) {
+            addConjunct(query.residual, bound, conjunct);
+            // addConjunct numbers the copied conditions in tree order; record their sides the same way
+            std::function<void(const PredicateNode&)> copySides = [&](const PredicateNode& node) {
+                if (node.kind == PredicateNode::Kind::CONDITION) query.residualSides.push_back(sides[node.condition]);
+                for (const auto& operand : node.operands) copySides(operand);
+            };
+            copySides(conjunct);
+        } else {
+            addConjunct(readsSide[0] ? query.leftFilter : query.rightFilter, bound, conjunct);
+        }
+    }
+    orderPredicate(query.leftFilter);
+    orderPredicate(query.rightFilter);
+    orderPredicate(query.residual);
+    query.hasLeftFilter = !query.leftFilter.empty();
+    query.hasRightFilter = !query.rightFilter.empty();
+    return query;
+}
+
+// ---------------------------------------------------------------------------------------
+// Hash join
+
+// Hash of the join key of one row. Integer keys use a multiplicative hash, strings std::hash.
+static uint64_t hashJoinKey(const ColumnData& column, uint32_t row) {
+    switch (column.type) {
+        case DataType::INTEGER:
+        case DataType::DATE:
+            return (static_cast<uint64_t>(static_cast<uint32_t>(column.intAt(row))) + 1) * 0x9E3779B97F4A7C15ull;
+        case DataType::CHAR:
+            return (static_cast<uint64_t>(static_cast<unsigned char>(column.charAt(row))) + 1) * 0x9E3779B97F4A7C15ull;
+        case DataType::VARCHAR:
+            return std::hash<std::string_view>{}(column.stringAt(row));
+        case DataType::FLOAT:
+            break;
+    }
+    return 0;
+}
+
+static bool joinKeysEqual(const ColumnData& a, uint32_t rowA, const ColumnData& b, uint32_t rowB) {
+    switch (a.type) {
+        case DataType::INTEGER:
+        case DataType::DATE:    return a.intAt(rowA) == b.intAt(rowB);
+        case DataType::CHAR:    return a.charAt(rowA) == b.charAt(rowB);
+        case DataType::VARCHAR: return a.stringAt(rowA) == b.stringAt(rowB);
+        case DataType::FLOAT:   break;
+    }
+    return false;
+}
+
+// Chained hash table over the join keys of the build side.
+// Only row ids and hashes are stored; keys are compared against the column itself.
+class JoinHashTable {
+public:
+    JoinHashTable(const ColumnData& keys, const SelectionVector& rows) : keys(keys) {
+        size_t bucketCount = 16;
+        while (bucketCount < rows.size() * 2) bucketCount *= 2;
+        mask = bucketCount - 1;
+        heads.assign(bucketCount, 0);
+        next.resize(rows.size());
+        entryRows = rows;
+        entryHashes.resize(rows.size());
+
+        // Inserted back to front so every chain lists its rows in ascending order
+        for (size_t i = rows.size(); i-- > 0;) {
+            uint64_t hash = hashJoinKey(keys, rows[i]);
+            size_t bucket = hash & mask;
+            entryHashes[i] = hash;
+            next[i] = heads[bucket];
+            heads[bucket] = static_cast<uint32_t>(i + 1);
+        }
+    }
+
+    // Calls match(buildRow) for every build row whose key equals probeKeys[probeRow]
+    template <typename Match>
+    void probe(const ColumnData& probeKeys, uint32_t probeRow, Match match) const {
+        uint64_t hash = hashJoinKey(probeKeys, probeRow);
+        for (uint32_t entry = heads[hash & mask]; entry != 0; entry = next[entry - 1]) {
+            size_t i = entry - 1;
+            if (entryHashes[i] == hash && joinKeysEqual(keys, entryRows[i], probeKeys, probeRow)) {
+                match(entryRows[i]);
+            }
+        }
+    }
+
+private:
+    const ColumnData& keys;
+    size_t mask = 0;
+    std::vector<uint32_t> heads;        // first entry + 1 of each bucket, 0 = empty
+    std::vector<uint32_t> next;         // next entry + 1 in the same bucket
+    std::vector<uint32_t> entryRows;
+    std::vector<uint64_t> entryHashes;
+};
+
+// Checks the WHERE conditions that couldn't be pushed down, each on the row of its own table
+static bool passesResidual(const JoinQuery& query, uint32_t leftRow, uint32_t rightRow) {
+    return evaluatePredicate(query.residual.root, [&](size_t c) {
+        JoinSide side = query.residualSides[c];
+        uint32_t row = (side == JoinSide::LEFT) ? leftRow : rightRow;
+        return evaluateCondition(sideTable(query, side), row, query.residual.conditions[c]);
+    });
+}
+
+JoinRows runHashJoin(const JoinQuery& query, int limit) {
+    // Build on the smaller table
+    bool buildLeft = query.left->size() < query.right->size();
+    const Table& buildTable = buildLeft ? *query.left : *query.right;
+    const Table& probeTable = buildLeft ? *query.right : *query.left;
+    const ColumnData& buildKeys = buildTable.data[buildLeft ? query.leftKey : query.rightKey];
+    const ColumnData& probeKeys = probeTable.data[buildLeft ? query.rightKey : query.leftKey];
+    const BoundPredicate& buildFilter = buildLeft ? query.leftFilter : query.rightFilter;
+    const BoundPredicate& probeFilter = buildLeft ? query.rightFilter : query.leftFilter;
+    bool hasBuildFilter = buildLeft ? query.hasLeftFilter : query.hasRightFilter;
+    bool hasProbeFilter = buildLeft ? query.hasRightFilter : query.hasLeftFilter;
+
+    SelectionVector buildRows = ScanPlan(buildTable, hasBuildFilter ? &buildFilter : nullptr).collect();
+
+    JoinRows result;
+    if (buildRows.empty()) {
+        return result;
+    }
+    JoinHashTable hashTable(buildKeys, buildRows);
+
+    // Probes one block of probe-side rows, appending the matching pairs to `out`
+    // until it holds `stopAfter` pairs
+    auto probeBlock = [&](const uint32_t* rowIds, size_t count, JoinRows& out, size_t stopAfter) {
+        for (size_t i = 0; i < count && out.size() < stopAfter; ++i) {
+            uint32_t probeRow = rowIds[i];
+            hashTable.probe(probeKeys, probeRow, [&](uint32_t buildRow) {
+                uint32_t leftRow = buildLeft ? buildRow : probeRow;
+                uint32_t rightRow = buildLeft ? probeRow : buildRow;
+                if (out.size() >= stopAfter) return;
+                if (!query.residual.empty() && !passesResidual(query, leftRow, rightRow)) return;
+                out.emplace_back(leftRow, rightRow);
+            });
+        }
+    };
+
+    ScanPlan probePlan(probeTable, hasProbeFilter ? &probeFilter : nullptr);
+    if (!buildLeft && limit >= 0) {
+        // The left table is probed, so the pairs already come out in (left, right) order
+        // and the probe can stop as soon as LIMIT pairs are found
+        size_t stopAfter = static_cast<size_t>(limit);
+        probePlan.runSerial([&](const uint32_t* rowIds, size_t count) {
+            probeBlock(rowIds, count, result, stopAfter);
+        });
+        return result;
+    }
+
+    // Probe morsels in parallel on the thread pool, each into its own output, concatenated in order
+    size_t noLimit = std::numeric_limits<size_t>::max();
+    std::vector<JoinRows> morselRows(probePlan.morselCount());
+    probePlan.run([&](size_t, size_t morsel, const uint32_t* rowIds, size_t count) {
+        probeBlock(rowIds, count, morselRows[morsel], noLimit);
+    });
+    for (auto& rows : morselRows) {
+        result.insert(result.end(), rows.begin(), rows.end());
+    }
+
+    if (buildLeft) {
+        // Probe order is by right row; the right rows of one left row stay ascending
+        std::stable_sort(result.begin(), result.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+    }
+    return result;
+}
+
+void sortJoinRows(const JoinQuery& query, JoinRows& rows, const std::vector<std::pair<SelectItem, bool>>& orderByColumns) {
+    // Each ORDER BY column is a single-key sort on one of the two tables
+    std::vector<std::pair<JoinSide, std::vector<SortKey>>> keys;
+    for (const auto& [item, isDesc] : orderByColumns) {
+        if (item.isCall()) {
+            throw std::runtime_error("Column '" + item.label() + "' not found in the joined tables.");
+        }
+        JoinColumn column = resolveJoinColumn(query, item.column);
+        keys.push_back({column.side, {SortKey{column.columnIndex, isDesc}}});
+    }
+
+    std::stable_sort(rows.begin(), rows.end(), [&](const auto& a, const auto& b) {
+        for (const auto& [side, key] : keys) {
+            int cmp = (side == JoinSide::LEFT) ? compareRows(*query.left, key, a.first, b.first)
+                                               : compareRows(*query.right, key, a.second, b.second);
+            if (cmp != 0) return cmp < 0;
+        }
+        return false;
+    });
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "database.h"
+#include "condition.h"
+
+// Which table a column of a join refers to
+enum class JoinSide { LEFT, RIGHT };
+
+// A column of the joined rows
+struct JoinColumn {
+    JoinSide side;
+    size_t columnIndex;
+    std::string label;          // header, e.g. "users.name"
+};
+
+// A join resolved against the tables
+struct JoinQuery {
+    const Table* left = nullptr;
+    const Table* right = nullptr;
+    size_t leftKey = 0;
+    size_t rightKey = 0;
+
+    std::vector<JoinColumn> columns;    // SELECT list (all columns of both tables for *)
+
+    // Operands of the top-level WHERE AND that read one table only, pushed below the join and
+    // applied while scanning that side
+    BoundPredicate leftFilter;
+    BoundPredicate rightFilter;
+    bool hasLeftFilter = false;
+    bool hasRightFilter = false;
+
+    // The other operands (e.g. an OR across both tables), checked on the joined rows;
+    // residualSides[c] is the table condition c of `residual` reads
+    BoundPredicate residual;
+    std::vector<JoinSide> residualSides;
+};
+
+// Resolves a join: the tables, the ON columns, the SELECT list and the WHERE conditions.
+// Columns may be written as "table.column" or just "column" when only one table has it.
+// Throws if a table or column doesn't exist, a column is ambiguous, or the key types differ.
+JoinQuery bindJoinQuery(const TableMap& tables,
+                        const JoinClause& clause,
+                        const std::vector<SelectItem>& selectItems,
+                        const WhereClause& where);
+
+// Resolves a "table.column" / "column" name against the joined tables.
+JoinColumn resolveJoinColumn(const JoinQuery& query, std::string_view name);
+
+// Pairs of (left row, right row) that make up the join result
+using JoinRows = std::vector<std::pair<uint32_t, uint32_t>>;
+
+// Runs an equi-join as a hash join.
+// The smaller table (by row count) is the build side: its filtered rows are hashed on the join key
+// into a chained hash table. The other table is scanned in morsels on the thread pool, through its
+// own filter, and every row probes the table, so only matching pairs are ever produced, never the
+// cross product.
+// Pairs come out ordered by left row, then right row. `limit` (-1 = none) stops the probe early
+// when that order allows it.
+JoinRows runHashJoin(const JoinQuery& query, int limit);
+
+// Sorts joined rows by ORDER BY columns (stable).
+void sortJoinRows(const JoinQuery& query, JoinRows& rows, const std::vector<std::pair<SelectItem, bool>>& orderByColumns);
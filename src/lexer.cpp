@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "lexer.h"
+#include "utils.h"
+
+bool Token::isKeyword(std::string_view keyword) const {
+    if (type != TokenType::IDENTIFIER || text.size() != keyword.size()) return false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (toUpperManual(text[i]) != keyword[i]) return false;
+    }
+    return true;
+}
+
+static bool isIdentifierStart(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Offset just past the string literal starting at `start` (an opening quote).
+// A doubled quote inside the literal stands for one quote character.
+static size_t skipString(std::string_view sql, size_t start, bool& hasEscapes) {
+    char quote = sql[start];
+    size_t i = start + 1;
+    while (i < sql.size()) {
+        if (sql[i] == quote) {
+            if (i + 1 < sql.size() && sql[i + 1] == quote) {
+                hasEscapes = true;
+                i += 2;
+                continue;
+            }
+            return i + 1;
+        }
+        ++i;
+    }
+    throw std::runtime_error("Syntax error: unterminated string starting at position " + std::to_string(start) + ".");
+}
+
+std::vector<Token> tokenize(std::string_view sql) {
+    std::vector<Token> tokens;
+    size_t i = 0;
+    while (true) {
+        while (i < sql.size() && isSpace(sql[i])) ++i;
+        Token token;
+        token.position = i;
+        if (i == sql.size()) {
+            token.end = i;
+            tokens.push_back(token);
+            return tokens;
+        }
+
+        char c = sql[i];
+        size_t end = i + 1;
+        if (isIdentifierStart(c)) {
+            token.type = TokenType::IDENTIFIER;
+            while (end < sql.size() && (isIdentifierStart(sql[end]) || isDigit(sql[end]) || sql[end] == '.')) ++end;
+        } else if (isDigit(c) || (c == '.' && i + 1 < sql.size() && isDigit(sql[i + 1]))) {
+            token.type = TokenType::NUMBER;
+            while (end < sql.size() && (isDigit(sql[end]) || sql[end] == '.')) ++end;
+        } else if (c == '\'' || c == '"') {
+            token.type = TokenType::STRING;
+            end = skipString(sql, i, token.hasEscapes);
+            token.text = sql.substr(i + 1, end - i - 2);
+        } else {
+            token.type = TokenType::SYMBOL;
+            if (i + 1 < sql.size()) {
+                std::string_view pair = sql.substr(i, 2);
+                if (pair == "!=" || pair == "<>" || pair == "<=" || pair == ">=") end = i + 2;
+            }
+        }
+        if (token.type != TokenType::STRING) {
+            token.text = sql.substr(i, end - i);
+        }
+        token.end = end;
+        tokens.push_back(token);
+        i = end;
+    }
+}
+
+std::string_view unescapeString(const Token& token, Arena& arena) {
+    if (!token.hasEscapes) {
+        return token.text;
+    }
+    char* result = static_cast<char*>(arena.allocate(token.text.size(), 1));
+    size_t length = 0;
+    for (size_t i = 0; i < token.text.size(); ++i) {
+        result[length++] = token.text[i];
+        if ((token.text[i] == '\'' || token.text[i] == '"') && i + 1 < token.text.size() &&
+            token.text[i + 1] == token.text[i]) {
+            ++i;
+        }
+    }
+    return std::string_view(result, length);
+}
+
+std::vector<std::string> splitStatements(std::string_view input) {
+    std::vector<std::string> statements;
+    size_t start = 0;
+    for (size_t i = 0; i <= input.size(); ++i) {
+        if (i < input.size() && (input[i] == '\'' || input[i] == '"')) {
+            // Skip the literal; an unterminated one runs to the end and is reported by the lexer
+            char quote = input[i];
+            for (++i; i < input.size(); ++i) {
+                if (input[i] != quote) continue;
+                if (i + 1 < input.size() && input[i + 1] == quote) { ++i; continue; }
+                break;
+            }
+            if (i < input.size()) continue;
+        }
+        if (i >= input.size() || input[i] == ';') {
+            std::string statement = trim(std::string(input.substr(start, std::min(i, input.size()) - start)));
+            if (!statement.empty()) {
+                statements.push_back(std::move(statement));
+            }
+            start = i + 1;
+        }
+    }
+    return statements;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"
+
+// Kinds of SQL tokens
+enum class TokenType {
+    IDENTIFIER,     // names and keywords: letters, digits, '_' and '.' (so "users.id" and "data.csv" are one token)
+    NUMBER,         // 42, 3.5 (a leading '-' is a separate SYMBOL token)
+    STRING,         // 'text' or "text"; `text` holds what is between the quotes
+    SYMBOL,         // ( ) , ; * = != <> < > <= >= ? and any other single character
+    END             // end of the input
+};
+
+// A token is a view into the command text; nothing is copied while lexing.
+struct Token {
+    TokenType type = TokenType::END;
+    std::string_view text;
+    size_t position = 0;        // offset of the token's first character (the opening quote of a string)
+    size_t end = 0;             // offset just past the token (past the closing quote)
+    bool hasEscapes = false;    // STRING containing a doubled quote ('it''s')
+
+    // Case-insensitive match of an IDENTIFIER, e.g. isKeyword("SELECT")
+    bool isKeyword(std::string_view keyword) const;
+    bool isSymbol(std::string_view symbol) const { return type == TokenType::SYMBOL && text == symbol; }
+};
+
+// Splits a command into tokens; the last token is always END.
+// Throws on a string literal that is not closed.
+std::vector<Token> tokenize(std::string_view sql);
+
+// The value of a STRING token with doubled quotes collapsed ('it''s' -> it's): the token's own
+// text when it has none, otherwise a copy written to `arena`
+std::string_view unescapeString(const Token& token, Arena& arena);
+
+// Splits a line into statements at ';', except inside string literals.
+// Statements are trimmed; empty ones are dropped.
+std::vector<std::string> splitStatements(std::string_view input);
@@ -6,6 +6,7 @@
 
 #include "database.h"
 #include "file_io.h"
+#include "lexer.h"
 #include "utils.h"
 
 // Function to clear terminal and reprint header
@@ -90,16 +91,10 @@ int main() {
             continue;
         }
 
-        std::vector<std::string> commands = split(input, ';');
-
-        for (auto& command : commands) {
-            command = trim(command);
-
-            // Skip empty commands
-            if (command.empty()) {
-                continue;
-            }
+        // Split at ';' outside string literals; statements come back trimmed and non-empty
+        std::vector<std::string> commands = splitStatements(input);
 
+        for (const auto& command : commands) {
             try {
                 fmt::print("\n"); // Add space before response
                 db.executeCommand(command);
@@ -0,0 +1,526 @@
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+
+#include "parser.h"
+#include "utils.h"
+
+namespace {
+
+// Aggregate functions, as SelectItem::function spells them whatever the case they were written in
+constexpr std::string_view kAggregateNames[] = {"COUNT", "SUM", "AVG", "MIN", "MAX"};
+
+// Recursive-descent parser: one method per grammar rule, each consuming tokens from `pos`.
+class Parser {
+public:
+    Parser(std::string_view sql, const std::vector<Token>& tokens, Arena& strings, bool allowParameters)
+        : sql(sql), tokens(tokens), strings(strings), allowParameters(allowParameters) {}
+
+    Statement parse() {
+        Statement statement;
+        const Token& first = peek();
+        command = first.text;
+
+        if (accept("SELECT")) {
+            command = "SELECT";
+            statement.kind = StatementKind::SELECT;
+            parseSelect(statement.select);
+        } else if (accept("PREPARE")) {
+            command = "PREPARE";
+            statement.kind = StatementKind::PREPARE;
+            statement.name = identifier("a statement name");
+            expect("AS");
+            expect("SELECT");
+            allowParameters = true;
+            parseSelect(statement.select);
+        } else if (accept("EXPLAIN")) {
+            command = "EXPLAIN";
+            statement.kind = StatementKind::EXPLAIN;
+            statement.analyze = accept("ANALYZE");
+            expect("SELECT");
+            parseSelect(statement.select);
+        } else if (accept("EXECUTE")) {
+            command = "EXECUTE";
+            statement.kind = StatementKind::EXECUTE;
+            statement.name = identifier("a statement name");
+            if (acceptSymbol("(") && !acceptSymbol(")")) {
+                do {
+                    statement.arguments.push_back(literal());
+                } while (acceptSymbol(","));
+                expectSymbol(")");
+            }
+        } else if (accept("DEALLOCATE")) {
+            command = "DEALLOCATE";
+            statement.kind = StatementKind::DEALLOCATE;
+            statement.name = identifier("a statement name");
+        } else if (accept("INSERT")) {
+            command = "INSERT INTO";
+            statement.kind = StatementKind::INSERT;
+            parseInsert(statement.insert);
+        } else if (accept("CREATE")) {
+            if (accept("TABLE")) {
+                command = "CREATE TABLE";
+                statement.kind = StatementKind::CREATE_TABLE;
+                parseCreateTable(statement.createTable);
+            } else {
+                command = "CREATE INDEX";
+                statement.kind = StatementKind::CREATE_INDEX;
+                parseCreateIndex(statement.createIndex);
+            }
+        } else if (accept("DROP")) {
+            if (accept("INDEX")) {
+                command = "DROP INDEX";
+                statement.kind = StatementKind::DROP_INDEX;
+            } else {
+                command = "DROP TABLE";
+                expect("TABLE");
+                statement.kind = StatementKind::DROP_TABLE;
+            }
+            statement.name = identifier("a name");
+        } else if (accept("SAVE")) {
+            command = "SAVE";
+            statement.kind = StatementKind::SAVE;
+            statement.name = identifier("a table name");
+            if (accept("AS")) statement.alias = rawText("a file name");
+        } else if (accept("LOAD")) {
+            command = "LOAD";
+            statement.kind = StatementKind::LOAD;
+            statement.name = rawText("a file name");
+            if (accept("AS")) statement.alias = identifier("a table name");
+        } else if (accept("DELETE")) {
+            command = "DELETE FILE";
+            expect("FILE");
+            statement.kind = StatementKind::DELETE_FILE;
+            statement.name = rawText("a file name");
+        } else if (accept("SET")) {
+            command = "SET";
+            expect("THREADS");
+            statement.kind = StatementKind::SET_THREADS;
+            statement.name = rawText("a thread count");
+        } else if (accept("SHOW")) {
+            command = "SHOW";
+            if (accept("MEMORY")) {
+                statement.kind = StatementKind::SHOW_MEMORY;
+            } else if (accept("PLANS")) {
+                statement.kind = StatementKind::SHOW_PLANS;
+            } else {
+                expect("STORAGE");
+                statement.kind = StatementKind::SHOW_STORAGE;
+                statement.name = identifier("a table name");
+            }
+        } else if (accept("LIST")) {
+            command = "LIST TABLES";
+            expect("TABLES");
+            statement.kind = StatementKind::LIST_TABLES;
+        } else {
+            throw std::runtime_error("Unknown command: " + std::string(first.text));
+        }
+
+        acceptSymbol(";");
+        if (peek().type != TokenType::END) {
+            fail("end of command");
+        }
+        return statement;
+    }
+
+private:
+    // ----- token helpers -----
+
+    const Token& peek(size_t ahead = 0) const {
+        return tokens[std::min(pos + ahead, tokens.size() - 1)];
+    }
+
+    const Token& next() {
+        const Token& token = peek();
+        if (pos < tokens.size() - 1) ++pos;
+        return token;
+    }
+
+    bool accept(std::string_view keyword) {
+        if (!peek().isKeyword(keyword)) return false;
+        ++pos;
+        return true;
+    }
+
+    bool acceptSymbol(std::string_view symbol) {
+        if (!peek().isSymbol(symbol)) return false;
+        ++pos;
+        return true;
+    }
+
+    void expect(std::string_view keyword) {
+        if (!accept(keyword)) fail("'" + std::string(keyword) + "'");
+    }
+
+    void expectSymbol(std::string_view symbol) {
+        if (!acceptSymbol(symbol)) fail("'" + std::string(symbol) + "'");
+    }
+
+    [[noreturn]] void fail(const std::string& expected) const {
+        const Token& token = peek();
+        std::string found = token.type == TokenType::END ? "end of command" : "'" + std::string(token.text) + "'";
+        throw std::runtime_error("Syntax error in " + std::string(command) + " command: expected " + expected +
+                                 " but found " + found + " at position " + std::to_string(token.position) + ".");
+    }
+
+    std::string_view identifier(const std::string& what) {
+        if (peek().type != TokenType::IDENTIFIER) fail(what);
+        return next().text;
+    }
+
+    // The command text from here up to AS, ';' or the end, as written (file names may contain
+    // characters that are not identifiers, such as '/' or '-')
+    std::string_view rawText(const std::string& what) {
+        size_t begin = pos;
+        while (peek().type != TokenType::END && !peek().isSymbol(";") && !peek().isKeyword("AS")) {
+            ++pos;
+        }
+        if (pos == begin) fail(what);
+        return sql.substr(tokens[begin].position, tokens[pos - 1].end - tokens[begin].position);
+    }
+
+    // The NUMBER token `digits`, preceded by `first` (its sign, or the token itself), converted
+    // once: as a FLOAT and truncated to an integer, the way INTEGER columns take it
+    Literal number(const Token& first, const Token& digits, bool negative) {
+        Literal value;
+        value.text = sql.substr(first.position, digits.end - first.position);
+        const char* begin = digits.text.data();
+        const char* end = begin + digits.text.size();
+        auto [floatEnd, floatError] = std::from_chars(begin, end, value.floatValue);
+        if (floatError == std::errc::result_out_of_range) {
+            throw std::runtime_error("Number " + std::string(value.text) + " is out of range at position " +
+                                     std::to_string(first.position) + ".");
+        }
+        if (floatError != std::errc() || floatEnd != end) {
+            throw std::runtime_error("Syntax error in " + std::string(command) + " command: invalid number '" +
+                                     std::string(digits.text) + "' at position " + std::to_string(digits.position) + ".");
+        }
+        const char* dot = std::find(begin, end, '.');
+        if (std::from_chars(begin, dot, value.intValue).ec == std::errc::result_out_of_range) {
+            value.intValue = std::numeric_limits<int64_t>::max();
+        }
+        if (negative) {
+            value.floatValue = -value.floatValue;
+            value.intValue = -value.intValue;
+        }
+        return value;
+    }
+
+    // A literal value: 'text', 42, -3.5 (and, as before, a bare word)
+    Literal literal() {
+        Literal value;
+        const Token& token = peek();
+        if (token.isSymbol("?") && allowParameters) {
+            next();
+            value.kind = Literal::Kind::PARAMETER;
+            value.text = token.text;
+        } else if (token.type == TokenType::STRING) {
+            value.kind = Literal::Kind::STRING;
+            value.text = unescapeString(next(), strings);
+        } else if (token.type == TokenType::NUMBER) {
+            value = number(token, next(), false);
+        } else if ((token.isSymbol("-") || token.isSymbol("+")) && peek(1).type == TokenType::NUMBER) {
+            bool negative = token.isSymbol("-");
+            next();
+            value = number(token, next(), negative);
+        } else if (token.type == TokenType::IDENTIFIER) {
+            value.kind = Literal::Kind::WORD;
+            value.text = next().text;
+        } else {
+            fail("a value");
+        }
+        return value;
+    }
+
+    // ----- statements -----
+
+    // SELECT items FROM table [[INNER] JOIN table ON a.x = b.y] [WHERE ...] [GROUP BY ...]
+    //        [ORDER BY ...] [LIMIT n]
+    void parseSelect(SelectStatement& select) {
+        selectParameters = &select.parameterCount;
+        do {
+            select.items.push_back(selectItem());
+        } while (acceptSymbol(","));
+
+        if (!accept("FROM")) {
+            throw std::runtime_error("Syntax error in SELECT command (missing 'FROM').");
+        }
+        select.table = identifier("a table name");
+        if (accept("INNER")) {
+            if (!peek().isKeyword("JOIN")) fail("'JOIN'");
+        }
+        if (accept("JOIN")) {
+            parseJoin(select);
+        }
+        if (accept("WHERE")) {
+            parseWhere(select.where);
+        }
+        if (accept("GROUP")) {
+            expect("BY");
+            do {
+                select.groupBy.push_back(identifier("a column name"));
+            } while (acceptSymbol(","));
+        }
+        if (accept("ORDER")) {
+            expect("BY");
+            do {
+                SelectItem item = selectItem();
+                bool isDesc = false;
+                if (accept("DESC")) {
+                    isDesc = true;
+                } else {
+                    accept("ASC");
+                }
+                select.orderBy.emplace_back(item, isDesc);
+            } while (acceptSymbol(","));
+        }
+        if (accept("LIMIT")) {
+            if (peek().isSymbol("-")) {
+                throw std::runtime_error("LIMIT value cannot be negative.");
+            }
+            if (peek().type != TokenType::NUMBER) fail("a row count");
+            const Token& count = next();
+            select.limit = static_cast<int>(std::min<int64_t>(number(count, count, false).intValue,
+                                                              std::numeric_limits<int>::max()));
+        }
+    }
+
+    // column, table.column, * or FUNCTION(column | *)
+    SelectItem selectItem() {
+        SelectItem item;
+        if (acceptSymbol("*")) {
+            item.column = "*";
+            return item;
+        }
+        const Token& nameToken = peek();
+        std::string_view name = identifier("a column name");
+        if (!acceptSymbol("(")) {
+            item.column = name;
+            return item;
+        }
+        item.function = name;
+        for (std::string_view aggregate : kAggregateNames) {
+            if (nameToken.isKeyword(aggregate)) item.function = aggregate;
+        }
+        item.column = acceptSymbol("*") ? "*" : identifier("a column name or '*'");
+        expectSymbol(")");
+        return item;
+    }
+
+    // ... JOIN right ON x = y; either side of '=' may name either table
+    void parseJoin(SelectStatement& select) {
+        JoinClause& clause = select.join;
+        select.hasJoin = true;
+        clause.leftTable = select.table;
+        clause.rightTable = identifier("a table name");
+        if (!accept("ON")) {
+            throw std::runtime_error("Syntax error in JOIN (missing 'ON').");
+        }
+        std::string_view first = identifier("a column name");
+        if (!acceptSymbol("=")) {
+            throw std::runtime_error("JOIN ... ON only supports an equality of two columns.");
+        }
+        std::string_view second = identifier("a column name");
+
+        auto splitName = [](std::string_view name, std::string_view& table, std::string_view& column) {
+            size_t dot = name.find('.');
+            table = dot == std::string_view::npos ? std::string_view() : name.substr(0, dot);
+            column = dot == std::string_view::npos ? name : name.substr(dot + 1);
+        };
+        std::string_view firstTable, firstColumn, secondTable, secondColumn;
+        splitName(first, firstTable, firstColumn);
+        splitName(second, secondTable, secondColumn);
+        if (firstTable == clause.rightTable && secondTable != clause.rightTable) {
+            std::swap(firstTable, secondTable);
+            std::swap(firstColumn, secondColumn);
+        }
+        if ((!firstTable.empty() && firstTable != clause.leftTable) ||
+            (!secondTable.empty() && secondTable != clause.rightTable)) {
+            throw std::runtime_error("JOIN ... ON must compare a column of '" + std::string(clause.leftTable) +
+                                     "' with a column of '" + std::string(clause.rightTable) + "'.");
+        }
+        clause.leftKey = firstColumn;
+        clause.rightKey = secondColumn;
+    }
+
+    // or_expr := and_expr {OR and_expr}
+    void parseWhere(WhereClause& where) {
+        where = binary(WhereClause::Kind::OR);
+    }
+
+    // and_expr := not_expr {AND not_expr}, or_expr := and_expr {OR and_expr}
+    WhereClause binary(WhereClause::Kind kind) {
+        bool isOr = kind == WhereClause::Kind::OR;
+        auto operand = [&]() { return isOr ? binary(WhereClause::Kind::AND) : unary(); };
+        WhereClause first = operand();
+        if (!peek().isKeyword(isOr ? "OR" : "AND")) {
+            return first;
+        }
+        WhereClause node;
+        node.kind = kind;
+        node.operands.push_back(std::move(first));
+        while (accept(isOr ? "OR" : "AND")) {
+            node.operands.push_back(operand());
+        }
+        return node;
+    }
+
+    // not_expr := NOT not_expr | ( or_expr ) | condition
+    WhereClause unary() {
+        if (accept("NOT")) {
+            WhereClause node;
+            node.kind = WhereClause::Kind::NOT;
+            node.operands.push_back(unary());
+            return node;
+        }
+        if (acceptSymbol("(")) {
+            WhereClause inner = binary(WhereClause::Kind::OR);
+            expectSymbol(")");
+            return inner;
+        }
+        WhereClause leaf;
+        leaf.kind = WhereClause::Kind::CONDITION;
+        leaf.condition = condition();
+        return leaf;
+    }
+
+    // column {= | != | <> | < | > | <= | >=} value
+    // column [NOT] IN (value, ...)
+    Condition condition() {
+        Condition cond;
+        cond.column = identifier("a column name");
+
+        if (peek().isKeyword("NOT") && peek(1).isKeyword("IN")) {
+            next();
+            cond.negate = !cond.negate;
+        }
+        if (accept("IN")) {
+            cond.op = "IN";
+            expectSymbol("(");
+            do {
+                if (peek().isSymbol("?") && allowParameters) {
+                    throw std::runtime_error("Parameters ('?') can only stand for a single comparison value, not in an IN list.");
+                }
+                cond.inValues.push_back(literal());
+            } while (acceptSymbol(","));
+            expectSymbol(")");
+            return cond;
+        }
+
+        const Token& op = peek();
+        if (op.isSymbol("=") || op.isSymbol("!=") || op.isSymbol("<") || op.isSymbol(">") ||
+            op.isSymbol("<=") || op.isSymbol(">=")) {
+            cond.op = op.text;
+        } else if (op.isSymbol("<>")) {
+            cond.op = "!=";
+        } else {
+            fail("a comparison operator");
+        }
+        next();
+        cond.value = literal();
+        if (cond.value.kind == Literal::Kind::PARAMETER) {
+            cond.parameter = static_cast<int>((*selectParameters)++);
+        }
+        return cond;
+    }
+
+    // INSERT INTO table VALUES (value, ...)
+    void parseInsert(InsertStatement& insert) {
+        expect("INTO");
+        insert.table = identifier("a table name");
+        expect("VALUES");
+        expectSymbol("(");
+        do {
+            insert.values.push_back(literal());
+        } while (acceptSymbol(","));
+        expectSymbol(")");
+    }
+
+    // CREATE TABLE table (column TYPE, ...)
+    void parseCreateTable(CreateTableStatement& create) {
+        create.table = identifier("a table name");
+        expectSymbol("(");
+        do {
+            ColumnDefinition column;
+            column.name = identifier("a column name");
+            column.type = identifier("a column type");
+            create.columns.push_back(column);
+        } while (acceptSymbol(","));
+        expectSymbol(")");
+    }
+
+    // CREATE [BITMAP | BLOOM] INDEX name ON table(column)
+    void parseCreateIndex(CreateIndexStatement& create) {
+        if (accept("BITMAP")) {
+            create.kind = "BITMAP";
+        } else if (accept("BLOOM")) {
+            create.kind = "BLOOM";
+        }
+        if (!accept("INDEX")) {
+            throw std::runtime_error("Syntax error in CREATE INDEX command. Expected: CREATE [BITMAP | BLOOM] INDEX name ON table(column)");
+        }
+        create.name = identifier("an index name");
+        expect("ON");
+        create.table = identifier("a table name");
+        expectSymbol("(");
+        create.column = identifier("a column name");
+        expectSymbol(")");
+    }
+
+    std::string_view sql;
+    const std::vector<Token>& tokens;
+    Arena& strings;         // unescaped string literals
+    size_t pos = 0;
+    std::string_view command;   // for error messages
+    bool allowParameters;   // '?' is a value (query of a prepared statement)
+    size_t* selectParameters = nullptr;     // '?' counter of the SELECT being parsed
+};
+
+} // namespace
+
+Statement parseStatement(std::string_view sql, Arena& strings, bool allowParameters) {
+    return parseStatement(sql, tokenize(sql), strings, allowParameters);
+}
+
+Statement parseStatement(std::string_view sql, const std::vector<Token>& tokens, Arena& strings,
+                         bool allowParameters) {
+    return Parser(sql, tokens, strings, allowParameters).parse();
+}
+
+// ---------------------------------------------------------------------------------------
+// Copying a SELECT out of the command text
+
+static void copyLiteral(Literal& literal, Arena& arena) {
+    literal.text = arena.copyString(literal.text);
+}
+
+static void copyItem(SelectItem& item, Arena& arena) {
+    item.function = arena.copyString(item.function);
+    item.column = arena.copyString(item.column);
+}
+
+static void copyWhere(WhereClause& where, Arena& arena) {
+    if (where.kind == WhereClause::Kind::CONDITION) {
+        Condition& cond = where.condition;
+        cond.column = arena.copyString(cond.column);
+        cond.op = arena.copyString(cond.op);
+        copyLiteral(cond.value, arena);
+        for (auto& value : cond.inValues) copyLiteral(value, arena);
+    }
+    for (auto& operand : where.operands) copyWhere(operand, arena);
+}
+
+SelectStatement copySelect(const SelectStatement& select, Arena& arena) {
+    SelectStatement copy = select;
+    for (auto& item : copy.items) copyItem(item, arena);
+    copy.table = arena.copyString(copy.table);
+    copy.join.leftTable = arena.copyString(copy.join.leftTable);
+    copy.join.rightTable = arena.copyString(copy.join.rightTable);
+    copy.join.leftKey = arena.copyString(copy.join.leftKey);
+    copy.join.rightKey = arena.copyString(copy.join.rightKey);
+    copyWhere(copy.where, arena);
+    for (auto& name : copy.groupBy) name = arena.copyString(name);
+    for (auto& [item, isDesc] : copy.orderBy) copyItem(item, arena);
+    return copy;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "arena.h"
+#include "lexer.h"
+
+// Syntax tree of the commands, built by a recursive-descent parser over the lexer's tokens.
+// Names and literals are views into the command text (keywords may be written in any case), so
+// the tree is only valid as long as that text; structures that outlive the command copy what they
+// keep (a bound SelectPlan copies its SelectStatement, see copySelect). Numbers are converted
+// once, by the parser.
+
+// A literal value
+struct Literal {
+    enum class Kind { NUMBER, STRING, WORD, PARAMETER };   // WORD: an unquoted name, accepted as text in WHERE
+                                                          // PARAMETER: '?' of a prepared statement
+    Kind kind = Kind::NUMBER;
+    std::string_view text;      // number as written (with its sign), string without quotes
+    int64_t intValue = 0;       // NUMBER: the value truncated to an integer (saturated past int64)
+    float floatValue = 0.0f;    // NUMBER: the value as a FLOAT
+};
+
+// One WHERE condition: column op value or column [NOT] IN (values)
+struct Condition {
+    std::string_view column;
+    std::string_view op;                // =, >, <, >=, <=, != or IN
+    Literal value;                      // single value if op != "IN"
+    std::vector<Literal> inValues;      // multiple values if op == "IN"
+    bool negate = false;        // NOT IN (or a NOT applied directly to the condition)
+    int parameter = -1;         // prepared statements: number of the '?' standing for `value` (0-based)
+};
+
+// WHERE clause as a boolean expression tree. NOT binds tighter than AND, AND tighter than OR,
+// and parentheses group: "a OR b AND NOT (c OR d)" is OR(a, AND(b, NOT(OR(c, d)))).
+// Chains of the same operator are one node with all their operands ("a AND b AND c").
+struct WhereClause {
+    enum class Kind { NONE, CONDITION, AND, OR, NOT };
+    Kind kind = Kind::NONE;             // NONE: the query has no WHERE clause
+    Condition condition;                // CONDITION
+    std::vector<WhereClause> operands;  // AND / OR: two or more, NOT: one
+
+    bool empty() const { return kind == Kind::NONE; }
+};
+
+// FROM part of a join: "a JOIN b ON a.x = b.y" (INNER JOIN is accepted too)
+struct JoinClause {
+    std::string_view leftTable;
+    std::string_view rightTable;
+    std::string_view leftKey;   // column of the left table in the ON condition
+    std::string_view rightKey;  // column of the right table
+};
+
+// An item of the SELECT list or of ORDER BY: a column ("name", "users.name", "*") or an aggregate call
+struct SelectItem {
+    std::string_view function;  // upper-case name of a known aggregate ("COUNT"), else as written;
+                                // empty for a plain column
+    std::string_view column;    // the column, or the call's argument ("*" in COUNT(*))
+
+    bool isCall() const { return !function.empty(); }
+    // How the item is written in result headers: "name", "COUNT(*)"
+    std::string label() const {
+        return isCall() ? std::string(function) + "(" + std::string(column) + ")" : std::string(column);
+    }
+};
+
+struct SelectStatement {
+    std::vector<SelectItem> items;
+    std::string_view table;
+    bool hasJoin = false;
+    JoinClause join;
+    WhereClause where;
+    std::vector<std::string_view> groupBy;
+    std::vector<std::pair<SelectItem, bool>> orderBy;   // (item, descending)
+    int limit = -1;                                     // -1: no LIMIT
+    size_t parameterCount = 0;                          // '?' slots (PREPARE only)
+};
+
+struct InsertStatement {
+    std::string_view table;
+    std::vector<Literal> values;
+};
+
+struct ColumnDefinition {
+    std::string_view name;
+    std::string_view type;      // as written; resolved by the database
+};
+
+struct CreateTableStatement {
+    std::string_view table;
+    std::vector<ColumnDefinition> columns;
+};
+
+struct CreateIndexStatement {
+    std::string_view kind;      // "" (B+tree), "BITMAP" or "BLOOM"
+    std::string_view name;
+    std::string_view table;
+    std::string_view column;
+};
+
+enum class StatementKind {
+    SELECT, INSERT, CREATE_TABLE, CREATE_INDEX, DROP_TABLE, DROP_INDEX,
+    SAVE, LOAD, DELETE_FILE, SET_THREADS, SHOW_STORAGE, SHOW_MEMORY, LIST_TABLES,
+    SHOW_PLANS, PREPARE, EXECUTE, DEALLOCATE, EXPLAIN
+};
+
+// A parsed command. Only the member matching `kind` is filled; the simple commands use
+// `name` (the table, index, file, thread count or prepared statement) and `alias` (the part after
+// AS of SAVE / LOAD). PREPARE name AS SELECT ... fills `select`, EXECUTE name(...) `arguments`,
+// EXPLAIN [ANALYZE] SELECT ... `select` and `analyze`.
+struct Statement {
+    StatementKind kind = StatementKind::SELECT;
+    SelectStatement select;
+    InsertStatement insert;
+    CreateTableStatement createTable;
+    CreateIndexStatement createIndex;
+    std::string_view name;
+    std::string_view alias;
+    std::vector<Literal> arguments;
+    bool analyze = false;       // EXPLAIN ANALYZE
+};
+
+// Parses one command (an optional trailing ';' is allowed). The statement points into `sql`; the
+// few string literals that need unescaping ('it''s') are written to `strings` instead, so both
+// have to outlive it.
+// Throws std::runtime_error with the position of the offending token on a syntax error.
+// '?' is only accepted as a comparison value of a SELECT when `allowParameters` is set
+// (the query of a prepared statement); PREPARE ... AS SELECT sets it for its query.
+Statement parseStatement(std::string_view sql, Arena& strings, bool allowParameters = false);
+
+// Same, over the tokens of `sql` the caller already has (tokenize(sql))
+Statement parseStatement(std::string_view sql, const std::vector<Token>& tokens, Arena& strings,
+                         bool allowParameters = false);
+
+// A copy of `select` whose names and literals live in `arena`, for a plan that outlives the command
+SelectStatement copySelect(const SelectStatement& select, Arena& arena);
@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <atomic>
+
+#include "pipeline.h"
+#include "date.h"
+#include "thread_pool.h"
+#include "heap_stats.h"
+#include "fmt/format.h"
+
+StatsScope::StatsScope(OperatorStats& stats)
+    : stats(stats), start(std::chrono::steady_clock::now()), heapStart(heapBytesAllocated()) {}
+
+StatsScope::~StatsScope() {
+    stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.bytesAllocated += heapBytesAllocated() - heapStart;
+}
+
+bool RowOperator::next(RowBatch& batch) {
+    StatsScope scope(operatorStats);
+    if (!produce(batch)) {
+        return false;
+    }
+    operatorStats.rowsOut += batch.size();
+    return true;
+}
+
+void RowOperator::drain(const MorselConsumer& consume) {
+    StatsScope scope(operatorStats);
+    std::atomic<size_t> rows{0};
+    produceAll([&](size_t worker, size_t morsel, const uint32_t* rowIds, size_t count) {
+        rows.fetch_add(count, std::memory_order_relaxed);
+        consume(worker, morsel, rowIds, count);
+    });
+    operatorStats.rowsOut += rows.load();
+}
+
+void RowOperator::produceAll(const MorselConsumer& consume) {
+    RowBatch batch;
+    while (produce(batch)) {
+        consume(0, 0, batch.data(), batch.size());
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Scan
+
+// Largest chunk a scan filters per next(): one morsel per worker
+static size_t maxChunkRows() {
+    return kMorselRows * ThreadPool::instance().threadCount();
+}
+
+ScanOperator::ScanOperator(const Table& table, const BoundPredicate* predicate, bool startSmall)
+    : plan(table, predicate), startSmall(startSmall), chunkRows(startSmall ? kRowGroupSize : maxChunkRows()) {}
+
+bool ScanOperator::produce(RowBatch& batch) {
+    size_t inputSize = plan.inputSize();
+    while (true) {
+        while (pendingIndex < pending.size() && pending[pendingIndex].empty()) {
+            ++pendingIndex;
+        }
+        if (pendingIndex < pending.size()) {
+            batch = std::move(pending[pendingIndex++]);
+            return true;
+        }
+        if (position >= inputSize) {
+            return false;
+        }
+
+        // Filter the next chunk, split into at most morsel-sized pieces run on the thread pool
+        size_t end = std::min(inputSize, position + chunkRows);
+        size_t pieceRows = std::min(chunkRows, kMorselRows);
+        size_t pieces = (end - position + pieceRows - 1) / pieceRows;
+        pending.assign(pieces, {});
+        pendingIndex = 0;
+        auto filterPiece = [&](size_t, size_t piece) {
+            size_t begin = position + piece * pieceRows;
+            plan.runRange(begin, std::min(end, begin + pieceRows), [&](const uint32_t* rowIds, size_t count) {
+                pending[piece].insert(pending[piece].end(), rowIds, rowIds + count);
+            });
+        };
+        if (pieces == 1) {
+            filterPiece(0, 0);
+        } else {
+            ThreadPool::instance().parallelFor(pieces, filterPiece);
+        }
+        position = end;
+        chunkRows = std::min(chunkRows * 2, std::max(chunkRows, maxChunkRows()));
+    }
+}
+
+void ScanOperator::produceAll(const MorselConsumer& consume) {
+    // What an earlier next() already filtered goes first
+    size_t morsel = 0;
+    for (; pendingIndex < pending.size(); ++pendingIndex, ++morsel) {
+        consume(0, morsel, pending[pendingIndex].data(), pending[pendingIndex].size());
+    }
+
+    size_t begin = position;
+    size_t inputSize = plan.inputSize();
+    size_t morsels = (begin < inputSize) ? ::morselCount(inputSize - begin) : 0;
+    ThreadPool::instance().parallelFor(morsels, [&](size_t worker, size_t m) {
+        size_t start = begin + m * kMorselRows;
+        plan.runRange(start, std::min(inputSize, start + kMorselRows), [&](const uint32_t* rowIds, size_t count) {
+            consume(worker, morsel + m, rowIds, count);
+        });
+    });
+    position = inputSize;
+}
+
+// ---------------------------------------------------------------------------------------
+// Sort, top-K and limit
+
+SortOperator::SortOperator(RowOperator& input, const Table& table, const std::vector<SortKey>& keys)
+    : input(input), table(table), keys(keys) {}
+
+bool SortOperator::produce(RowBatch& batch) {
+    if (!sorted) {
+        // Every worker keeps its morsels' rows tagged with the morsel number; concatenated in morsel
+        // order they are in input order again, which the stable sort keeps for equal keys
+        ThreadPool& pool = ThreadPool::instance();
+        std::vector<std::vector<std::pair<size_t, SelectionVector>>> perWorker(pool.threadCount());
+        input.drain([&](size_t worker, size_t morsel, const uint32_t* rowIds, size_t count) {
+            auto& parts = perWorker[worker];
+            if (parts.empty() || parts.back().first != morsel) {
+                parts.emplace_back(morsel, SelectionVector());
+            }
+            parts.back().second.insert(parts.back().second.end(), rowIds, rowIds + count);
+        });
+        std::vector<std::pair<size_t, SelectionVector>> parts;
+        for (auto& workerParts : perWorker) {
+            for (auto& part : workerParts) parts.push_back(std::move(part));
+        }
+        std::stable_sort(parts.begin(), parts.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (auto& part : parts) {
+            rows.insert(rows.end(), part.second.begin(), part.second.end());
+        }
+
+        sortRows(table, keys, rows);
+        sorted = true;
+    }
+    if (position >= rows.size()) {
+        return false;
+    }
+    size_t count = std::min(kFilterBlockSize, rows.size() - position);
+    batch.assign(rows.begin() + position, rows.begin() + position + count);
+    position += count;
+    return true;
+}
+
+TopKOperator::TopKOperator(RowOperator& input, const Table& table, const std::vector<SortKey>& keys, size_t k)
+    : input(input), table(table), keys(keys), k(k) {}
+
+bool TopKOperator::produce(RowBatch& batch) {
+    if (done) {
+        return false;
+    }
+    done = true;
+
+    ThreadPool& pool = ThreadPool::instance();
+    std::vector<TopK> partials;
+    partials.reserve(pool.threadCount());
+    for (size_t w = 0; w < pool.threadCount(); ++w) {
+        partials.emplace_back(table, keys, k);
+    }
+    input.drain([&](size_t worker, size_t, const uint32_t* rowIds, size_t count) {
+        partials[worker].push(rowIds, count);
+    });
+
+    // Ties are broken by row id, so the result doesn't depend on scheduling
+    TopK merged(table, keys, k);
+    for (auto& partial : partials) {
+        SelectionVector rows = partial.finish();
+        merged.push(rows.data(), rows.size());
+    }
+    batch = merged.finish();
+    return !batch.empty();
+}
+
+bool LimitOperator::produce(RowBatch& batch) {
+    if (remaining == 0 || !input.next(batch)) {
+        return false;
+    }
+    if (batch.size() > remaining) {
+        batch.resize(remaining);
+    }
+    remaining -= batch.size();
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------
+// Projection and output
+
+ProjectOperator::ProjectOperator(RowOperator& input, const Table& table, const std::vector<int>& columns)
+    : input(input), table(table), columns(columns) {}
+
+bool ProjectOperator::next(CellBatch& cells) {
+    StatsScope scope(operatorStats);
+    if (!input.next(rows)) {
+        return false;
+    }
+    operatorStats.rowsOut += rows.size();
+    cells.clear();
+    auto out = std::back_inserter(cells.text);
+    for (uint32_t rowId : rows) {
+        for (int c : columns) {
+            const ColumnData& column = table.data[c];
+            switch (column.type) {
+                case DataType::INTEGER: fmt::format_to(out, "{}", column.intAt(rowId)); break;
+                case DataType::FLOAT:   fmt::format_to(out, "{:.2f}", column.floatAt(rowId)); break;
+                case DataType::CHAR:    cells.text += column.charAt(rowId); break;
+                case DataType::DATE:    cells.text += formatDate(column.intAt(rowId)); break;
+                case DataType::VARCHAR: cells.text += column.stringAt(rowId); break;
+            }
+            cells.ends.push_back(cells.text.size());
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> ProjectOperator::headers() const {
+    std::vector<std::string> names;
+    for (int c : columns) {
+        names.push_back(table.columns[c].name);
+    }
+    return names;
+}
+
+std::vector<size_t> ProjectOperator::widthBounds() const {
+    std::vector<size_t> bounds;
+    for (int c : columns) {
+        const ColumnData& column = table.data[c];
+        size_t width = 0;
+        switch (column.type) {
+            case DataType::INTEGER:
+                for (const ZoneMap& zone : column.zones) {
+                    width = std::max({width, fmt::formatted_size("{}", zone.intMin), fmt::formatted_size("{}", zone.intMax)});
+                }
+                break;
+            case DataType::FLOAT:
+                for (const ZoneMap& zone : column.zones) {
+                    width = std::max({width, fmt::formatted_size("{:.2f}", zone.floatMin),
+                                      fmt::formatted_size("{:.2f}", zone.floatMax)});
+                }
+                break;
+            case DataType::CHAR: width = 1; break;
+            case DataType::DATE: width = 10; break; // YYYY-MM-DD
+            case DataType::VARCHAR:
+                if (column.dictionaryEncoded) {
+                    for (uint32_t code = 0; code < column.dictionary.size(); ++code) {
+                        width = std::max(width, column.dictionary.at(code).size());
+                    }
+                } else {
+                    for (size_t r = 0; r < table.size(); ++r) {
+                        width = std::max(width, column.stringAt(r).size());
+                    }
+                }
+                break;
+        }
+        bounds.push_back(width);
+    }
+    return bounds;
+}
+
+GridSink::GridSink(std::vector<std::string> headers, std::function<std::vector<size_t>()> widthBounds)
+    : headers(std::move(headers)), widthBounds(std::move(widthBounds)) {
+    for (const auto& header : this->headers) {
+        widths.push_back(header.size());
+    }
+}
+
+void GridSink::write(const CellBatch& cells) {
+    if (streaming) {
+        printCells(cells);
+        return;
+    }
+
+    size_t offset = buffered.text.size();
+    buffered.text += cells.text;
+    for (size_t i = 0; i < cells.size(); ++i) {
+        buffered.ends.push_back(offset + cells.ends[i]);
+        widths[i % widths.size()] = std::max(widths[i % widths.size()], cells.cell(i).size());
+    }
+
+    if (buffered.size() / widths.size() > kSinkBufferRows) {
+        // Too long to hold: fix the widths so no later row can overflow them and start printing
+        std::vector<size_t> bounds = widthBounds();
+        for (size_t i = 0; i < widths.size(); ++i) {
+            widths[i] = std::max(widths[i], bounds[i]);
+        }
+        streaming = true;
+        printHeader();
+        printCells(buffered);
+        buffered = CellBatch();
+    }
+}
+
+void GridSink::finish() {
+    if (!streaming) {
+        printHeader();
+        printCells(buffered);
+    }
+}
+
+void GridSink::printHeader() {
+    fmt::memory_buffer out;
+    fmt::format_to(std::back_inserter(out), "|");
+    for (size_t i = 0; i < headers.size(); ++i) {
+        fmt::format_to(std::back_inserter(out), " {:<{}} |", headers[i], widths[i]);
+    }
+    fmt::format_to(std::back_inserter(out), "\n|");
+    for (size_t i = 0; i < headers.size(); ++i) {
+        fmt::format_to(std::back_inserter(out), " {:-<{}} |", "", widths[i]);
+    }
+    fmt::format_to(std::back_inserter(out), "\n");
+    fmt::print("{}", std::string_view(out.data(), out.size()));
+}
+
+void GridSink::printCells(const CellBatch& cells) {
+    // One write per batch
+    fmt::memory_buffer out;
+    size_t columnCount = widths.size();
+    for (size_t i = 0; i < cells.size(); ++i) {
+        if (i % columnCount == 0) fmt::format_to(std::back_inserter(out), "|");
+        fmt::format_to(std::back_inserter(out), " {:<{}} |", cells.cell(i), widths[i % columnCount]);
+        if (i % columnCount == columnCount - 1) fmt::format_to(std::back_inserter(out), "\n");
+    }
+    fmt::print("{}", std::string_view(out.data(), out.size()));
+}
+
+bool usesTopK(const SelectPlan& plan) {
+    return !plan.select.orderBy.empty() && plan.select.limit >= 0 &&
+           static_cast<size_t>(plan.select.limit) < plan.table->size();
+}
+
+SelectPipeline buildPipeline(const SelectPlan& plan) {
+    const Table& table = *plan.table;
+    bool hasOrderBy = !plan.select.orderBy.empty();
+    bool hasLimit = plan.select.limit >= 0;
+
+    SelectPipeline pipeline;
+    pipeline.scan = std::make_unique<ScanOperator>(table, plan.hasWhere ? &plan.predicate : nullptr,
+                                                   !hasOrderBy && hasLimit);
+    RowOperator* input = pipeline.scan.get();
+
+    if (usesTopK(plan)) {
+        // ORDER BY ... LIMIT k: the scan feeds top-k heaps directly (one per worker)
+        pipeline.sort = std::make_unique<TopKOperator>(*input, table, plan.sortKeys, static_cast<size_t>(plan.select.limit));
+        input = pipeline.sort.get();
+    } else if (hasOrderBy) {
+        // Stable: rows with equal keys retain their original order. A LIMIT that isn't below the
+        // table size can't cut anything here.
+        pipeline.sort = std::make_unique<SortOperator>(*input, table, plan.sortKeys);
+        input = pipeline.sort.get();
+    } else if (hasLimit) {
+        pipeline.limit = std::make_unique<LimitOperator>(*input, static_cast<size_t>(plan.select.limit));
+        input = pipeline.limit.get();
+    }
+
+    pipeline.project = std::make_unique<ProjectOperator>(*input, table, plan.columns);
+    return pipeline;
+}
+
+void runPipeline(ProjectOperator& project, GridSink& sink) {
+    CellBatch cells;
+    while (project.next(cells)) {
+        sink.write(cells);
+    }
+    sink.finish();
+}
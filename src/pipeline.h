@@ -0,0 +1,232 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "database.h"
+#include "condition.h"
+#include "sort.h"
+#include "plan.h"
+
+// Pull-based operator pipeline for plain SELECTs:
+//
+//   scan (+ filter) -> sort / top-K -> limit -> project -> sink
+//
+// Every operator pulls batches of row ids from its input with next(), so a consumer that is
+// satisfied (LIMIT without ORDER BY) simply stops pulling and the scan never reads the rest of the
+// table. Values are only read by the projection, for the rows that are actually printed.
+
+// A batch of rows flowing between operators: ids of table rows
+using RowBatch = SelectionVector;
+
+// What an operator did so far, for EXPLAIN ANALYZE. Time and allocations include the work of
+// its input, which runs inside its calls.
+struct OperatorStats {
+    double seconds = 0.0;           // wall time spent in next() / drain()
+    size_t rowsOut = 0;
+    size_t bytesAllocated = 0;      // heap bytes allocated meanwhile, by any thread (MINIDB_HEAP_STATS builds)
+};
+
+// Adds the wall time and heap allocations between its construction and destruction to `stats`
+class StatsScope {
+public:
+    explicit StatsScope(OperatorStats& stats);
+    ~StatsScope();
+
+private:
+    OperatorStats& stats;
+    std::chrono::steady_clock::time_point start;
+    size_t heapStart;
+};
+
+// Row ids of the batches are in table order unless they come out of a sort
+class RowOperator {
+public:
+    virtual ~RowOperator() = default;
+
+    // Fills `batch` with the next rows (never empty when true); false once the input is exhausted
+    bool next(RowBatch& batch);
+
+    // Pushes every remaining row to `consume` and exhausts the operator. Blocking operators
+    // (sort, top-K) drain their input this way.
+    void drain(const MorselConsumer& consume);
+
+    const OperatorStats& stats() const { return operatorStats; }
+
+protected:
+    virtual bool produce(RowBatch& batch) = 0;
+    // The default pulls batches on the calling thread (worker 0, morsel 0); a scan runs its
+    // morsels on the thread pool instead
+    virtual void produceAll(const MorselConsumer& consume);
+
+private:
+    OperatorStats operatorStats;
+};
+
+// Scan of a table through a ScanPlan: the WHERE filter runs inside the scan, so zone maps, Bloom
+// filters and indexes can skip rows before anything is read.
+// Each next() filters a chunk of the input. With `startSmall` (a LIMIT may be satisfied early)
+// the first chunk is one row group, filtered on the calling thread, and every following chunk
+// doubles up to a morsel per worker; otherwise every chunk is a morsel per worker.
+// The morsels of a chunk are filtered on the thread pool and come out in order.
+class ScanOperator : public RowOperator {
+public:
+    ScanOperator(const Table& table, const BoundPredicate* predicate, bool startSmall);
+
+    const ScanPlan& scanPlan() const { return plan; }
+    bool startsSmall() const { return startSmall; }
+
+    // Counts what the scan skips from now on (EXPLAIN ANALYZE)
+    void collectStats(ScanStats* stats) { plan.collectStats(stats); }
+
+protected:
+    bool produce(RowBatch& batch) override;
+    void produceAll(const MorselConsumer& consume) override;
+
+private:
+    ScanPlan plan;
+    bool startSmall;
+    size_t position = 0;                    // next input row of the plan to filter
+    size_t chunkRows;
+    std::vector<SelectionVector> pending;   // filtered morsels of the current chunk, in order
+    size_t pendingIndex = 0;
+};
+
+// ORDER BY: drains its input, sorts it (sortRows) and hands out the result in batches
+class SortOperator : public RowOperator {
+public:
+    SortOperator(RowOperator& input, const Table& table, const std::vector<SortKey>& keys);
+
+protected:
+    bool produce(RowBatch& batch) override;
+
+private:
+    RowOperator& input;
+    const Table& table;
+    const std::vector<SortKey>& keys;
+    bool sorted = false;
+    SelectionVector rows;
+    size_t position = 0;
+};
+
+// ORDER BY ... LIMIT k: drains its input into one TopK per worker, then merges the per-worker
+// winners, so at most k row ids per worker are ever held. Ties keep table order.
+class TopKOperator : public RowOperator {
+public:
+    TopKOperator(RowOperator& input, const Table& table, const std::vector<SortKey>& keys, size_t k);
+
+protected:
+    bool produce(RowBatch& batch) override;
+
+private:
+    RowOperator& input;
+    const Table& table;
+    const std::vector<SortKey>& keys;
+    size_t k;
+    bool done = false;
+};
+
+// LIMIT n: passes batches through until n rows went by, then stops pulling its input
+class LimitOperator : public RowOperator {
+public:
+    LimitOperator(RowOperator& input, size_t limit) : input(input), remaining(limit) {}
+
+protected:
+    bool produce(RowBatch& batch) override;
+
+private:
+    RowOperator& input;
+    size_t remaining;
+};
+
+// Formatted cells of a batch of result rows, row after row: cell i is text[ends[i - 1], ends[i])
+struct CellBatch {
+    std::string text;
+    std::vector<size_t> ends;
+
+    size_t size() const { return ends.size(); }
+    std::string_view cell(size_t i) const {
+        size_t begin = (i == 0) ? 0 : ends[i - 1];
+        return std::string_view(text).substr(begin, ends[i] - begin);
+    }
+    void clear() {
+        text.clear();
+        ends.clear();
+    }
+};
+
+// Projection: reads the SELECT list's columns of each batch's rows and formats them the way
+// SELECT prints them (FLOAT with two decimals, DATE as YYYY-MM-DD)
+class ProjectOperator {
+public:
+    ProjectOperator(RowOperator& input, const Table& table, const std::vector<int>& columns);
+
+    // Formats the next batch into `cells`; false once the input is exhausted
+    bool next(CellBatch& cells);
+
+    std::vector<std::string> headers() const;
+
+    // Widest cell any row of each column can produce, from the zone maps (numbers), the
+    // dictionary or the stored strings
+    std::vector<size_t> widthBounds() const;
+
+    // rowsOut counts result rows, not cells
+    const OperatorStats& stats() const { return operatorStats; }
+
+private:
+    OperatorStats operatorStats;
+    RowOperator& input;
+    const Table& table;
+    const std::vector<int>& columns;
+    RowBatch rows;
+};
+
+// Results up to this many rows are buffered and printed with exact column widths;
+// longer ones are streamed
+constexpr size_t kSinkBufferRows = 1 << 14;
+
+// Prints result rows as a grid. The first kSinkBufferRows rows are kept so a small result is laid
+// out to its widest cells; past that the columns are sized from `widthBounds()` (or the cells seen
+// so far, if wider) and every further batch is printed as it arrives, so memory stays bounded.
+class GridSink {
+public:
+    GridSink(std::vector<std::string> headers, std::function<std::vector<size_t>()> widthBounds);
+
+    void write(const CellBatch& cells);
+
+    // Prints what is still buffered (the whole grid for a small result)
+    void finish();
+
+private:
+    void printHeader();
+    void printCells(const CellBatch& cells);
+
+    std::vector<std::string> headers;
+    std::function<std::vector<size_t>()> widthBounds;    // only asked once the result gets long
+    std::vector<size_t> widths;
+    CellBatch buffered;
+    bool streaming = false;
+};
+
+// The operators of a plain SELECT (SelectPlan::Kind::SCAN), each pulling from the one before:
+// scan -> [sort | top-K] -> [limit] -> project
+struct SelectPipeline {
+    std::unique_ptr<ScanOperator> scan;
+    std::unique_ptr<RowOperator> sort;      // ORDER BY: SortOperator, or TopKOperator (see usesTopK)
+    std::unique_ptr<RowOperator> limit;     // LIMIT without ORDER BY
+    std::unique_ptr<ProjectOperator> project;
+};
+
+// True if ORDER BY ... LIMIT k runs as top-K: k must be below the table size, otherwise the LIMIT
+// can't drop a row and every per-worker heap would have to hold the whole table
+bool usesTopK(const SelectPlan& plan);
+
+// Builds the pipeline of a bound plain SELECT. Without ORDER BY, LIMIT makes the scan start
+// small (see ScanOperator) since it may never need the rest of the table.
+SelectPipeline buildPipeline(const SelectPlan& plan);
+
+// Runs a projection into a sink until the input is exhausted
+void runPipeline(ProjectOperator& project, GridSink& sink);
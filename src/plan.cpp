@@ -0,0 +1,108 @@
+#include <algorithm>
+
+#include "plan.h"
+#include "lexer.h"
+#include "utils.h"
+
+// Keywords of the SELECT grammar, aggregate names included (the parser spells those in upper case)
+static constexpr std::string_view kQueryKeywords[] = {
+    "SELECT", "FROM", "INNER", "JOIN", "ON", "WHERE", "AND", "OR", "NOT", "IN", "GROUP", "BY",
+    "ORDER", "ASC", "DESC", "LIMIT", "COUNT", "SUM", "AVG", "MIN", "MAX"};
+
+// The keyword `name` spells in any case, or an empty view
+static std::string_view queryKeyword(std::string_view name) {
+    for (std::string_view keyword : kQueryKeywords) {
+        if (std::equal(keyword.begin(), keyword.end(), name.begin(), name.end(),
+                       [](char upper, char c) { return upper == toUpperManual(c); })) {
+            return keyword;
+        }
+    }
+    return {};
+}
+
+static bool spellsKeyword(std::string_view name) {
+    return !queryKeyword(name).empty();
+}
+
+std::string normalizeQuery(std::string_view sql, const std::vector<Token>& tokens) {
+    size_t count = tokens.size() - 1;   // without END
+    if (count > 0 && tokens[count - 1].isSymbol(";")) {
+        --count;
+    }
+
+    std::string key;
+    key.reserve(sql.size());
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) key += ' ';
+        std::string_view keyword = tokens[i].type == TokenType::IDENTIFIER ? queryKeyword(tokens[i].text)
+                                                                            : std::string_view();
+        // Anything else as written, so a string literal keeps its quotes (and 'a b' never equals a b)
+        key += keyword.empty() ? sql.substr(tokens[i].position, tokens[i].end - tokens[i].position) : keyword;
+    }
+    return key;
+}
+
+static bool hasKeywordNames(const WhereClause& where) {
+    if (where.kind == WhereClause::Kind::CONDITION) {
+        const Condition& cond = where.condition;
+        if (spellsKeyword(cond.column)) return true;
+        if (cond.value.kind == Literal::Kind::WORD && spellsKeyword(cond.value.text)) return true;
+        for (const auto& value : cond.inValues) {
+            if (value.kind == Literal::Kind::WORD && spellsKeyword(value.text)) return true;
+        }
+    }
+    for (const auto& operand : where.operands) {
+        if (hasKeywordNames(operand)) return true;
+    }
+    return false;
+}
+
+bool hasKeywordNames(const SelectStatement& select) {
+    // Function names are not names here: the parser spells aggregates in upper case itself
+    for (const auto& item : select.items) {
+        if (spellsKeyword(item.column)) return true;
+    }
+    for (const auto& [item, isDesc] : select.orderBy) {
+        if (spellsKeyword(item.column)) return true;
+    }
+    for (std::string_view name : select.groupBy) {
+        if (spellsKeyword(name)) return true;
+    }
+    const JoinClause& join = select.join;
+    for (std::string_view name : {select.table, join.rightTable, join.leftKey, join.rightKey}) {
+        if (spellsKeyword(name)) return true;
+    }
+    return hasKeywordNames(select.where);
+}
+
+std::shared_ptr<SelectPlan> PlanCache::find(const std::string& key,
+                                            const std::function<bool(const SelectPlan&)>& isCurrent) {
+    auto it = positions.find(key);
+    if (it != positions.end() && !isCurrent(*it->second->second)) {
+        entries.erase(it->second);
+        positions.erase(it);
+        it = positions.end();
+    }
+    if (it == positions.end()) {
+        ++missCount;
+        return nullptr;
+    }
+    ++hitCount;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->second;
+}
+
+void PlanCache::insert(const std::string& key, std::shared_ptr<SelectPlan> plan) {
+    auto it = positions.find(key);
+    if (it != positions.end()) {
+        it->second->second = std::move(plan);
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    if (entries.size() == kPlanCacheSize) {
+        positions.erase(entries.back().first);
+        entries.pop_back();
+    }
+    entries.emplace_front(key, std::move(plan));
+    positions[key] = entries.begin();
+}
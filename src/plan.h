@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "database.h"
+#include "condition.h"
+#include "aggregate.h"
+#include "join.h"
+#include "sort.h"
+#include "lexer.h"
+#include "parser.h"
+
+// Block size of a plan's text arena: a query's names and literals usually fit in one block
+constexpr size_t kPlanTextBlockSize = 1024;
+
+// A SELECT bound to the tables it reads: column indices, the bound WHERE predicate, sort keys,
+// the aggregate or join query. Running it again only fills the '?' slots and refreshes
+// dictionary codes (bindParameters), no parsing or name lookups.
+struct SelectPlan {
+    enum class Kind { SCAN, AGGREGATE, JOIN };
+
+    // The parsed query, bound again when a table it reads was replaced. Its names and literals
+    // are copied into `text` when the plan is bound (see copySelect), since the command text
+    // they pointed into is gone once the command returns.
+    Arena text{kPlanTextBlockSize};
+    SelectStatement select;
+    Kind kind = Kind::SCAN;
+
+    // Every table the plan reads with the generation it was bound against (see Table::generation).
+    // A table that is missing or has another generation was dropped or reloaded: the pointers
+    // below are stale and the plan has to be bound again.
+    std::vector<std::pair<std::string, uint64_t>> tables;
+
+    // SCAN and AGGREGATE
+    const Table* table = nullptr;
+    bool hasWhere = false;
+    BoundPredicate predicate;
+    std::vector<int> columns;               // SCAN: projected columns ("*" expanded)
+    std::vector<SortKey> sortKeys;          // SCAN: ORDER BY
+    AggregateQuery aggregate;               // AGGREGATE
+    JoinQuery join;                         // JOIN
+
+    std::vector<DataType> parameterTypes;   // column type of each '?' slot, in order
+};
+
+// Key of a SELECT in the plan cache, built from the tokens the command was lexed into: the tokens
+// separated by single spaces, without the final ';', keywords in upper case (so spacing, line
+// breaks and the case of keywords don't matter). Names and literals are kept as written.
+std::string normalizeQuery(std::string_view sql, const std::vector<Token>& tokens);
+
+// True if the query uses a name or bare word spelled like a keyword (a column called "desc").
+// normalizeQuery folds the case of such a token as well, so two queries naming different columns
+// could get the same key: these queries are not cached.
+bool hasKeywordNames(const SelectStatement& select);
+
+// Number of plans kept by the plan cache
+constexpr size_t kPlanCacheSize = 64;
+
+// Least-recently-used cache of bound plans for plain (unprepared) SELECTs, keyed on the
+// normalized text
+class PlanCache {
+public:
+    // The plan stored under `key` (now the most recently used), or nullptr.
+    // A plan that `isCurrent` rejects (a table it reads was dropped or reloaded) is evicted.
+    std::shared_ptr<SelectPlan> find(const std::string& key, const std::function<bool(const SelectPlan&)>& isCurrent);
+
+    // Stores a plan, replacing one with the same key; evicts the least recently used plan when full
+    void insert(const std::string& key, std::shared_ptr<SelectPlan> plan);
+
+    size_t size() const { return entries.size(); }
+    size_t hits() const { return hitCount; }
+    size_t misses() const { return missCount; }
+
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<SelectPlan>>;
+    std::list<Entry> entries;       // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> positions;
+    size_t hitCount = 0;
+    size_t missCount = 0;
+};
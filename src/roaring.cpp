@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <bit>
+#include <iterator>
+
+#include "roaring.h"
+
+bool RoaringBitmap::Container::contains(uint16_t low) const {
+    if (isBitset()) {
+        return (words[low / 64] >> (low % 64)) & 1;
+    }
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void RoaringBitmap::Container::add(uint16_t low) {
+    if (isBitset()) {
+        uint64_t bit = uint64_t{1} << (low % 64);
+        if (!(words[low / 64] & bit)) {
+            words[low / 64] |= bit;
+            ++cardinality;
+        }
+        return;
+    }
+
+    // Appends are the common case, so check the end before searching
+    if (array.empty() || array.back() < low) {
+        array.push_back(low);
+    } else {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if (*it == low) {
+            return;
+        }
+        array.insert(it, low);
+    }
+    ++cardinality;
+
+    if (array.size() > kArrayMaxCardinality) {
+        words = toWords();
+        array.clear();
+        array.shrink_to_fit();
+    }
+}
+
+std::vector<uint64_t> RoaringBitmap::Container::toWords() const {
+    if (isBitset()) {
+        return words;
+    }
+    std::vector<uint64_t> result(kBitsetWords, 0);
+    for (uint16_t low : array) {
+        result[low / 64] |= uint64_t{1} << (low % 64);
+    }
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::fromWords(uint16_t key, std::vector<uint64_t> words) {
+    Container c;
+    c.key = key;
+    for (uint64_t word : words) {
+        c.cardinality += static_cast<uint32_t>(std::popcount(word));
+    }
+    if (c.cardinality > kArrayMaxCardinality) {
+        c.words = std::move(words);
+        return c;
+    }
+    c.array.reserve(c.cardinality);
+    for (size_t w = 0; w < kBitsetWords; ++w) {
+        uint64_t word = words[w];
+        while (word != 0) {
+            c.array.push_back(static_cast<uint16_t>(w * 64 + std::countr_zero(word)));
+            word &= word - 1;
+        }
+    }
+    return c;
+}
+
+RoaringBitmap::Container RoaringBitmap::andContainers(const Container& a, const Container& b) {
+    if (a.isBitset() && b.isBitset()) {
+        std::vector<uint64_t> words(kBitsetWords);
+        for (size_t w = 0; w < kBitsetWords; ++w) words[w] = a.words[w] & b.words[w];
+        return fromWords(a.key, std::move(words));
+    }
+
+    Container c;
+    c.key = a.key;
+    if (!a.isBitset() && !b.isBitset()) {
+        std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                              std::back_inserter(c.array));
+    } else {
+        // An array against a bitset: keep the array values whose bit is set
+        const Container& arrayPart = a.isBitset() ? b : a;
+        const Container& bitsetPart = a.isBitset() ? a : b;
+        for (uint16_t low : arrayPart.array) {
+            if (bitsetPart.contains(low)) c.array.push_back(low);
+        }
+    }
+    c.cardinality = static_cast<uint32_t>(c.array.size());
+    return c;
+}
+
+RoaringBitmap::Container RoaringBitmap::orContainers(const Container& a, const Container& b) {
+    if (!a.isBitset() && !b.isBitset() && a.cardinality + b.cardinality <= kArrayMaxCardinality) {
+        Container c;
+        c.key = a.key;
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                       std::back_inserter(c.array));
+        c.cardinality = static_cast<uint32_t>(c.array.size());
+        return c;
+    }
+
+    std::vector<uint64_t> words = a.toWords();
+    if (b.isBitset()) {
+        for (size_t w = 0; w < kBitsetWords; ++w) words[w] |= b.words[w];
+    } else {
+        for (uint16_t low : b.array) words[low / 64] |= uint64_t{1} << (low % 64);
+    }
+    return fromWords(a.key, std::move(words));
+}
+
+RoaringBitmap::Container RoaringBitmap::andNotContainers(const Container& a, const Container& b) {
+    if (a.isBitset()) {
+        std::vector<uint64_t> words = a.words;
+        if (b.isBitset()) {
+            for (size_t w = 0; w < kBitsetWords; ++w) words[w] &= ~b.words[w];
+        } else {
+            for (uint16_t low : b.array) words[low / 64] &= ~(uint64_t{1} << (low % 64));
+        }
+        return fromWords(a.key, std::move(words));
+    }
+
+    Container c;
+    c.key = a.key;
+    if (b.isBitset()) {
+        for (uint16_t low : a.array) {
+            if (!b.contains(low)) c.array.push_back(low);
+        }
+    } else {
+        std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                            std::back_inserter(c.array));
+    }
+    c.cardinality = static_cast<uint32_t>(c.array.size());
+    return c;
+}
+
+void RoaringBitmap::push(Container c) {
+    if (c.cardinality > 0) {
+        containers.push_back(std::move(c));
+    }
+}
+
+void RoaringBitmap::add(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    uint16_t low = static_cast<uint16_t>(value & 0xFFFF);
+
+    if (containers.empty() || containers.back().key < key) {
+        Container c;
+        c.key = key;
+        containers.push_back(std::move(c));
+        containers.back().add(low);
+        return;
+    }
+
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    if (it == containers.end() || it->key != key) {
+        Container c;
+        c.key = key;
+        it = containers.insert(it, std::move(c));
+    }
+    it->add(low);
+}
+
+bool RoaringBitmap::contains(uint32_t value) const {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    return it != containers.end() && it->key == key && it->contains(static_cast<uint16_t>(value & 0xFFFF));
+}
+
+size_t RoaringBitmap::cardinality() const {
+    size_t total = 0;
+    for (const auto& c : containers) total += c.cardinality;
+    return total;
+}
+
+RoaringBitmap RoaringBitmap::range(uint32_t n) {
+    RoaringBitmap result;
+    for (uint32_t start = 0; start < n; start += 65536) {
+        uint32_t count = std::min<uint32_t>(65536, n - start);
+        std::vector<uint64_t> words(kBitsetWords, 0);
+        std::fill(words.begin(), words.begin() + count / 64, ~uint64_t{0});
+        if (count % 64 != 0) {
+            words[count / 64] = (uint64_t{1} << (count % 64)) - 1;
+        }
+        result.push(fromWords(static_cast<uint16_t>(start >> 16), std::move(words)));
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::andOf(const RoaringBitmap& a, const RoaringBitmap& b) {
+    // Only chunks present on both sides can have common ids
+    RoaringBitmap result;
+    size_t i = 0, j = 0;
+    while (i < a.containers.size() && j < b.containers.size()) {
+        const Container& ca = a.containers[i];
+        const Container& cb = b.containers[j];
+        if (ca.key < cb.key) ++i;
+        else if (cb.key < ca.key) ++j;
+        else {
+            result.push(andContainers(ca, cb));
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::orOf(const RoaringBitmap& a, const RoaringBitmap& b) {
+    RoaringBitmap result;
+    size_t i = 0, j = 0;
+    while (i < a.containers.size() || j < b.containers.size()) {
+        if (j == b.containers.size() || (i < a.containers.size() && a.containers[i].key < b.containers[j].key)) {
+            result.containers.push_back(a.containers[i++]);
+        } else if (i == a.containers.size() || b.containers[j].key < a.containers[i].key) {
+            result.containers.push_back(b.containers[j++]);
+        } else {
+            result.push(orContainers(a.containers[i++], b.containers[j++]));
+        }
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::andNotOf(const RoaringBitmap& a, const RoaringBitmap& b) {
+    RoaringBitmap result;
+    size_t j = 0;
+    for (const Container& ca : a.containers) {
+        while (j < b.containers.size() && b.containers[j].key < ca.key) ++j;
+        if (j < b.containers.size() && b.containers[j].key == ca.key) {
+            result.push(andNotContainers(ca, b.containers[j]));
+        } else {
+            result.containers.push_back(ca);
+        }
+    }
+    return result;
+}
+
+void RoaringBitmap::toVector(std::vector<uint32_t>& out) const {
+    out.reserve(out.size() + cardinality());
+    for (const auto& c : containers) {
+        uint32_t base = static_cast<uint32_t>(c.key) << 16;
+        if (!c.isBitset()) {
+            for (uint16_t low : c.array) out.push_back(base | low);
+            continue;
+        }
+        for (size_t w = 0; w < kBitsetWords; ++w) {
+            uint64_t word = c.words[w];
+            while (word != 0) {
+                out.push_back(base | static_cast<uint32_t>(w * 64 + std::countr_zero(word)));
+                word &= word - 1;
+            }
+        }
+    }
+}
+
+size_t RoaringBitmap::memoryUsage() const {
+    size_t bytes = containers.capacity() * sizeof(Container);
+    for (const auto& c : containers) {
+        bytes += c.array.capacity() * sizeof(uint16_t) + c.words.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
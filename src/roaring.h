@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compressed bitmap of row ids in the style of Roaring bitmaps.
+// Ids are split into chunks of 65536 by their upper 16 bits. Each non-empty chunk is a container:
+// a sorted array of the lower 16 bits while it holds at most kArrayMaxCardinality ids,
+// a plain 65536-bit bitset once it holds more. Sparse values stay small, dense ones are
+// combined a word at a time.
+class RoaringBitmap {
+public:
+    // An array container is converted to a bitset past this many values (4096 * 2 bytes = 8 KiB,
+    // the size of a bitset)
+    static constexpr size_t kArrayMaxCardinality = 4096;
+
+    // Adds one id. Appending ids in ascending order (the usual case) is O(1).
+    void add(uint32_t value);
+
+    bool contains(uint32_t value) const;
+
+    size_t cardinality() const;
+    bool empty() const { return containers.empty(); }
+
+    // Ids 0 .. n-1
+    static RoaringBitmap range(uint32_t n);
+
+    // Set operations, each returns a new bitmap
+    static RoaringBitmap andOf(const RoaringBitmap& a, const RoaringBitmap& b);
+    static RoaringBitmap orOf(const RoaringBitmap& a, const RoaringBitmap& b);
+    static RoaringBitmap andNotOf(const RoaringBitmap& a, const RoaringBitmap& b);
+
+    // Every id in [0, n) that is not in the bitmap
+    RoaringBitmap complement(uint32_t n) const { return andNotOf(range(n), *this); }
+
+    // Appends all ids in ascending order
+    void toVector(std::vector<uint32_t>& out) const;
+
+    size_t memoryUsage() const;
+
+private:
+    static constexpr size_t kBitsetWords = 65536 / 64;
+
+    struct Container {
+        uint16_t key = 0;                   // upper 16 bits of every id in the container
+        std::vector<uint16_t> array;        // sorted lower bits (array container)
+        std::vector<uint64_t> words;        // kBitsetWords words (bitset container), empty otherwise
+        uint32_t cardinality = 0;
+
+        bool isBitset() const { return !words.empty(); }
+        bool contains(uint16_t low) const;
+        void add(uint16_t low);
+        std::vector<uint64_t> toWords() const;
+    };
+
+    // Builds an array or bitset container from a bitset, depending on its cardinality
+    static Container fromWords(uint16_t key, std::vector<uint64_t> words);
+
+    static Container andContainers(const Container& a, const Container& b);
+    static Container orContainers(const Container& a, const Container& b);
+    static Container andNotContainers(const Container& a, const Container& b);
+
+    // Appends `c` unless it ended up empty
+    void push(Container c);
+
+    std::vector<Container> containers;      // ordered by key
+};
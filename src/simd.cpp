@@ -0,0 +1,40 @@
+#include <algorithm>
+#include <atomic>
+
+#include "simd.h"
+
+static std::atomic<int> forcedLevel{-1};
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel detected = [] {
+#ifdef MINIDB_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+        return SimdLevel::SSE2;
+#else
+        return SimdLevel::SCALAR;
+#endif
+    }();
+    return detected;
+}
+
+SimdLevel activeSimdLevel() {
+    int forced = forcedLevel.load(std::memory_order_relaxed);
+    return forced < 0 ? detectSimdLevel() : static_cast<SimdLevel>(forced);
+}
+
+void setSimdLevel(SimdLevel level) {
+    level = std::min(level, detectSimdLevel());
+    forcedLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SCALAR: return "scalar";
+        case SimdLevel::SSE2:   return "SSE2";
+        case SimdLevel::AVX2:   return "AVX2";
+    }
+    return "unknown";
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// SSE2 is part of x86-64, AVX2 code is compiled per function (TARGET_AVX2)
+// and only called after a CPU check
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MINIDB_X86_SIMD 1
+#include <immintrin.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// Instruction set used by the vectorized kernels. Picked at runtime from what the CPU supports.
+enum class SimdLevel { SCALAR, SSE2, AVX2 };
+
+// Best level supported by this CPU (detected once).
+SimdLevel detectSimdLevel();
+
+// Level currently used by the kernels.
+SimdLevel activeSimdLevel();
+
+// Forces a level (e.g. SCALAR for testing). Levels the CPU can't run are clamped down.
+void setSimdLevel(SimdLevel level);
+
+const char* simdLevelName(SimdLevel level);
@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+#include "sort.h"
+#include "thread_pool.h"
+
+std::vector<SortKey> bindSortKeys(const Table& table, const std::vector<std::pair<SelectItem, bool>>& orderByColumns) {
+    std::vector<SortKey> keys;
+    keys.reserve(orderByColumns.size());
+    for (const auto& [item, isDesc] : orderByColumns) {
+        int colIndex = item.isCall() ? -1 : table.findColumn(item.column);
+        if (colIndex < 0) {
+            throw std::runtime_error("Column '" + item.label() + "' not found in table.");
+        }
+        keys.push_back({static_cast<size_t>(colIndex), isDesc});
+    }
+    return keys;
+}
+
+// Three-way compare of two values of the same column
+template <typename T>
+static int threeWay(const T& a, const T& b) {
+    return (a < b) ? -1 : (b < a ? 1 : 0);
+}
+
+int compareRows(const Table& table, const std::vector<SortKey>& keys, uint32_t a, uint32_t b) {
+    // Compare row A and row B column by column
+    for (const auto& key : keys) {
+        const ColumnData& column = table.data[key.columnIndex];
+
+        int cmp = 0;
+        switch (column.type) {
+            case DataType::INTEGER:
+            case DataType::DATE:    cmp = threeWay(column.intAt(a), column.intAt(b)); break;
+            case DataType::FLOAT:   cmp = threeWay(column.floatAt(a), column.floatAt(b)); break;
+            case DataType::CHAR:    cmp = threeWay(column.charAt(a), column.charAt(b)); break;
+            case DataType::VARCHAR:
+                // Equal codes are equal strings, no need to read them
+                if (column.dictionaryEncoded && column.codes[a] == column.codes[b]) break;
+                cmp = threeWay(column.stringAt(a), column.stringAt(b));
+                break;
+        }
+
+        // If the values differ, decide ordering. If they are equal, check next column.
+        if (cmp != 0) {
+            return key.isDesc ? -cmp : cmp;
+        }
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Normalized keys
+//
+// Every row's ORDER BY values are encoded into one byte string whose plain byte order
+// (memcmp) is the ORDER BY order:
+//   INTEGER  sign bit flipped, big-endian
+//   FLOAT    sign bit flipped for positives, all bits flipped for negatives, big-endian
+//   CHAR     sign bit flipped (char compares signed)
+//   VARCHAR  bytes with 0x00 escaped as 0x00 0xFF, terminated by 0x00 0x00
+//            (no key is a prefix of another, so later keys can follow it);
+//            dictionary-encoded columns sorting at least as many rows as they have distinct
+//            values use the code's rank in the sorted dictionary instead, 2 bytes big-endian
+//   DESC     every byte of that key inverted
+
+struct NormalizedKeys {
+    std::vector<uint8_t> bytes;     // all keys back to back
+    std::vector<size_t> offsets{0}; // key i lives in [offsets[i], offsets[i + 1])
+    bool prefixIsFullKey = true;    // every key fits in 8 bytes, so the prefix alone decides order
+};
+
+static void appendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// `ranks` is the sorted dictionary of a dictionary-encoded VARCHAR column (empty to encode the string)
+static void appendNormalizedKey(std::vector<uint8_t>& out, const ColumnData& column, uint32_t row, bool isDesc,
+                                const std::vector<uint32_t>& ranks) {
+    size_t start = out.size();
+    switch (column.type) {
+        case DataType::INTEGER:
+        case DataType::DATE:
+            appendBigEndian(out, static_cast<uint32_t>(column.intAt(row)) ^ 0x80000000u);
+            break;
+        case DataType::FLOAT: {
+            float value = column.floatAt(row);
+            if (value == 0.0f) value = 0.0f; // -0.0 and 0.0 are equal
+            uint32_t bits = std::bit_cast<uint32_t>(value);
+            appendBigEndian(out, (bits & 0x80000000u) ? ~bits : (bits ^ 0x80000000u));
+            break;
+        }
+        case DataType::CHAR:
+            out.push_back(static_cast<uint8_t>(column.charAt(row)) ^ 0x80);
+            break;
+        case DataType::VARCHAR:
+            if (!ranks.empty()) {
+                uint32_t rank = ranks[column.codes[row]];
+                out.push_back(static_cast<uint8_t>(rank >> 8));
+                out.push_back(static_cast<uint8_t>(rank));
+                break;
+            }
+            for (char c : column.stringAt(row)) {
+                out.push_back(static_cast<uint8_t>(c));
+                if (c == '\0') out.push_back(0xFF);
+            }
+            out.push_back(0);
+            out.push_back(0);
+            break;
+    }
+    if (isDesc) {
+        for (size_t i = start; i < out.size(); ++i) out[i] = static_cast<uint8_t>(~out[i]);
+    }
+}
+
+static NormalizedKeys buildNormalizedKeys(const Table& table, const std::vector<SortKey>& keys, const SelectionVector& rows) {
+    NormalizedKeys normalized;
+    size_t fixedWidth = 0;
+    std::vector<std::vector<uint32_t>> ranks(keys.size());
+    for (size_t k = 0; k < keys.size(); ++k) {
+        const ColumnData& column = table.data[keys[k].columnIndex];
+        switch (column.type) {
+            case DataType::INTEGER:
+            case DataType::DATE:
+            case DataType::FLOAT:   fixedWidth += 4; break;
+            case DataType::CHAR:    fixedWidth += 1; break;
+            case DataType::VARCHAR:
+                // Sorting the dictionary is only worth it when it's no bigger than the input
+                if (column.dictionaryEncoded && column.dictionary.size() <= rows.size()) {
+                    ranks[k] = column.dictionary.sortedRanks();
+                    fixedWidth += 2;
+                } else {
+                    normalized.prefixIsFullKey = false;
+                }
+                break;
+        }
+    }
+    if (fixedWidth > 8) {
+        normalized.prefixIsFullKey = false;
+    }
+
+    if (normalized.prefixIsFullKey) {
+        normalized.bytes.reserve(rows.size() * fixedWidth);
+    }
+    normalized.offsets.reserve(rows.size() + 1);
+    for (uint32_t row : rows) {
+        for (size_t k = 0; k < keys.size(); ++k) {
+            appendNormalizedKey(normalized.bytes, table.data[keys[k].columnIndex], row, keys[k].isDesc, ranks[k]);
+        }
+        normalized.offsets.push_back(normalized.bytes.size());
+    }
+    return normalized;
+}
+
+// What is actually moved around while sorting: the first 8 key bytes as a big-endian integer
+// plus the position of the row in the input
+struct SortEntry {
+    uint64_t prefix;
+    uint32_t index;
+};
+
+static uint64_t keyPrefix(const NormalizedKeys& normalized, size_t i) {
+    const uint8_t* key = normalized.bytes.data() + normalized.offsets[i];
+    size_t length = std::min<size_t>(8, normalized.offsets[i + 1] - normalized.offsets[i]);
+    uint64_t prefix = 0;
+    for (size_t b = 0; b < 8; ++b) {
+        prefix = (prefix << 8) | (b < length ? key[b] : 0);
+    }
+    return prefix;
+}
+
+struct EntryLess {
+    const NormalizedKeys& normalized;
+
+    bool operator()(const SortEntry& a, const SortEntry& b) const {
+        if (a.prefix != b.prefix) return a.prefix < b.prefix;
+        if (normalized.prefixIsFullKey) return false;
+
+        const uint8_t* keyA = normalized.bytes.data() + normalized.offsets[a.index];
+        const uint8_t* keyB = normalized.bytes.data() + normalized.offsets[b.index];
+        size_t lengthA = normalized.offsets[a.index + 1] - normalized.offsets[a.index];
+        size_t lengthB = normalized.offsets[b.index + 1] - normalized.offsets[b.index];
+        int cmp = std::memcmp(keyA, keyB, std::min(lengthA, lengthB));
+        return cmp != 0 ? cmp < 0 : lengthA < lengthB;
+    }
+};
+
+// LSD radix sort on the 8-byte prefix (stable). Byte positions where every entry
+// has the same value are skipped, so narrow keys only pay for the bytes they use.
+static void radixSort(SortEntry* data, size_t n, SortEntry* scratch) {
+    size_t counts[8][256] = {};
+    for (size_t i = 0; i < n; ++i) {
+        for (int b = 0; b < 8; ++b) {
+            ++counts[b][(data[i].prefix >> (b * 8)) & 0xFF];
+        }
+    }
+
+    SortEntry* src = data;
+    SortEntry* dst = scratch;
+    for (int b = 0; b < 8; ++b) {
+        size_t* count = counts[b];
+        if (count[(src[0].prefix >> (b * 8)) & 0xFF] == n) {
+            continue; // all entries share this byte
+        }
+
+        size_t offsets[256];
+        size_t sum = 0;
+        for (int v = 0; v < 256; ++v) {
+            offsets[v] = sum;
+            sum += count[v];
+        }
+        for (size_t i = 0; i < n; ++i) {
+            dst[offsets[(src[i].prefix >> (b * 8)) & 0xFF]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != data) {
+        std::copy(src, src + n, data);
+    }
+}
+
+// Sorts one run of entries on the calling thread
+static void sortRun(SortEntry* data, size_t n, SortEntry* scratch, const NormalizedKeys& normalized) {
+    EntryLess less{normalized};
+    if (n < kRadixSortMinRows) {
+        std::stable_sort(data, data + n, less);
+        return;
+    }
+
+    radixSort(data, n, scratch);
+    if (normalized.prefixIsFullKey) {
+        return;
+    }
+
+    // Entries whose first 8 bytes tie are ordered by the rest of their key
+    size_t runStart = 0;
+    for (size_t i = 1; i <= n; ++i) {
+        if (i == n || data[i].prefix != data[runStart].prefix) {
+            if (i - runStart > 1) {
+                std::stable_sort(data + runStart, data + i, less);
+            }
+            runStart = i;
+        }
+    }
+}
+
+void sortRows(const Table& table, const std::vector<SortKey>& keys, SelectionVector& rows) {
+    size_t n = rows.size();
+    if (n < 2 || keys.empty()) {
+        return;
+    }
+
+    NormalizedKeys normalized = buildNormalizedKeys(table, keys, rows);
+
+    std::vector<SortEntry> entries(n);
+    for (size_t i = 0; i < n; ++i) {
+        entries[i] = {keyPrefix(normalized, i), static_cast<uint32_t>(i)};
+    }
+    std::vector<SortEntry> scratch(n);
+
+    ThreadPool& pool = ThreadPool::instance();
+    size_t runCount = std::min(pool.threadCount(), n / kParallelSortMinRowsPerThread);
+
+    if (runCount <= 1) {
+        sortRun(entries.data(), n, scratch.data(), normalized);
+    } else {
+        // 1) Sort one run per worker
+        std::vector<size_t> bounds;
+        for (size_t t = 0; t <= runCount; ++t) {
+            bounds.push_back(n * t / runCount);
+        }
+
+        pool.parallelFor(runCount, [&](size_t, size_t t) {
+            sortRun(entries.data() + bounds[t], bounds[t + 1] - bounds[t],
+                    scratch.data() + bounds[t], normalized);
+        });
+
+        // 2) Merge neighbouring runs pairwise, one task per pair, until one run is left.
+        // std::merge takes from the left run on ties, which keeps the sort stable.
+        EntryLess less{normalized};
+        SortEntry* src = entries.data();
+        SortEntry* dst = scratch.data();
+        while (bounds.size() > 2) {
+            std::vector<size_t> merged;
+            for (size_t r = 0; r < bounds.size() - 1; r += 2) {
+                merged.push_back(bounds[r]);
+            }
+            merged.push_back(n);
+
+            size_t pairCount = merged.size() - 1;
+            pool.parallelFor(pairCount, [&](size_t, size_t pair) {
+                size_t r = pair * 2;
+                size_t lo = bounds[r];
+                size_t mid = bounds[r + 1];
+                size_t hi = (r + 2 < bounds.size()) ? bounds[r + 2] : mid;
+                std::merge(src + lo, src + mid, src + mid, src + hi, dst + lo, less);
+            });
+            bounds = std::move(merged);
+            std::swap(src, dst);
+        }
+        if (src != entries.data()) {
+            std::copy(src, src + n, entries.data());
+        }
+    }
+
+    // Reorder the row ids
+    SelectionVector sorted(n);
+    for (size_t i = 0; i < n; ++i) {
+        sorted[i] = rows[entries[i].index];
+    }
+    rows = std::move(sorted);
+}
+
+// ---------------------------------------------------------------------------------------
+TopK::TopK(const Table& table, std::vector<SortKey> keys, size_t k)
+    : table(table), keys(std::move(keys)), k(k), sortAll(k >= table.size()) {}
+
+bool TopK::before(uint32_t a, uint32_t b) const {
+    int cmp = compareRows(table, keys, a, b);
+    return cmp != 0 ? cmp < 0 : a < b;
+}
+
+void TopK::push(uint32_t rowId) {
+    if (k == 0) {
+        return;
+    }
+    if (sortAll) {
+        heap.push_back(rowId);
+        return;
+    }
+
+    auto less = [this](uint32_t a, uint32_t b) { return before(a, b); };
+
+    if (heap.size() < k) {
+        heap.push_back(rowId);
+        std::push_heap(heap.begin(), heap.end(), less);
+    } else if (before(rowId, heap.front())) {
+        // Better than the current worst candidate: replace it
+        std::pop_heap(heap.begin(), heap.end(), less);
+        heap.back() = rowId;
+        std::push_heap(heap.begin(), heap.end(), less);
+    }
+}
+
+void TopK::push(const uint32_t* rowIds, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        push(rowIds[i]);
+    }
+}
+
+SelectionVector TopK::finish() {
+    if (sortAll) {
+        // Row order first, so the stable sort breaks ties by row id like the heap does
+        std::sort(heap.begin(), heap.end());
+        sortRows(table, keys, heap);
+        return std::move(heap);
+    }
+    auto less = [this](uint32_t a, uint32_t b) { return before(a, b); };
+    std::sort_heap(heap.begin(), heap.end(), less);
+    return std::move(heap);
+}
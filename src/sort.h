@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "database.h"
+#include "filter_kernels.h"
+#include "condition.h"
+
+// One ORDER BY key resolved against a table
+struct SortKey {
+    size_t columnIndex; // position in table.columns / table.data
+    bool isDesc;        // true for DESC
+};
+
+// Resolves ORDER BY (column name, isDesc) pairs to column indices.
+// Throws if a column doesn't exist.
+std::vector<SortKey> bindSortKeys(const Table& table, const std::vector<std::pair<SelectItem, bool>>& orderByColumns);
+
+// Compares two rows of the table on the sort keys.
+// Returns a negative number if row a comes first, positive if row b comes first, 0 if the keys are equal.
+int compareRows(const Table& table, const std::vector<SortKey>& keys, uint32_t a, uint32_t b);
+
+// Inputs smaller than this are sorted with a plain comparison sort
+constexpr size_t kRadixSortMinRows = 256;
+
+// Each sorted run gets at least this many rows; smaller inputs are sorted on one thread
+constexpr size_t kParallelSortMinRowsPerThread = 1 << 16;
+
+// Sorts row ids by the ORDER BY keys. The sort is stable: rows with equal keys keep their input order.
+// Every key is encoded once per row into a byte-comparable normalized key (ASC/DESC folded in).
+// The first 8 bytes are radix-sorted; keys longer than that (strings) fall back to comparing
+// the normalized bytes only where the first 8 bytes tie. Large inputs are split into one run per
+// thread pool worker and the sorted runs are merged.
+void sortRows(const Table& table, const std::vector<SortKey>& keys, SelectionVector& rows);
+
+// Top-K operator for ORDER BY ... LIMIT k.
+// Keeps only the k best row ids seen so far in a bounded max-heap (worst candidate on top),
+// so feeding it N rows costs O(N log k) time and O(min(N, k)) memory: the heap grows as rows arrive.
+// When k is at least the table size nothing can be dropped, so it just collects the rows and sorts
+// them with sortRows. Rows with equal keys keep their table order, same as a stable sort would.
+class TopK {
+public:
+    TopK(const Table& table, std::vector<SortKey> keys, size_t k);
+
+    // Offers one row / a batch of rows (e.g. a block of filter output)
+    void push(uint32_t rowId);
+    void push(const uint32_t* rowIds, size_t count);
+
+    // Returns the kept row ids in ORDER BY order. The operator is empty afterwards.
+    SelectionVector finish();
+
+private:
+    // true if row a sorts before row b (ties broken by row id)
+    bool before(uint32_t a, uint32_t b) const;
+
+    const Table& table;
+    std::vector<SortKey> keys;
+    size_t k;
+    bool sortAll;                   // k >= table size: collect everything, sort in finish()
+    std::vector<uint32_t> heap;
+};
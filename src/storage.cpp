@@ -0,0 +1,283 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+#include "storage.h"
+#include "index.h"
+
+size_t ColumnData::size() const {
+    switch (type) {
+        case DataType::INTEGER:
+        case DataType::DATE:    return sealedRows() + ints.size();
+        case DataType::FLOAT:   return floats.size();
+        case DataType::CHAR:    return sealedRows() + chars.size();
+        case DataType::VARCHAR: return dictionaryEncoded ? codes.size() : plainStrings.size();
+    }
+    return 0;
+}
+
+bool valueMatches(DataType type, const Value& value) {
+    switch (type) {
+        case DataType::INTEGER: return value.type() == ValueType::INT;
+        case DataType::DATE:    return value.type() == ValueType::DATE;
+        case DataType::FLOAT:   return value.type() == ValueType::FLOAT;
+        case DataType::CHAR:    return value.type() == ValueType::CHAR;
+        case DataType::VARCHAR: return value.type() == ValueType::STRING;
+    }
+    return false;
+}
+
+void ColumnData::append(const Value& value) {
+    switch (type) {
+        case DataType::INTEGER:
+        case DataType::DATE:
+            if (!valueMatches(type, value)) break;
+            ints.push_back(value.asInt());
+            updateZone(size() - 1);
+            if (ints.size() == kRowGroupSize) sealGroup();
+            return;
+        case DataType::FLOAT:
+            if (!valueMatches(type, value)) break;
+            floats.push_back(value.asFloat());
+            updateZone(floats.size() - 1);
+            return;
+        case DataType::CHAR:
+            if (!valueMatches(type, value)) break;
+            chars.push_back(value.asChar());
+            updateZone(size() - 1);
+            if (chars.size() == kRowGroupSize) sealGroup();
+            return;
+        case DataType::VARCHAR: {
+            if (!valueMatches(type, value)) break;
+            std::string_view str = value.asString();
+            if (dictionaryEncoded && dictionary.size() == kDictionaryMaxSize && dictionary.find(str) < 0) {
+                decodeDictionary(); // no code left for a new string
+            }
+            if (dictionaryEncoded) {
+                codes.push_back(static_cast<uint16_t>(dictionary.intern(str, *arena)));
+            } else {
+                plainStrings.push_back(storeString(str));
+            }
+            size_t row = size() - 1;
+            updateZone(row);
+            // Mostly distinct values don't pay for a dictionary
+            if (dictionaryEncoded && (row + 1) % kRowGroupSize == 0 && dictionary.size() * 2 > row + 1) {
+                decodeDictionary();
+            }
+            return;
+        }
+    }
+    throw std::runtime_error("Value does not match the column data type.");
+}
+
+// Widens [lo, hi] to take in `value`; the first value of a group sets both
+template <typename T>
+static void widenZone(T& lo, T& hi, const T& value, bool first) {
+    if (first || value < lo) lo = value;
+    if (first || hi < value) hi = value;
+}
+
+void ColumnData::updateZone(size_t row) {
+    if (row % kRowGroupSize == 0) {
+        zones.emplace_back();
+        openZoneValues.clear();
+    }
+    ZoneMap& zone = zones.back();
+    bool first = (zone.rowCount == 0);
+
+    uint64_t hash = 0;
+    switch (type) {
+        case DataType::INTEGER:
+        case DataType::DATE:
+            widenZone(zone.intMin, zone.intMax, intAt(row), first);
+            hash = static_cast<uint32_t>(intAt(row));
+            break;
+        case DataType::FLOAT: {
+            float value = floats[row];
+            if (std::isnan(value)) {
+                // NaN compares false with everything, so it would never widen the range;
+                // open the range instead so no group holding it is ever skipped
+                zone.floatMin = -std::numeric_limits<float>::infinity();
+                zone.floatMax = std::numeric_limits<float>::infinity();
+            } else {
+                widenZone(zone.floatMin, zone.floatMax, value, first);
+            }
+            hash = std::bit_cast<uint32_t>(value);
+            break;
+        }
+        case DataType::CHAR:
+            widenZone(zone.charMin, zone.charMax, charAt(row), first);
+            hash = static_cast<unsigned char>(charAt(row));
+            break;
+        case DataType::VARCHAR: {
+            std::string_view value = stringAt(row);
+            if (first || value < zone.stringMin) zone.stringMin = value;
+            if (first || zone.stringMax < value) zone.stringMax = value;
+            hash = std::hash<std::string_view>{}(value);
+            break;
+        }
+    }
+
+    ++zone.rowCount;
+    openZoneValues.insert(hash);
+    zone.distinctCount = static_cast<uint32_t>(openZoneValues.size());
+    if (zone.rowCount == kRowGroupSize) {
+        openZoneValues = {};
+    }
+}
+
+Value ColumnData::valueAt(size_t i) const {
+    switch (type) {
+        case DataType::INTEGER: return Value(intAt(i));
+        case DataType::DATE:    return Value::date(intAt(i));
+        case DataType::FLOAT:   return Value(floats[i]);
+        case DataType::CHAR:    return Value(charAt(i));
+        case DataType::VARCHAR: return Value::string(stringAt(i));
+    }
+    throw std::runtime_error("Unknown data type encountered.");
+}
+
+void ColumnData::reserve(size_t n) {
+    switch (type) {
+        case DataType::INTEGER:
+        case DataType::DATE:
+            encoded.reserve(n / kRowGroupSize);
+            ints.reserve(std::min(n, kRowGroupSize));
+            break;
+        case DataType::FLOAT:   floats.reserve(n); break;
+        case DataType::CHAR:
+            encoded.reserve(n / kRowGroupSize);
+            chars.reserve(std::min(n, kRowGroupSize));
+            break;
+        case DataType::VARCHAR:
+            if (dictionaryEncoded) codes.reserve(n);
+            else plainStrings.reserve(n);
+            break;
+    }
+}
+
+void ColumnData::sealGroup() {
+    if (type == DataType::CHAR) {
+        int32_t values[kRowGroupSize];
+        std::copy(chars.begin(), chars.end(), values);
+        encoded.emplace_back(values, chars.size(), true);
+        chars.clear();
+    } else {
+        encoded.emplace_back(ints.data(), ints.size(), false);
+        ints.clear();
+    }
+}
+
+const int32_t* ColumnData::intBlock(size_t start, size_t count, int32_t* scratch) const {
+    const EncodedGroup* group = encodedGroupAt(start);
+    if (group == nullptr) {
+        return ints.data() + (start - sealedRows());
+    }
+    size_t offset = start % kRowGroupSize;
+    if (const int32_t* plain = group->plainIntData()) {
+        return plain + offset;
+    }
+    group->decode(offset, count, scratch);
+    return scratch;
+}
+
+const char* ColumnData::charBlock(size_t start, size_t count, char* scratch) const {
+    const EncodedGroup* group = encodedGroupAt(start);
+    if (group == nullptr) {
+        return chars.data() + (start - sealedRows());
+    }
+    size_t offset = start % kRowGroupSize;
+    if (const char* plain = group->plainCharData()) {
+        return plain + offset;
+    }
+    group->decode(offset, count, scratch);
+    return scratch;
+}
+
+void ColumnData::decodeDictionary() {
+    // The dictionary's strings already sit in the arena in the plain layout: the rows holding a
+    // string share its entry, nothing is copied
+    plainStrings.reserve(codes.size());
+    for (uint16_t code : codes) {
+        plainStrings.push_back(dictionary.entry(code));
+    }
+    plainStringBytes += dictionary.stringBytes();
+    dictionaryEncoded = false;
+    codes = {};
+    dictionary = StringDictionary();
+}
+
+const char* ColumnData::storeString(std::string_view value) {
+    plainStringBytes += sizeof(uint32_t) + value.size();
+    return arena->copyLengthPrefixed(value);
+}
+
+size_t ColumnData::memoryUsage() const {
+    size_t total = ints.capacity() * sizeof(int32_t) + floats.capacity() * sizeof(float) + chars.capacity() +
+                   codes.capacity() * sizeof(uint16_t) + plainStrings.capacity() * sizeof(const char*) +
+                   plainStringBytes +
+                   zones.capacity() * sizeof(ZoneMap);
+    for (const auto& group : encoded) {
+        total += group.memoryUsage();
+    }
+    if (dictionaryEncoded) {
+        total += dictionary.memoryUsage();
+    }
+    return total;
+}
+
+// ---------------------------------------------------------------------------------------
+void Table::addColumn(const Column& column) {
+    columns.push_back(column);
+    data.emplace_back(column.type);
+    data.back().arena = strings.get();
+}
+
+int Table::findColumn(std::string_view columnName) const {
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].name == columnName) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void Table::appendRow(const std::vector<Value>& values) {
+    if (values.size() != columns.size()) {
+        throw std::runtime_error("Column count doesn't match value count.");
+    }
+    // Type check everything first so a bad value can't leave the columns with different lengths
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (!valueMatches(columns[i].type, values[i])) {
+            throw std::runtime_error("Value for column '" + columns[i].name + "' does not match its data type.");
+        }
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        data[i].append(values[i]);
+    }
+    for (const auto& index : indexes) {
+        index->insert(data[index->columnIndex()], static_cast<uint32_t>(rowCount));
+    }
+    ++rowCount;
+}
+
+const TableIndex* Table::findIndex(size_t columnIndex, IndexKind kind) const {
+    for (const auto& index : indexes) {
+        if (index->columnIndex() == columnIndex && index->kind() == kind) {
+            return index.get();
+        }
+    }
+    return nullptr;
+}
+
+Row Table::getRow(size_t row) const {
+    Row result;
+    result.values.reserve(columns.size());
+    for (size_t col = 0; col < columns.size(); ++col) {
+        result.values.push_back(data[col].valueAt(row));
+    }
+    return result;
+}
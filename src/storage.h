@@ -0,0 +1,198 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "arena.h"
+#include "compression.h"
+#include "dictionary.h"
+#include "value.h"
+
+// Enum for supported data types
+enum class DataType {
+    INTEGER,
+    VARCHAR,
+    DATE,
+    CHAR,
+    FLOAT
+};
+
+// Represents a column in a table
+struct Column {
+    std::string name; // Column name
+    DataType type;    // Column data type
+};
+
+// Represents a single row of data.
+// Tables no longer store rows directly; a Row is only built when values leave the table
+// (query results, INSERT parsing).
+struct Row {
+    std::vector<Value> values; // Values in the row
+};
+
+// True if `value` can be stored in a column of type `type` (e.g. a DATE column takes DATE values, not INT)
+bool valueMatches(DataType type, const Value& value);
+
+// Rows are grouped into row groups of this many rows; every column keeps a ZoneMap per group.
+// A multiple of the filter block size and a divisor of the morsel size, so scans never
+// split a block across two groups.
+constexpr size_t kRowGroupSize = 4096;
+
+// Statistics of one column over one row group, kept up to date as rows are appended.
+// Only the min/max pair matching the column type is used (ints for INTEGER and DATE, strings for VARCHAR).
+// A scan skips a group when the zone map proves no row of it can pass the WHERE clause.
+struct ZoneMap {
+    size_t rowCount = 0;
+    bool nullFree = true;           // there are no NULLs in the engine yet, so this always holds
+    uint32_t distinctCount = 0;
+
+    int32_t intMin = 0, intMax = 0;
+    float floatMin = 0.0f, floatMax = 0.0f;
+    char charMin = '\0', charMax = '\0';
+    std::string stringMin, stringMax;
+};
+
+// Contiguous storage for all values of one column.
+// Only the array matching `type` is used, so a scan over one column touches only that column's memory.
+struct ColumnData {
+    DataType type = DataType::VARCHAR;
+
+    // INTEGER, DATE (days since the epoch) and CHAR keep every full row group compressed in
+    // `encoded` (see compression.h); only the last, still open group is held raw in ints / chars.
+    // Row i lives in encoded[i / kRowGroupSize] when that group exists, else at i - sealedRows().
+    std::vector<EncodedGroup> encoded;
+    std::vector<int32_t> ints;      // INTEGER, DATE: open row group
+    std::vector<float>   floats;    // FLOAT: every row
+    std::vector<char>    chars;     // CHAR: open row group
+
+    // VARCHAR starts out dictionary-encoded: value i is dictionary.at(codes[i]), so a string
+    // repeated a million times is stored once. Once the dictionary would pass kDictionaryMaxSize
+    // entries, or a full row group ends with more than half of the rows distinct, the column is
+    // decoded for good into plain storage: plainStrings[i] points at value i in the table's string
+    // arena, stored as a 4-byte length followed by the bytes. Dictionary strings live in the same
+    // arena in the same layout; strings never move once stored, so views of them stay valid as
+    // long as the table.
+    bool dictionaryEncoded = false;
+    std::vector<uint16_t> codes;
+    StringDictionary dictionary;
+    std::vector<const char*> plainStrings;
+    size_t plainStringBytes = 0;    // bytes this column has stored in the arena
+    Arena* arena = nullptr;         // the owning table's string arena (set by Table::addColumn)
+
+    // zones[g] describes rows [g * kRowGroupSize, (g + 1) * kRowGroupSize)
+    std::vector<ZoneMap> zones;
+
+    explicit ColumnData(DataType t = DataType::VARCHAR) : type(t), dictionaryEncoded(t == DataType::VARCHAR) {}
+
+    // Number of values stored in the column
+    size_t size() const;
+
+    // Typed accessors (no variant dispatch)
+    int32_t intAt(size_t i) const {
+        if (i < sealedRows()) return encoded[i / kRowGroupSize].at(i % kRowGroupSize);
+        return ints[i - sealedRows()];
+    }
+    float floatAt(size_t i) const { return floats[i]; }
+    char charAt(size_t i) const {
+        if (i < sealedRows()) return static_cast<char>(encoded[i / kRowGroupSize].at(i % kRowGroupSize));
+        return chars[i - sealedRows()];
+    }
+    std::string_view stringAt(size_t i) const {
+        if (dictionaryEncoded) return dictionary.at(codes[i]);
+        return lengthPrefixedString(plainStrings[i]);
+    }
+
+    // Rows held in compressed row groups (INTEGER, DATE and CHAR)
+    size_t sealedRows() const { return encoded.size() * kRowGroupSize; }
+
+    // The compressed row group holding `row`, or nullptr while its group is still open
+    const EncodedGroup* encodedGroupAt(size_t row) const {
+        return row < sealedRows() ? &encoded[row / kRowGroupSize] : nullptr;
+    }
+
+    // Values [start, start + count) of an INTEGER / DATE / CHAR column, all within one row group.
+    // Points straight into the column when the group is open or stored plain,
+    // otherwise the values are decoded into `scratch` (room for `count` values).
+    const int32_t* intBlock(size_t start, size_t count, int32_t* scratch) const;
+    const char* charBlock(size_t start, size_t count, char* scratch) const;
+
+    // Appends a value; throws if the value's type doesn't match the column's.
+    void append(const Value& value);
+
+    // The i-th entry as a Value. A long VARCHAR points into the table's string arena, so it lasts
+    // as long as the table.
+    Value valueAt(size_t i) const;
+
+    void reserve(size_t n);
+
+    // Bytes held by the column's arrays (capacity, including the dictionary, zone maps
+    // and the column's strings in the table arena)
+    size_t memoryUsage() const;
+
+private:
+    // Switches a dictionary-encoded VARCHAR column to plain storage
+    void decodeDictionary();
+
+    // Copies a string into the table arena in the plainStrings layout
+    const char* storeString(std::string_view value);
+
+    // Compresses the open row group of an INTEGER / DATE / CHAR column once it is full
+    void sealGroup();
+
+    // Adds the value just appended at position `row` to its group's zone map
+    void updateZone(size_t row);
+
+    // Hashes of the distinct values of the last group, dropped once the group is full
+    std::unordered_set<uint64_t> openZoneValues;
+};
+
+class TableIndex;
+enum class IndexKind;
+
+// Represents a table in the database, stored column by column
+struct Table {
+    std::string name;               // Table name
+    std::vector<Column> columns;    // Column definitions
+    std::vector<ColumnData> data;   // data[i] holds every value of columns[i]
+    size_t rowCount = 0;            // Number of rows stored
+
+    // Identity of this table instance, unique within the database: assigned when the table is created
+    // or loaded, so a cached plan bound to a dropped table is never run against a new one of the same name
+    uint64_t generation = 0;
+
+    // Secondary indexes (CREATE INDEX); appendRow keeps them up to date
+    std::vector<std::shared_ptr<TableIndex>> indexes;
+
+    // Backing memory for the strings of VARCHAR columns (plain values and dictionary entries),
+    // released with the table (DROP TABLE).
+    // Held by pointer so the columns' references survive moving the Table.
+    std::shared_ptr<Arena> strings = std::make_shared<Arena>();
+
+    // Adds a column definition together with its (empty) storage.
+    void addColumn(const Column& column);
+
+    // Returns the index of the column with the given name, or -1 if it doesn't exist.
+    int findColumn(std::string_view columnName) const;
+
+    // Returns the index of the given kind on the given column, or nullptr if it has none.
+    const TableIndex* findIndex(size_t columnIndex, IndexKind kind) const;
+
+    // Appends one row; values must be in column order and match the column types.
+    void appendRow(const std::vector<Value>& values);
+
+    size_t size() const { return rowCount; }
+
+    // Materializes a single cell / a full row.
+    Value getValue(size_t row, size_t col) const { return data[col].valueAt(row); }
+    Row getRow(size_t row) const;
+};
+
+// Tables by name. The comparator is transparent so a name can be looked up as a string_view
+// (a view into the command text) without building a std::string.
+using TableMap = std::map<std::string, Table, std::less<>>;
@@ -0,0 +1,155 @@
+#include <algorithm>
+
+#include "thread_pool.h"
+
+// Set while a thread is running pool tasks, so nested parallelFor calls don't wait on themselves
+static thread_local bool insidePoolTask = false;
+// Worker number of the thread running pool tasks (0 on any other thread), so a nested parallelFor
+// that runs serially hands its tasks the same worker and per-worker state stays private
+static thread_local size_t currentWorker = 0;
+
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    start(threadCount);
+}
+
+ThreadPool::~ThreadPool() {
+    stop();
+}
+
+void ThreadPool::setThreadCount(size_t threadCount) {
+    std::lock_guard<std::mutex> runLock(runMutex);
+    stop();
+    start(threadCount);
+}
+
+void ThreadPool::start(size_t threadCount) {
+    threadCount = std::max<size_t>(1, threadCount);
+    stopping = false;
+    queues.clear();
+    for (size_t w = 0; w < threadCount; ++w) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    // Workers are told the current generation up front; reading it on the new thread could
+    // miss a parallelFor that starts before the thread gets going
+    for (size_t w = 1; w < threadCount; ++w) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, w, generation);
+    }
+}
+
+void ThreadPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (auto& thread : threads) thread.join();
+    threads.clear();
+}
+
+void ThreadPool::workerLoop(size_t worker, size_t seenGeneration) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            wakeWorkers.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        runTasks(worker);
+
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (--busyWorkers == 0) {
+            workersDone.notify_all();
+        }
+    }
+}
+
+// Own deque first (front), then steal from the back of the others
+bool ThreadPool::takeTask(size_t worker, size_t& index) {
+    {
+        WorkQueue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            index = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkQueue& victim = *queues[(worker + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            index = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::runTasks(size_t worker) {
+    insidePoolTask = true;
+    currentWorker = worker;
+    size_t index = 0;
+    while (takeTask(worker, index)) {
+        try {
+            (*currentTask)(worker, index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (!firstError) firstError = std::current_exception();
+        }
+    }
+    insidePoolTask = false;
+    currentWorker = 0;
+}
+
+void ThreadPool::parallelFor(size_t taskCount, const std::function<void(size_t worker, size_t index)>& task) {
+    if (taskCount == 0) {
+        return;
+    }
+    if (insidePoolTask || threads.empty() || taskCount == 1) {
+        for (size_t i = 0; i < taskCount; ++i) task(currentWorker, i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(runMutex);
+
+    // Hand every worker a contiguous chunk of the indices
+    size_t workerCount = queues.size();
+    for (size_t w = 0; w < workerCount; ++w) {
+        std::lock_guard<std::mutex> lock(queues[w]->mutex);
+        for (size_t i = taskCount * w / workerCount; i < taskCount * (w + 1) / workerCount; ++i) {
+            queues[w]->tasks.push_back(i);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        currentTask = &task;
+        busyWorkers = threads.size();
+        firstError = nullptr;
+        ++generation;
+    }
+    wakeWorkers.notify_all();
+
+    runTasks(0);
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        workersDone.wait(lock, [&] { return busyWorkers == 0; });
+        currentTask = nullptr;
+        error = firstError;
+        firstError = nullptr;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
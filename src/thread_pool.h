@@ -0,0 +1,73 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Scans are split into morsels of this many rows; a morsel is the unit of work handed to a worker
+constexpr size_t kMorselRows = 1 << 16;
+
+// Number of morsels needed to cover `rows` rows
+inline size_t morselCount(size_t rows) {
+    return (rows + kMorselRows - 1) / kMorselRows;
+}
+
+// Fixed pool of worker threads shared by all parallel operators (filter, sort, aggregate, join).
+// parallelFor splits the task indices into one contiguous chunk per worker; each worker takes
+// tasks from the front of its own deque and, once that is empty, steals from the back of the
+// others, so a worker that got cheap morsels helps out the ones that got expensive ones.
+// The calling thread works as worker 0.
+class ThreadPool {
+public:
+    // The pool used by the database, sized to the hardware by default
+    static ThreadPool& instance();
+
+    explicit ThreadPool(size_t threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of workers, including the calling thread
+    size_t threadCount() const { return queues.size(); }
+
+    // Restarts the pool with `threadCount` workers (at least 1). Not allowed while a parallelFor runs.
+    void setThreadCount(size_t threadCount);
+
+    // Runs task(worker, index) for every index in [0, taskCount) and waits for all of them.
+    // `worker` is in [0, threadCount()) and identifies the thread, e.g. for per-worker scratch state.
+    // Tasks may run in any order; callers that need ordered output write to per-index slots.
+    // If a task throws, the first exception is rethrown here after the other tasks finish.
+    // Calls made from inside a task run serially on that thread, as the worker running the task.
+    void parallelFor(size_t taskCount, const std::function<void(size_t worker, size_t index)>& task);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    void start(size_t threadCount);
+    void stop();
+    void workerLoop(size_t worker, size_t seenGeneration);
+    void runTasks(size_t worker);
+    bool takeTask(size_t worker, size_t& index);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;   // one per worker, [0] is the caller's
+    std::vector<std::thread> threads;                 // workers 1..n-1
+
+    std::mutex runMutex;                              // one parallelFor at a time
+    std::mutex stateMutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable workersDone;
+    const std::function<void(size_t, size_t)>* currentTask = nullptr;
+    size_t generation = 0;                            // bumped for every parallelFor
+    size_t busyWorkers = 0;
+    bool stopping = false;
+    std::exception_ptr firstError;
+};
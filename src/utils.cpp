@@ -1,10 +1,13 @@
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 #include <vector>
+#include <thread>
 #include <fmt/format.h>
 
 #include "database.h"
 #include "utils.h"
+#include "date.h"
 
 
 std::string trim(const std::string& str) {
@@ -49,31 +52,14 @@ std::vector<std::string> split(const std::string& s, char delimiter) {
 }
 
 
-std::string removeTrailingSemicolon(const std::string& str) {
-    if (!str.empty() && str.back() == ';') {
-        return str.substr(0, str.size() - 1);
-    }
-    return str;
-}
-
-
-bool isQuoted(const std::string& s) {
-    if (s.size() < 2) return false;
-    return ((s.front() == '\'' && s.back() == '\'') ||
-            (s.front() == '"'  && s.back() == '"'));
-}
-
-
-std::string stripQuotes(const std::string& s) {
-    if (isQuoted(s)) {
-        return s.substr(1, s.size() - 2);
-    }
-    return s;
-}
-
-
-bool isLogical(const std::string& token) {
-    return (token == "AND" || token == "OR" || token == "NOT");
+CompareOp parseCompareOp(std::string_view op) {
+    if      (op == "=")  return CompareOp::EQ;
+    else if (op == "!=") return CompareOp::NE;
+    else if (op == ">")  return CompareOp::GT;
+    else if (op == "<")  return CompareOp::LT;
+    else if (op == ">=") return CompareOp::GE;
+    else if (op == "<=") return CompareOp::LE;
+    throw std::runtime_error("Unsupported operator '" + std::string(op) + "'");
 }
 
 // https://stackoverflow.com/questions/22425825/changing-a-lowercase-character-to-uppercase-in-c
@@ -85,107 +71,10 @@ char toUpperManual(char c) {
 }
 
 
-bool caseInsensitiveEquals(const std::string& a, const std::string& b) {
-    if (a.size() != b.size()) return false;
-
-    for (size_t i = 0; i < a.size(); ++i) {
-        char ca = a[i];
-        char cb = b[i];
-        ca = toUpperManual(ca);
-        cb = toUpperManual(cb);
-        if (ca != cb) return false;
-    }
-    return true;
-}
-
-
-// Converts SQL-like commands into a standardized format by normalizing keywords to uppercase.
-// Handles both single-word and multi-word keywords.
-std::string normalizeKeywords(const std::string& input) {
-    // Define single-word keywords to be normalized to uppercase.
-    std::vector<std::string> singleWordKws = {
-        "SELECT", "FROM", "WHERE", "AND", "OR", "NOT", "IN",
-        "LOAD", "INSERT", "CREATE", "DROP", "SAVE", "AS", "LIMIT"
-    };
-
-    // Define multi-word keywords to be normalized to uppercase.
-    std::vector<std::string> multiWordKws = {
-        "ORDER BY", "DELETE FILE", "LIST TABLES"
-    };
-
-    // Split the input into tokens (by spaces) for processing.
-    std::vector<std::string> tokens = split(input, ' ');
-
-    // Prepare a list to store the result with normalized keywords.
-    // Reserve space in advance for efficiency.
-    // Simple performance benefits
-    std::vector<std::string> resultTokens;
-    resultTokens.reserve(tokens.size()); // https://cplusplus.com/reference/vector/vector/reserve/
-
-    // Process each token in the input.
-    for (size_t i = 0; i < tokens.size(); ++i) {
-        bool foundMulti = false;
-
-        // Attempt to match multi-word keywords starting at the current token.
-        for (size_t mk = 0; mk < multiWordKws.size(); ++mk) {
-            // Split multi-word keyword into individual words.
-            std::vector<std::string> parts = split(multiWordKws[mk], ' ');
-
-            // Ensure there are enough tokens left to match this multi-word keyword.
-            if (i + parts.size() <= tokens.size()) {
-                bool match = true;
-
-                // Compare each part of the multi-word keyword with corresponding tokens.
-                for (size_t p = 0; p < parts.size(); ++p) {
-                    if (!caseInsensitiveEquals(tokens[i + p], parts[p])) {
-                        match = false;
-                        break; // Exit if any part does not match.
-                    }
-                }
-
-                // If a match is found, add the multi-word keyword to the result.
-                if (match) {
-                    resultTokens.push_back(multiWordKws[mk]);
-                    i += (parts.size() - 1); // Skip over matched tokens.
-                    foundMulti = true;
-                    break;
-                }
-            }
-        }
-
-        // If a multi-word match was found, skip further processing for this token.
-        if (foundMulti) {
-            continue;
-        }
-
-        // Check for a single-word keyword match.
-        bool foundSingle = false;
-        for (size_t sk = 0; sk < singleWordKws.size(); ++sk) {
-            if (caseInsensitiveEquals(tokens[i], singleWordKws[sk])) {
-                // Add the single-word keyword to the result in uppercase.
-                resultTokens.push_back(singleWordKws[sk]);
-                foundSingle = true;
-                break;
-            }
-        }
-
-        // If no match is found, add the original token to the result.
-        if (!foundSingle) {
-            resultTokens.push_back(tokens[i]);
-        }
-    }
-
-    // Rebuild the string from the normalized tokens.
-    std::stringstream out;
-    for (size_t i = 0; i < resultTokens.size(); ++i) {
-        if (i > 0) {
-            out << " ";
-        }
-        out << resultTokens[i];
-    }
-
-    // Return the fully normalized command string.
-    return out.str();
+std::string formatBytes(size_t bytes) {
+    if (bytes < 1024) return fmt::format("{} B", bytes);
+    if (bytes < 1024 * 1024) return fmt::format("{:.1f} KB", bytes / 1024.0);
+    return fmt::format("{:.1f} MB", bytes / (1024.0 * 1024.0));
 }
 
 
@@ -382,6 +271,246 @@ void runTests() {
         }
         fmt::print(" - Attempt to delete non-existent file test completed.\n\n");
 
+        fmt::print("[Test 30: Aggregates and GROUP BY]\n");
+        db.executeCommand("CREATE TABLE sales (id INTEGER, region VARCHAR, amount FLOAT);");
+        db.executeCommand("INSERT INTO sales VALUES (1, 'EU', 100.50);");
+        db.executeCommand("INSERT INTO sales VALUES (2, 'US', 200.00);");
+        db.executeCommand("INSERT INTO sales VALUES (3, 'EU', 50.25);");
+        db.executeCommand("SELECT COUNT(*), SUM(amount), AVG(amount), MIN(id), MAX(region) FROM sales;");
+        db.executeCommand("SELECT region, COUNT(*), SUM(amount) FROM sales WHERE id > 1 GROUP BY region;");
+        db.executeCommand("SELECT region, COUNT(*) FROM sales GROUP BY region ORDER BY COUNT(*) DESC LIMIT 1;");
+        fmt::print(" - Aggregate queries executed successfully.\n\n");
+
+        fmt::print("[Test 31: JOIN]\n");
+        db.executeCommand("CREATE TABLE regions (code VARCHAR, manager VARCHAR);");
+        db.executeCommand("INSERT INTO regions VALUES ('EU', 'Marta');");
+        db.executeCommand("INSERT INTO regions VALUES ('US', 'John');");
+        db.executeCommand("SELECT * FROM sales JOIN regions ON sales.region = regions.code;");
+        db.executeCommand("SELECT id, manager FROM sales JOIN regions ON sales.region = regions.code WHERE amount > 60 ORDER BY id DESC;");
+        fmt::print(" - JOIN queries executed successfully.\n\n");
+
+        fmt::print("[Test 32: SET THREADS]\n");
+        db.executeCommand("SET THREADS 2;");
+        db.executeCommand("SELECT region, COUNT(*) FROM sales GROUP BY region;");
+        try {
+            db.executeCommand("SET THREADS 0;");
+        } catch (const std::exception& e) {
+            fmt::print(" - Error caught as expected: {}\n", e.what());
+        }
+        db.executeCommand(fmt::format("SET THREADS {};", std::max(1u, std::thread::hardware_concurrency())));
+        fmt::print(" - SET THREADS test completed.\n\n");
+
+        fmt::print("[Test 33: CREATE INDEX]\n");
+        db.executeCommand("CREATE INDEX sales_id ON sales(id);");
+        db.executeCommand("SELECT * FROM sales WHERE id = 2;");
+        db.executeCommand("INSERT INTO sales VALUES (4, 'US', 75.00);");
+        db.executeCommand("SELECT id, amount FROM sales WHERE id >= 3 AND region = 'US';");
+        try {
+            db.executeCommand("CREATE INDEX sales_id ON sales(amount);");
+        } catch (const std::exception& e) {
+            fmt::print(" - Error caught as expected: {}\n", e.what());
+        }
+        db.executeCommand("DROP INDEX sales_id;");
+        fmt::print(" - Index test completed.\n\n");
+
+        fmt::print("[Test 34: CREATE BITMAP INDEX]\n");
+        db.executeCommand("CREATE BITMAP INDEX sales_region ON sales(region);");
+        db.executeCommand("SELECT id, region FROM sales WHERE region = 'EU' OR NOT region IN ('EU', 'US');");
+        db.executeCommand("SELECT COUNT(*) FROM sales WHERE region != 'EU' AND amount > 100;");
+        try {
+            db.executeCommand("CREATE BITMAP INDEX sales_amount ON sales(amount);");
+        } catch (const std::exception& e) {
+            fmt::print(" - Error caught as expected: {}\n", e.what());
+        }
+        db.executeCommand("DROP INDEX sales_region;");
+        fmt::print(" - Bitmap index test completed.\n\n");
+
+        fmt::print("[Test 35: CREATE BLOOM INDEX]\n");
+        db.executeCommand("CREATE BLOOM INDEX sales_region_bloom ON sales(region);");
+        db.executeCommand("SELECT * FROM sales WHERE region = 'ASIA';");
+        db.executeCommand("SELECT id FROM sales WHERE region IN ('ASIA', 'US') AND amount < 100;");
+        try {
+            db.executeCommand("CREATE BLOOM INDEX sales_id_bloom ON sales(id);");
+        } catch (const std::exception& e) {
+            fmt::print(" - Error caught as expected: {}\n", e.what());
+        }
+        db.executeCommand("DROP INDEX sales_region_bloom;");
+        fmt::print(" - Bloom index test completed.\n\n");
+
+        fmt::print("[Test 36: DATE values]\n");
+        db.executeCommand("CREATE TABLE events (id INTEGER, day DATE);");
+        db.executeCommand("INSERT INTO events VALUES (1, '2024-02-29');");
+        db.executeCommand("INSERT INTO events VALUES (2, '1999-7-4');");
+        try {
+            db.executeCommand("INSERT INTO events VALUES (3, '2023-02-29');");
+        } catch (const std::exception& e) {
+            fmt::print(" - Error caught as expected: {}\n", e.what());
+        }
+        db.executeCommand("SELECT * FROM events WHERE day >= '1999-07-04' ORDER BY day;");
+        db.executeCommand("SELECT MIN(day), MAX(day) FROM events;");
+        fmt::print(" - DATE test completed.\n\n");
+
+        fmt::print("[Test 37: Dictionary-encoded VARCHAR]\n");
+        db.executeCommand("CREATE TABLE visits (id INTEGER, city VARCHAR);");
+        db.executeCommand("INSERT INTO visits VALUES (1, 'Oslo');");
+        db.executeCommand("INSERT INTO visits VALUES (2, 'Lima');");
+        db.executeCommand("INSERT INTO visits VALUES (3, 'Oslo');");
+        db.executeCommand("INSERT INTO visits VALUES (4, 'Cairo');");
+        db.executeCommand("SELECT * FROM visits WHERE city IN ('Oslo', 'Rome') OR city > 'Kyiv' ORDER BY city, id;");
+        db.executeCommand("SELECT city, COUNT(*) FROM visits GROUP BY city;");
+        db.executeCommand("LIST TABLES;");
+        fmt::print(" - Dictionary encoding test completed.\n\n");
+
+        fmt::print("[Test 38: SHOW STORAGE]\n");
+        db.executeCommand("SHOW STORAGE visits;");
+        try {
+            db.executeCommand("SHOW STORAGE non_existent_table;");
+        } catch (const std::exception& e) {
+            fmt::print(" - Error caught as expected: {}\n", e.what());
+        }
+        fmt::print(" - SHOW STORAGE test completed.\n\n");
+
+        fmt::print("[Test 39: Short and long string values]\n");
+        db.executeCommand("CREATE TABLE notes (id INTEGER, body VARCHAR);");
+        db.executeCommand("INSERT INTO notes VALUES (1, 'twelve bytes');");
+        db.executeCommand("INSERT INTO notes VALUES (2, 'thirteen byte');");
+        db.executeCommand("INSERT INTO notes VALUES (3, 'a note well past the inline limit');");
+        db.executeCommand("INSERT INTO notes VALUES (4, 'twelve bytes');");
+        db.executeCommand("SELECT body, COUNT(*), MIN(id) FROM notes GROUP BY body ORDER BY body DESC;");
+        db.executeCommand("SELECT MIN(body), MAX(body) FROM notes;");
+        fmt::print(" - String value test completed.\n\n");
+
+        fmt::print("[Test 40: SHOW MEMORY]\n");
+        db.executeCommand("SELECT body, COUNT(*) FROM notes GROUP BY body;");
+        db.executeCommand("SHOW MEMORY;");
+        db.executeCommand("DROP TABLE notes;");
+        db.executeCommand("SHOW MEMORY;");
+        fmt::print(" - SHOW MEMORY test completed.\n\n");
+
+        fmt::print("[Test 41: Quoted literals and lower-case keywords]\n");
+        db.executeCommand("create table contacts (id integer, name varchar, city varchar);");
+        db.executeCommand("insert into contacts values (1, 'Smith, John', 'New York');");
+        db.executeCommand("insert into contacts values (2, 'select from where', 'Paris');");
+        db.executeCommand("insert into contacts values (3, 'it''s', \"Rome; Italy\");");
+        db.executeCommand("select name, city from contacts where city = 'New York' or name = 'it''s' order by id desc;");
+        db.executeCommand("SELECT id FROM contacts WHERE name IN ('Smith, John', 'select from where');");
+        // Values with commas or quotes are quoted in the CSV file and load back whole
+        db.executeCommand("SAVE contacts AS contacts_quoted.csv;");
+        db.executeCommand("DROP TABLE contacts;");
+        db.executeCommand("LOAD contacts_quoted.csv AS contacts;");
+        db.executeCommand("DELETE FILE contacts_quoted.csv");
+        db.executeCommand("SELECT id, name, city FROM contacts WHERE name = 'Smith, John' OR name = 'it''s';");
+        try {
+            db.executeCommand("SELECT id FROM contacts WHERE id = = 1;");
+        } catch (const std::exception& e) {
+            fmt::print(" - Error caught as expected for a syntax error: {}\n", e.what());
+        }
+        db.executeCommand("DROP TABLE contacts;");
+        fmt::print(" - Quoted literals test completed.\n\n");
+
+        fmt::print("[Test 42: Prepared statements and the plan cache]\n");
+        db.executeCommand("CREATE TABLE accounts (id INTEGER, owner VARCHAR, opened DATE);");
+        db.executeCommand("INSERT INTO accounts VALUES (1, 'Anna', '2020-03-01');");
+        db.executeCommand("INSERT INTO accounts VALUES (2, 'Boris', '2021-07-15');");
+        db.executeCommand("PREPARE account_by_id AS SELECT owner, opened FROM accounts WHERE id = ?;");
+        db.executeCommand("EXECUTE account_by_id(2);");
+        db.prepare("opened_after", "SELECT id FROM accounts WHERE opened > ? AND owner != ?");
+        db.execute("opened_after", {Value::date(parseDateOrThrow("2020-12-31")), Value::string("Carl")});
+        try {
+            db.executeCommand("EXECUTE account_by_id('two');");
+        } catch (const std::exception& e) {
+            fmt::print(" - Error caught as expected for a mistyped parameter: {}\n", e.what());
+        }
+        db.executeCommand("SELECT COUNT(*) FROM accounts;");
+        db.executeCommand("SELECT  COUNT(*)  FROM accounts;");   // same tokens: served from the plan cache
+        db.executeCommand("select count(*) from accounts");      // keyword case doesn't matter either
+        // Dropping and recreating the table invalidates the plans bound to it
+        db.executeCommand("DROP TABLE accounts;");
+        db.executeCommand("CREATE TABLE accounts (owner VARCHAR, opened DATE, id INTEGER);");
+        db.executeCommand("INSERT INTO accounts VALUES ('Dora', '2022-01-10', 2);");
+        db.executeCommand("EXECUTE account_by_id(2);");
+        db.executeCommand("EXECUTE opened_after('2020-12-31', 'Carl');");
+        db.executeCommand("SHOW PLANS;");
+        db.executeCommand("DEALLOCATE account_by_id;");
+        db.deallocate("opened_after");
+        db.executeCommand("DROP TABLE accounts;");
+        fmt::print(" - Prepared statements test completed.\n\n");
+
+        fmt::print("[Test 43: WHERE precedence, parentheses and NOT]\n");
+        db.executeCommand("CREATE TABLE tickets (id INTEGER, team VARCHAR, level CHAR, hours FLOAT);");
+        db.executeCommand("INSERT INTO tickets VALUES (1, 'core', 'A', 2.5);");
+        db.executeCommand("INSERT INTO tickets VALUES (2, 'web', 'B', 8.0);");
+        db.executeCommand("INSERT INTO tickets VALUES (3, 'core', 'C', 1.0);");
+        db.executeCommand("INSERT INTO tickets VALUES (4, 'ops', 'A', 5.5);");
+        db.executeCommand("INSERT INTO tickets VALUES (5, 'web', 'C', 3.0);");
+        // AND binds tighter than OR: id = 1 OR (team = 'web' AND level = 'C')
+        db.executeCommand("SELECT id FROM tickets WHERE id = 1 OR team = 'web' AND level = 'C' ORDER BY id;");
+        db.executeCommand("SELECT id FROM tickets WHERE (id = 1 OR team = 'web') AND level = 'C' ORDER BY id;");
+        db.executeCommand("SELECT id FROM tickets WHERE NOT (team = 'core' OR hours > 5) ORDER BY id;");
+        db.executeCommand("SELECT COUNT(*) FROM tickets WHERE NOT NOT level = 'A' AND (hours < 3 OR team IN ('ops'));");
+        // The same questions answered with bitmap indexes only
+        db.executeCommand("CREATE BITMAP INDEX tickets_team ON tickets(team);");
+        db.executeCommand("CREATE BITMAP INDEX tickets_level ON tickets(level);");
+        db.executeCommand("SELECT id FROM tickets WHERE team = 'ops' OR level = 'B' AND NOT team = 'core' ORDER BY id;");
+        db.executeCommand("CREATE TABLE teams (name VARCHAR, lead VARCHAR);");
+        db.executeCommand("INSERT INTO teams VALUES ('core', 'Ines');");
+        db.executeCommand("INSERT INTO teams VALUES ('web', 'Omar');");
+        // An OR across both tables is checked on the joined rows, the level condition is pushed down
+        db.executeCommand("SELECT tickets.id, teams.lead FROM tickets JOIN teams ON tickets.team = teams.name "
+                          "WHERE level != 'A' AND (teams.lead = 'Ines' OR hours > 5) ORDER BY tickets.id;");
+        try {
+            db.executeCommand("SELECT id FROM tickets WHERE (id = 1 OR id = 2;");
+        } catch (const std::exception& e) {
+            fmt::print(" - Error caught as expected for an unbalanced parenthesis: {}\n", e.what());
+        }
+        db.executeCommand("DROP TABLE teams;");
+        db.executeCommand("DROP TABLE tickets;");
+        fmt::print(" - WHERE expression test completed.\n\n");
+
+        fmt::print("[Test 44: Operator pipeline and LIMIT]\n");
+        db.executeCommand("CREATE TABLE readings (id INTEGER, sensor CHAR, value FLOAT);");
+        db.executeCommand("INSERT INTO readings VALUES (1, 'a', 20.5);");
+        db.executeCommand("INSERT INTO readings VALUES (2, 'b', 19.0);");
+        db.executeCommand("INSERT INTO readings VALUES (3, 'a', 21.25);");
+        db.executeCommand("INSERT INTO readings VALUES (4, 'b', 18.75);");
+        db.executeCommand("INSERT INTO readings VALUES (5, 'a', 22.0);");
+        // Without ORDER BY the first qualifying rows in table order, the scan stops there
+        db.executeCommand("SELECT id, value FROM readings WHERE sensor = 'a' LIMIT 2;");
+        db.executeCommand("SELECT * FROM readings LIMIT 0;");
+        // Sort, top-K, and a LIMIT larger than the result
+        db.executeCommand("SELECT id FROM readings ORDER BY sensor DESC, value;");
+        db.executeCommand("SELECT id, value FROM readings WHERE id > 1 ORDER BY value DESC LIMIT 2;");
+        db.executeCommand("SELECT sensor FROM readings WHERE value < 20 LIMIT 10;");
+        // ORDER BY with a LIMIT beyond the table is a plain sort, no heap sized for the LIMIT
+        db.executeCommand("SELECT id, value FROM readings ORDER BY value LIMIT 2000000000;");
+        db.executeCommand("DROP TABLE readings;");
+        fmt::print(" - Operator pipeline test completed.\n\n");
+
+        fmt::print("[Test 45: EXPLAIN and EXPLAIN ANALYZE]\n");
+        db.executeCommand("CREATE TABLE orders (id INTEGER, customer VARCHAR, total FLOAT);");
+        // 40 rows, so one id and the four 'Cid' orders are within the 10% an index lookup may return
+        for (int id = 1; id <= 40; ++id) {
+            const char* customer = id % 10 == 0 ? "Cid" : (id % 2 == 0 ? "Bob" : "Ann");
+            db.executeCommand(fmt::format("INSERT INTO orders VALUES ({}, '{}', {}.5);", id, customer, id));
+        }
+        db.executeCommand("CREATE INDEX orders_id ON orders (id);");
+        db.executeCommand("CREATE BITMAP INDEX orders_customer ON orders (customer);");
+        // The plan only: access path, filter order, sort strategy and parallelism
+        db.executeCommand("EXPLAIN SELECT id FROM orders WHERE customer = 'Ann' AND total > 10 ORDER BY total DESC LIMIT 1;");
+        db.executeCommand("EXPLAIN SELECT customer, SUM(total) FROM orders GROUP BY customer;");
+        db.executeCommand("EXPLAIN SELECT * FROM orders WHERE id = 2;");
+        // Runs the query and reports each stage instead of the rows, with the rows the index skipped
+        db.executeCommand("EXPLAIN ANALYZE SELECT * FROM orders WHERE id = 2;");
+        db.executeCommand("EXPLAIN ANALYZE SELECT id, total FROM orders WHERE customer = 'Cid' ORDER BY total DESC;");
+        db.executeCommand("EXPLAIN ANALYZE SELECT COUNT(*) FROM orders WHERE customer = 'Cid';");
+        try {
+            db.executeCommand("EXPLAIN INSERT INTO orders VALUES (41, 'Cid', 1.0);");
+        } catch (const std::exception& e) {
+            fmt::print(" - Error caught as expected: {}\n", e.what());
+        }
+        db.executeCommand("DROP TABLE orders;");
+        fmt::print(" - EXPLAIN test completed.\n\n");
+
         fmt::print("=========================\n");
         fmt::print("All tests passed successfully!\n");
         fmt::print("=========================\n\n");
@@ -418,6 +547,37 @@ void displayHelp() {
     fmt::print("    SELECT * FROM users ORDER BY age DESC, name ASC;\n");
     fmt::print("    SELECT id, name FROM users WHERE age >= 25 ORDER BY name ASC LIMIT 10;\n\n");
 
+    fmt::print("- SELECT [groupColumn, ...] AGG(column), ... FROM tableName [WHERE condition] [GROUP BY column, ...] [ORDER BY ...] [LIMIT n];\n");
+    fmt::print("  Aggregates: COUNT(*), COUNT(column), SUM(column), AVG(column), MIN(column), MAX(column).\n");
+    fmt::print("  Examples:\n");
+    fmt::print("    SELECT COUNT(*) FROM users WHERE age > 20;\n");
+    fmt::print("    SELECT age, COUNT(*) FROM users GROUP BY age ORDER BY COUNT(*) DESC;\n\n");
+
+    fmt::print("- SELECT columns FROM table1 JOIN table2 ON table1.column = table2.column [WHERE ...] [ORDER BY ...] [LIMIT n];\n");
+    fmt::print("  Columns can be written as table.column; plain names work when only one table has them.\n");
+    fmt::print("  Example: SELECT users.name, orders.item FROM users JOIN orders ON users.id = orders.user_id WHERE orders.item != 'pen';\n\n");
+
+    fmt::print("- SET THREADS n;\n");
+    fmt::print("  Sets how many threads scans, joins, sorts and aggregates use (default: all cores).\n");
+    fmt::print("  Example: SET THREADS 4;\n\n");
+
+    fmt::print("- CREATE INDEX indexName ON tableName(column);\n");
+    fmt::print("  Builds a B+tree index that speeds up selective WHERE conditions (=, <, >, <=, >=, IN) on the column.\n");
+    fmt::print("  Example: CREATE INDEX users_age ON users(age);\n\n");
+
+    fmt::print("- CREATE BITMAP INDEX indexName ON tableName(column);\n");
+    fmt::print("  For CHAR and VARCHAR columns with few distinct values: WHERE clauses on bitmap-indexed columns\n");
+    fmt::print("  (including AND, OR, NOT, != and NOT IN) are answered with bitmap operations.\n");
+    fmt::print("  Example: CREATE BITMAP INDEX users_country ON users(country);\n\n");
+
+    fmt::print("- CREATE BLOOM INDEX indexName ON tableName(column);\n");
+    fmt::print("  For VARCHAR and DATE columns: keeps a Bloom filter per group of rows, so = and IN lookups\n");
+    fmt::print("  skip groups that can't contain the value. LIST TABLES shows the memory each index uses.\n");
+    fmt::print("  Example: CREATE BLOOM INDEX users_name ON users(name);\n\n");
+
+    fmt::print("- DROP INDEX indexName;\n");
+    fmt::print("  Example: DROP INDEX users_age;\n\n");
+
     fmt::print("- DROP TABLE tableName;\n");
     fmt::print("  Example: DROP TABLE users;\n\n");
 
@@ -437,14 +597,38 @@ void displayHelp() {
     fmt::print("- LIST TABLES;\n");
     fmt::print("  Lists all tables currently in memory.\n\n");
 
+    fmt::print("- SHOW STORAGE tableName;\n");
+    fmt::print("  Shows how each column is stored (dictionary, run-length, bit-packed or plain row groups)\n");
+    fmt::print("  and how many bytes it takes compared to plain arrays.\n");
+    fmt::print("  Example: SHOW STORAGE users;\n\n");
+
+    fmt::print("- SHOW MEMORY;\n");
+    fmt::print("  Shows the string arena of every table (freed by DROP TABLE) and how much scratch memory\n");
+    fmt::print("  the previous command allocated (released after each command).\n\n");
+
+    fmt::print("- PREPARE name AS SELECT ... WHERE column = ?;  EXECUTE name(value, ...);  DEALLOCATE name;\n");
+    fmt::print("  Parses and binds a query once; each '?' is a value supplied by EXECUTE.\n");
+    fmt::print("  Example: PREPARE user_by_id AS SELECT * FROM users WHERE id = ?; EXECUTE user_by_id(42);\n\n");
+
+    fmt::print("- SHOW PLANS;\n");
+    fmt::print("  Lists prepared statements and the hit rate of the plan cache.\n\n");
+    fmt::print("- EXPLAIN [ANALYZE] SELECT ...;\n");
+    fmt::print("  Shows how a query runs: scan or index, filter order, sort strategy and parallelism.\n");
+    fmt::print("  ANALYZE runs it and reports time, rows, allocations and skipped rows per stage.\n\n");
+
     fmt::print("- HELP: Display this list of commands.\n\n");
 
     fmt::print("- EXIT: Exit the application.\n\n");
 
     fmt::print("Additional Notes:\n");
     fmt::print("  - Supported data types: INTEGER, FLOAT, CHAR, VARCHAR, DATE.\n");
-    fmt::print("  - WHERE clause supports conditions like '=', '!=', '<', '>', '<=', '>=', 'IN', 'NOT IN'.\n");
+    fmt::print("  - DATE values are written as 'YYYY-MM-DD' and checked when inserted.\n");
+    fmt::print("  - VARCHAR columns with few distinct values are dictionary-encoded automatically (see LIST TABLES).\n");
+    fmt::print("  - WHERE clause supports conditions like '=', '!=', '<', '>', '<=', '>=', 'IN', 'NOT IN',\n");
+    fmt::print("    combined with NOT, AND and OR (in that order of precedence) and grouped with parentheses.\n");
     fmt::print("  - ORDER BY supports sorting by multiple columns with ASC (default) or DESC.\n");
     fmt::print("  - LIMIT restricts the number of rows returned in a SELECT query.\n");
+    fmt::print("  - Keywords may be written in any case. Strings are quoted with ' or \" and may contain\n");
+    fmt::print("    commas, spaces, semicolons and keywords; write a quote twice to include it ('it''s').\n");
     fmt::print("\n");
 }
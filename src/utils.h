@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stdexcept>
 
@@ -12,31 +13,15 @@ std::string trim(const std::string& str);
 // (Reference: https://stackoverflow.com/questions/735204/convert-a-string-in-c-to-upper-case)
 std::string toCase(const std::string& str, CaseType caseType);
 
-// Removes a trailing semicolon from the string, if present.
-std::string removeTrailingSemicolon(const std::string& str);
-
 // Splits the string by a specified delimiter and returns a vector of substrings.
 std::vector<std::string> split(const std::string& s, char delimiter);
 
-// Checks if a string starts and ends with matching quotes.
-bool isQuoted(const std::string& s);
-
-// Removes surrounding quotes from a string, if they exist.
-std::string stripQuotes(const std::string& s);
-
-// Checks if a token is a known logical operator (e.g., AND, OR, NOT).
-bool isLogical(const std::string& token);
-
-// Compares two strings for equality, ignoring case differences.
-bool caseInsensitiveEquals(const std::string& a, const std::string& b);
+// Formats a byte count for display: "512 B", "12.5 KB", "3.2 MB".
+std::string formatBytes(size_t bytes);
 
 // Converts a character from lowercase to uppercase, if applicable.
 char toUpperManual(char c);
 
-// Normalizes input SQL-like commands by converting keywords to uppercase.
-// For example: "select name from users order by age" becomes "SELECT name FROM users ORDER BY age".
-std::string normalizeKeywords(const std::string& input);
-
 // Runs basic tests to verify the application's functionality.
 void runTests();
 
@@ -46,15 +31,23 @@ void runTests();
 void displayHeader();
 void displayHelp();
 
-// A generic template function to compare two values using a specified operator (e.g., =, !=, >, <, >=, <=).
+// Comparison operators supported in WHERE clauses
+enum class CompareOp { EQ, NE, GT, LT, GE, LE };
+
+// Converts an operator token (=, !=, >, <, >=, <=) to CompareOp.
 // Throws an exception if the operator is unsupported.
+CompareOp parseCompareOp(std::string_view op);
+
+// A generic template function to compare two values using a specified operator (e.g., =, !=, >, <, >=, <=).
 template <typename T>
-bool compareValues(const T& value, const T& condValue, const std::string& op) {
-    if      (op == "=")  return value == condValue;
-    else if (op == "!=") return value != condValue;
-    else if (op == ">")  return value > condValue;
-    else if (op == "<")  return value < condValue;
-    else if (op == ">=") return value >= condValue;
-    else if (op == "<=") return value <= condValue;
-    throw std::runtime_error("Unsupported operator '" + op + "'");
+bool compareValues(const T& value, const T& condValue, CompareOp op) {
+    switch (op) {
+        case CompareOp::EQ: return value == condValue;
+        case CompareOp::NE: return value != condValue;
+        case CompareOp::GT: return value > condValue;
+        case CompareOp::LT: return value < condValue;
+        case CompareOp::GE: return value >= condValue;
+        case CompareOp::LE: return value <= condValue;
+    }
+    return false;
 }
@@ -0,0 +1,72 @@
+#include <stdexcept>
+#include <fmt/format.h>
+
+#include "value.h"
+#include "date.h"
+
+Value Value::string(std::string_view text) {
+    if (text.size() > kMaxStringBytes) {
+        throw std::runtime_error("String value is too long.");
+    }
+    Value value;
+    value.header = static_cast<uint32_t>(ValueType::STRING) | static_cast<uint32_t>(text.size() << 8);
+    if (text.size() <= kInlineBytes) {
+        std::memcpy(value.payload, text.data(), text.size());
+    } else {
+        std::memcpy(value.payload, text.data(), 4);     // prefix
+        value.storeWide(text.data());
+    }
+    return value;
+}
+
+bool operator==(const Value& a, const Value& b) {
+    if (a.type() != b.type()) return false;
+    switch (a.type()) {
+        case ValueType::NULL_VALUE: return true;
+        case ValueType::INT:
+        case ValueType::DATE:       return a.asInt() == b.asInt();
+        case ValueType::FLOAT:      return a.asFloat() == b.asFloat();
+        case ValueType::CHAR:       return a.asChar() == b.asChar();
+        case ValueType::BIGINT:     return a.asBigInt() == b.asBigInt();
+        case ValueType::DOUBLE:     return a.asDouble() == b.asDouble();
+        case ValueType::STRING:
+            // Different lengths or prefixes settle it without following the pointer
+            if (a.header != b.header || std::memcmp(a.payload, b.payload, 4) != 0) return false;
+            return a.asString() == b.asString();
+    }
+    return false;
+}
+
+bool operator<(const Value& a, const Value& b) {
+    if (a.type() != b.type()) return a.type() < b.type();
+    switch (a.type()) {
+        case ValueType::NULL_VALUE: return false;
+        case ValueType::INT:
+        case ValueType::DATE:       return a.asInt() < b.asInt();
+        case ValueType::FLOAT:      return a.asFloat() < b.asFloat();
+        case ValueType::CHAR:       return a.asChar() < b.asChar();
+        case ValueType::BIGINT:     return a.asBigInt() < b.asBigInt();
+        case ValueType::DOUBLE:     return a.asDouble() < b.asDouble();
+        case ValueType::STRING: {
+            // The 4-byte prefixes compare like the strings' first bytes
+            int prefix = std::memcmp(a.payload, b.payload, 4);
+            if (prefix != 0) return prefix < 0;
+            return a.asString() < b.asString();
+        }
+    }
+    return false;
+}
+
+std::string formatValue(const Value& value) {
+    switch (value.type()) {
+        case ValueType::NULL_VALUE: return "NULL";
+        case ValueType::INT:        return fmt::format("{}", value.asInt());
+        case ValueType::DATE:       return formatDate(value.asInt());
+        case ValueType::FLOAT:      return fmt::format("{:.2f}", value.asFloat());
+        case ValueType::CHAR:       return std::string(1, value.asChar());
+        case ValueType::STRING:     return std::string(value.asString());
+        case ValueType::BIGINT:     return fmt::format("{}", value.asBigInt());
+        case ValueType::DOUBLE:     return fmt::format("{:.2f}", value.asDouble());
+    }
+    return "";
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// What a Value holds. INT is an INTEGER cell, DATE a day number (see date.h);
+// BIGINT and DOUBLE only come out of aggregates (SUM, AVG), NULL_VALUE too (SUM over no rows).
+enum class ValueType : uint8_t { NULL_VALUE, INT, DATE, FLOAT, CHAR, STRING, BIGINT, DOUBLE };
+
+// A single value in a row, 16 bytes and trivially copyable (copying one never allocates).
+// Layout: a 4-byte header (type in the low 8 bits, string length in the upper 24) and 12 payload bytes.
+// Strings of up to kInlineBytes are stored in the payload itself. Longer ones keep their first
+// 4 bytes there (so most comparisons never leave the Value) plus a pointer to the full text,
+// which the Value does not own: it points into the table's column storage (its string arena for
+// plain VARCHAR columns), or into whatever buffer the caller built it from, and is only valid as
+// long as that is.
+class Value {
+public:
+    static constexpr size_t kInlineBytes = 12;
+    static constexpr size_t kMaxStringBytes = (size_t{1} << 24) - 1;
+
+    Value() = default;  // NULL
+    Value(int32_t v) : header(static_cast<uint32_t>(ValueType::INT)) { store(v); }
+    Value(float v) : header(static_cast<uint32_t>(ValueType::FLOAT)) { store(v); }
+    Value(char v) : header(static_cast<uint32_t>(ValueType::CHAR)) { store(v); }
+    Value(int64_t v) : header(static_cast<uint32_t>(ValueType::BIGINT)) { storeWide(v); }
+    Value(double v) : header(static_cast<uint32_t>(ValueType::DOUBLE)) { storeWide(v); }
+
+    static Value date(int32_t days) {
+        Value value(days);
+        value.header = static_cast<uint32_t>(ValueType::DATE);
+        return value;
+    }
+
+    // A string value. Copied inline when it fits; otherwise the Value points at `text`,
+    // which must outlive it. Throws if the string is longer than kMaxStringBytes.
+    // (Deliberately not a constructor, so a temporary std::string can't slip in by conversion.)
+    static Value string(std::string_view text);
+
+    ValueType type() const { return static_cast<ValueType>(header & 0xFF); }
+    bool isNull() const { return type() == ValueType::NULL_VALUE; }
+
+    // Typed accessors; the caller checks type() first
+    int32_t asInt() const { return load<int32_t>(); }       // INT and DATE
+    float asFloat() const { return load<float>(); }
+    char asChar() const { return load<char>(); }
+    int64_t asBigInt() const { return loadWide<int64_t>(); }
+    double asDouble() const { return loadWide<double>(); }
+    std::string_view asString() const {
+        size_t length = header >> 8;
+        if (length <= kInlineBytes) return std::string_view(payload, length);
+        return std::string_view(loadWide<const char*>(), length);
+    }
+
+    // Values of different types order by type (NULL first); equal types by value
+    friend bool operator==(const Value& a, const Value& b);
+    friend bool operator<(const Value& a, const Value& b);
+    friend bool operator!=(const Value& a, const Value& b) { return !(a == b); }
+
+private:
+    // 4-byte values sit at the start of the payload, 8-byte ones (and the long string pointer)
+    // at payload + 4, which is 8-byte aligned within the Value
+    template <typename T>
+    void store(T v) { std::memcpy(payload, &v, sizeof(T)); }
+    template <typename T>
+    void storeWide(T v) { std::memcpy(payload + 4, &v, sizeof(T)); }
+    template <typename T>
+    T load() const { T v; std::memcpy(&v, payload, sizeof(T)); return v; }
+    template <typename T>
+    T loadWide() const { T v; std::memcpy(&v, payload + 4, sizeof(T)); return v; }
+
+    uint32_t header = 0;
+    char payload[kInlineBytes] = {};
+};
+
+static_assert(sizeof(Value) == 16, "Value must stay 16 bytes");
+static_assert(std::is_trivially_copyable_v<Value>, "Value must be copyable without allocating");
+
+// Formats a value the same way SELECT prints table values (NULL as "NULL", dates as YYYY-MM-DD)
+std::string formatValue(const Value& value);